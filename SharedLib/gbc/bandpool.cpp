@@ -0,0 +1,78 @@
+#include "bandpool.h"
+
+#include <algorithm>
+
+BandPool::BandPool(unsigned int threads) :
+    work(nullptr),
+    rows(0),
+    generation(0),
+    bandsRemaining(0),
+    stopping(false) {
+    for (unsigned int band = 1; band < threads; band++) {
+        workers.emplace_back(&BandPool::runWorker, this, band);
+    }
+}
+
+BandPool::~BandPool() {
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        stopping = true;
+    }
+    workPosted.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+// Bands differ in size by a row at most, the larger ones first
+unsigned int BandPool::bandStart(unsigned int band) const {
+    const unsigned int bands = getThreadCount();
+    return band * (rows / bands) + std::min(band, rows % bands);
+}
+
+void BandPool::run(unsigned int rowCount, const BandWork& bandWork) {
+    if (workers.empty()) {
+        bandWork(0, rowCount);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        work = &bandWork;
+        rows = rowCount;
+        bandsRemaining = (unsigned int)workers.size();
+        generation++;
+    }
+    workPosted.notify_all();
+
+    bandWork(0, bandStart(1));
+
+    std::unique_lock<std::mutex> lock(poolMutex);
+    bandsDone.wait(lock, [&]() { return bandsRemaining == 0; });
+    work = nullptr;
+}
+
+void BandPool::runWorker(unsigned int band) {
+    uint64_t lastGeneration = 0;
+    std::unique_lock<std::mutex> lock(poolMutex);
+    while (true) {
+        workPosted.wait(lock, [&]() { return stopping || generation != lastGeneration; });
+        if (stopping) {
+            return;
+        }
+        lastGeneration = generation;
+        const BandWork& bandWork = *work;
+        const unsigned int first = bandStart(band);
+        const unsigned int count = bandStart(band + 1) - first;
+        lock.unlock();
+
+        if (count > 0) {
+            bandWork(first, count);
+        }
+
+        lock.lock();
+        if (--bandsRemaining == 0) {
+            bandsDone.notify_one();
+        }
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent threads that share out the rows of an image between them in bands of consecutive rows, for filters whose
+// rows can be worked on independently. The calling thread takes the first band itself, so a pool of one thread has no
+// workers and runs everything in the caller.
+class BandPool {
+public:
+    using BandWork = std::function<void(unsigned int firstRow, unsigned int rowCount)>;
+
+private:
+    std::vector<std::thread> workers;
+    std::mutex poolMutex;
+    std::condition_variable workPosted;
+    std::condition_variable bandsDone;
+    const BandWork* work;
+    unsigned int rows;
+    uint64_t generation;
+    unsigned int bandsRemaining;
+    bool stopping;
+
+    [[nodiscard]] unsigned int bandStart(unsigned int band) const;
+    void runWorker(unsigned int band);
+
+public:
+    explicit BandPool(unsigned int threads);
+    ~BandPool();
+    BandPool(const BandPool&) = delete;
+    BandPool& operator=(const BandPool&) = delete;
+
+    // Runs work over every band of the given rows, one band to a thread, returning once all of them are done. Not to
+    // be called from more than one thread at a time.
+    void run(unsigned int rowCount, const BandWork& bandWork);
+    [[nodiscard]] inline unsigned int getThreadCount() const { return (unsigned int)workers.size() + 1; }
+};
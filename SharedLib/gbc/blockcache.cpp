@@ -0,0 +1,218 @@
+#include "blockcache.h"
+
+#include "gbc.h"
+
+#include <algorithm>
+
+// Instructions that may move the PC anywhere other than the next instruction, or stop the CPU
+static bool endsBlock(uint8_t opcode) {
+    switch (opcode) {
+        case 0x10: case 0x18: case 0x20: case 0x28: case 0x30: case 0x38: case 0x76:
+        case 0xc0: case 0xc2: case 0xc3: case 0xc4: case 0xc7: case 0xc8: case 0xc9: case 0xca: case 0xcc: case 0xcd:
+        case 0xcf: case 0xd0: case 0xd2: case 0xd3: case 0xd4: case 0xd7: case 0xd8: case 0xd9: case 0xda: case 0xdb:
+        case 0xdc: case 0xdd: case 0xdf: case 0xe3: case 0xe4: case 0xe7: case 0xe9: case 0xeb: case 0xec: case 0xed:
+        case 0xef: case 0xf4: case 0xf7: case 0xfc: case 0xfd: case 0xff:
+            return true;
+        default:
+            return false;
+    }
+}
+
+BlockCache::BlockCache() {
+    ramCodeMap.resize(HRAM_CODE_MAP_OFFSET + 0x80);
+}
+
+void BlockCache::setEnabled(bool enable) {
+    // Writes to RAM are only tracked while enabled, so anything cached beforehand can't be trusted
+    if (enable != enabled) {
+        clear();
+        enabled = enable;
+    }
+}
+
+void BlockCache::clear() {
+    blocks.clear();
+    ramBlocks.clear();
+    std::fill(ramCodeMap.begin(), ramCodeMap.end(), 0);
+    std::fill(lookupSlots, lookupSlots + LOOKUP_SLOTS, LookupSlot{});
+    currentBlock = nullptr;
+    totalHits = 0;
+    totalMisses = 0;
+}
+
+int BlockCache::execute(Gbc& gbc) {
+    if (!isMidBlock(gbc.cpuPc) && enterBlock(gbc) == nullptr) {
+        return CpuOps::dispatch(gbc);
+    }
+
+    const DecodedInstruction& instruction = *nextInstruction++;
+    if (nextInstruction == blockEnd) {
+        currentBlock = nullptr;
+    }
+    gbc.cpuPc += instruction.length;
+    nextPc = gbc.cpuPc;
+    return instruction.handler(gbc, instruction.operand);
+}
+
+CachedBlock* BlockCache::enterBlock(Gbc& gbc) {
+    currentBlock = findBlock(gbc);
+    if (currentBlock != nullptr) {
+        nextInstruction = currentBlock->instructions.data();
+        blockEnd = nextInstruction + currentBlock->instructions.size();
+        nextPc = gbc.cpuPc;
+    }
+    return currentBlock;
+}
+
+CachedBlock* BlockCache::findBlock(Gbc& gbc) {
+    const uint32_t pc = gbc.cpuPc;
+    uint32_t bankOffset;
+    bool inRam;
+    if (pc < 0x4000U) {
+        bankOffset = 0;
+        inRam = false;
+    } else if (pc < 0x8000U) {
+        bankOffset = gbc.bankOffset;
+        inRam = false;
+        if (bankOffset + 0x4000U > gbc.rom.size()) {
+            return nullptr;
+        }
+    } else if (pc >= 0xc000U && pc < 0xd000U) {
+        bankOffset = 0;
+        inRam = true;
+    } else if (pc >= 0xd000U && pc < 0xe000U) {
+        bankOffset = gbc.wramBankOffset;
+        inRam = true;
+    } else if (pc >= 0xff80U && pc < 0xffffU) {
+        bankOffset = 0;
+        inRam = true;
+    } else {
+        return nullptr;
+    }
+
+    const uint64_t key = ((uint64_t)bankOffset << 16U) | pc;
+    LookupSlot& slot = lookupSlots[(pc ^ (bankOffset >> 12U)) & (LOOKUP_SLOTS - 1)];
+    CachedBlock* block;
+    if (slot.block != nullptr && slot.key == key) {
+        block = slot.block;
+    } else {
+        block = &blocks[key];
+        slot.key = key;
+        slot.block = block;
+    }
+
+    if (block->valid) {
+        block->hits++;
+        totalHits++;
+        return block;
+    }
+
+    block->startPc = pc;
+    block->bankOffset = bankOffset;
+    block->inRam = inRam;
+    decodeBlock(gbc, *block);
+    block->misses++;
+    totalMisses++;
+    if (block->instructions.empty()) {
+        return nullptr;
+    }
+    block->valid = true;
+    if (inRam) {
+        markRamCode(*block, 1);
+        ramBlocks.push_back(block);
+    }
+    return block;
+}
+
+void BlockCache::decodeBlock(Gbc& gbc, CachedBlock& block) {
+    uint32_t regionEnd;
+    if (block.startPc < 0x4000U) {
+        regionEnd = 0x4000U;
+    } else if (block.startPc < 0x8000U) {
+        regionEnd = 0x8000U;
+    } else if (block.startPc < 0xd000U) {
+        regionEnd = 0xd000U;
+    } else if (block.startPc < 0xe000U) {
+        regionEnd = 0xe000U;
+    } else {
+        regionEnd = 0xffffU;
+    }
+
+    // Fetch directly from the backing memory, which read8 would also resolve to for these regions
+    auto fetch = [&](uint32_t address) -> uint8_t {
+        if (address < 0x4000U) {
+            return gbc.rom[address];
+        } else if (address < 0x8000U) {
+            return gbc.rom[block.bankOffset + (address & 0x3fffU)];
+        } else if (address < 0xe000U) {
+            return gbc.wram[ramCodeMapIndex(address, block.bankOffset)];
+        } else {
+            return gbc.ioPorts[address & 0xffU];
+        }
+    };
+
+    block.instructions.clear();
+    uint32_t pc = block.startPc;
+    while (block.instructions.size() < MAX_BLOCK_INSTRUCTIONS) {
+        const uint8_t opcode = fetch(pc);
+        const uint32_t length = CpuOps::instructionLengths[opcode];
+        if (pc + length > regionEnd) {
+            break;
+        }
+
+        uint32_t operand = 0;
+        if (length > 1) {
+            operand = fetch(pc + 1);
+            if (length > 2) {
+                operand += (uint32_t)fetch(pc + 2) << 8U;
+            }
+        }
+
+        // Resolve extended instructions now rather than going through the 0xcb handler each time
+        OpHandler handler = opcode == 0xcb ? CpuOps::extendedTable[operand] : CpuOps::mainTable[opcode];
+        block.instructions.push_back({ handler, operand, length, opcode });
+        pc += length;
+        if (endsBlock(opcode)) {
+            break;
+        }
+    }
+    block.endPc = pc;
+}
+
+uint32_t BlockCache::ramCodeMapIndex(uint32_t pc, uint32_t bankOffset) const {
+    if (pc < 0xd000U) {
+        return pc & 0x0fffU;
+    } else if (pc < 0xe000U) {
+        return bankOffset + (pc & 0x0fffU);
+    } else {
+        return HRAM_CODE_MAP_OFFSET + (pc & 0x7fU);
+    }
+}
+
+void BlockCache::markRamCode(const CachedBlock& block, int delta) {
+    const uint32_t start = ramCodeMapIndex(block.startPc, block.bankOffset);
+    const uint32_t end = start + (block.endPc - block.startPc);
+    for (uint32_t index = start; index < end; index++) {
+        ramCodeMap[index] += delta;
+    }
+}
+
+void BlockCache::invalidateRamCode(uint32_t codeMapIndex) {
+    for (size_t i = 0; i < ramBlocks.size();) {
+        CachedBlock* block = ramBlocks[i];
+        const uint32_t start = ramCodeMapIndex(block->startPc, block->bankOffset);
+        const uint32_t end = start + (block->endPc - block->startPc);
+        if (codeMapIndex >= start && codeMapIndex < end) {
+            markRamCode(*block, -1);
+            block->valid = false;
+            block->instructions.clear();
+            block->nativeCode = nullptr;
+            block->nativeGeneration = 0;
+            codeGeneration++;
+            ramBlocks[i] = ramBlocks.back();
+            ramBlocks.pop_back();
+        } else {
+            i++;
+        }
+    }
+}
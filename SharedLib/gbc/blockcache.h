@@ -0,0 +1,110 @@
+#pragma once
+
+#include "cpuops.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class Gbc;
+
+struct DecodedInstruction {
+    OpHandler handler;
+    uint32_t operand;
+    uint32_t length;
+    uint8_t opcode;
+};
+
+struct CachedBlock {
+    std::vector<DecodedInstruction> instructions;
+    uint32_t startPc = 0;
+    uint32_t endPc = 0;
+    uint32_t bankOffset = 0;
+    bool valid = false;
+    bool inRam = false;
+    uint64_t hits = 0;
+    uint32_t misses = 0;
+
+    // Native translation, owned by the Recompiler; only usable while nativeGeneration matches its own
+    const uint8_t* nativeCode = nullptr;
+    uint32_t nativeGeneration = 0;
+    bool nativeDisabled = false;
+};
+
+// Cache of pre-decoded straight-line runs of SM83 code, keyed by bank offset and PC. Code in ROM, WRAM and
+// HRAM is cached; anything else is decoded on every execution as normal.
+class BlockCache {
+    friend class Recompiler;
+
+    static constexpr uint32_t MAX_BLOCK_INSTRUCTIONS = 64;
+    static constexpr uint32_t HRAM_CODE_MAP_OFFSET = 0x8000;
+    static constexpr uint32_t LOOKUP_SLOTS = 1024;
+
+    struct LookupSlot {
+        uint64_t key;
+        CachedBlock* block;
+    };
+
+    std::unordered_map<uint64_t, CachedBlock> blocks;
+    std::vector<CachedBlock*> ramBlocks;
+    std::vector<uint16_t> ramCodeMap;
+    LookupSlot lookupSlots[LOOKUP_SLOTS]{};
+    bool enabled = false;
+
+    CachedBlock* currentBlock = nullptr;
+    const DecodedInstruction* nextInstruction = nullptr;
+    const DecodedInstruction* blockEnd = nullptr;
+    uint32_t nextPc = 0;
+    uint32_t codeGeneration = 0;
+
+    CachedBlock* findBlock(Gbc& gbc);
+    void decodeBlock(Gbc& gbc, CachedBlock& block);
+    void markRamCode(const CachedBlock& block, int delta);
+    uint32_t ramCodeMapIndex(uint32_t pc, uint32_t bankOffset) const;
+    void invalidateRamCode(uint32_t codeMapIndex);
+
+public:
+    uint64_t totalHits = 0;
+    uint64_t totalMisses = 0;
+
+    BlockCache();
+    void setEnabled(bool enable);
+    [[nodiscard]] bool isEnabled() const { return enabled; }
+    void clear();
+
+    // Run one instruction, from the cache where possible; a drop-in replacement for CpuOps::dispatch
+    int execute(Gbc& gbc);
+
+    // Whether the PC is where the block being executed continues, rather than the start of a new block
+    [[nodiscard]] inline bool isMidBlock(uint32_t pc) const {
+        return currentBlock != nullptr && currentBlock->valid && pc == nextPc;
+    }
+
+    // Look up (decoding if needed) the block starting at the PC and make it the one being executed
+    CachedBlock* enterBlock(Gbc& gbc);
+    inline void leaveBlock() { currentBlock = nullptr; }
+
+    // Changes whenever cached code may no longer match what is mapped in, so callers can spot it mid-block
+    [[nodiscard]] inline uint32_t getCodeGeneration() const { return codeGeneration; }
+
+    // Called on writes that could change which bank code is fetched from
+    inline void bankChanged() {
+        currentBlock = nullptr;
+        codeGeneration++;
+    }
+
+    // Called on writes to WRAM (by index into the WRAM vector) and HRAM (by address)
+    inline void wramWritten(uint32_t wramIndex) {
+        if (ramCodeMap[wramIndex] != 0) {
+            invalidateRamCode(wramIndex);
+        }
+    }
+    inline void hramWritten(uint32_t address) {
+        uint32_t codeMapIndex = HRAM_CODE_MAP_OFFSET + (address & 0x7fU);
+        if (ramCodeMap[codeMapIndex] != 0) {
+            invalidateRamCode(codeMapIndex);
+        }
+    }
+
+    [[nodiscard]] const std::unordered_map<uint64_t, CachedBlock>& getBlocks() const { return blocks; }
+};
@@ -0,0 +1,557 @@
+#include "cpuops.h"
+
+#include "gbc.h"
+
+#ifdef _WIN32
+#include "debugwindowmodule.h"
+extern DebugWindowModule debugger;
+#endif
+
+// Expand a macro once for every opcode, passing the two hex digits of the opcode
+#define OPCODE_ROW(M, h) M(h, 0) M(h, 1) M(h, 2) M(h, 3) M(h, 4) M(h, 5) M(h, 6) M(h, 7) \
+                         M(h, 8) M(h, 9) M(h, a) M(h, b) M(h, c) M(h, d) M(h, e) M(h, f)
+#define ALL_OPCODES(M) OPCODE_ROW(M, 0) OPCODE_ROW(M, 1) OPCODE_ROW(M, 2) OPCODE_ROW(M, 3) \
+                       OPCODE_ROW(M, 4) OPCODE_ROW(M, 5) OPCODE_ROW(M, 6) OPCODE_ROW(M, 7) \
+                       OPCODE_ROW(M, 8) OPCODE_ROW(M, 9) OPCODE_ROW(M, a) OPCODE_ROW(M, b) \
+                       OPCODE_ROW(M, c) OPCODE_ROW(M, d) OPCODE_ROW(M, e) OPCODE_ROW(M, f)
+
+// Total instruction length in bytes, including the opcode and any immediate operand
+static constexpr uint8_t lengthOfInstruction(unsigned int opcode) {
+    switch (opcode) {
+        case 0x01: case 0x08: case 0x11: case 0x21: case 0x31:
+        case 0xc2: case 0xc3: case 0xc4: case 0xca: case 0xcc: case 0xcd:
+        case 0xd2: case 0xd4: case 0xda: case 0xdc: case 0xea: case 0xfa:
+            return 3;
+        case 0x06: case 0x0e: case 0x16: case 0x1e: case 0x26: case 0x2e: case 0x36: case 0x3e:
+        case 0x18: case 0x20: case 0x28: case 0x30: case 0x38:
+        case 0xc6: case 0xce: case 0xd6: case 0xde: case 0xe6: case 0xee: case 0xf6: case 0xfe:
+        case 0xcb: case 0xe0: case 0xe8: case 0xf0: case 0xf8:
+            return 2;
+        default:
+            return 1;
+    }
+}
+
+template <int Index>
+inline uint8_t CpuOps::readOperand(Gbc& gbc) {
+    if constexpr (Index == 0) {
+        return gbc.cpuBC.high;
+    } else if constexpr (Index == 1) {
+        return gbc.cpuBC.low;
+    } else if constexpr (Index == 2) {
+        return gbc.cpuDE.high;
+    } else if constexpr (Index == 3) {
+        return gbc.cpuDE.low;
+    } else if constexpr (Index == 4) {
+        return gbc.cpuHL.high;
+    } else if constexpr (Index == 5) {
+        return gbc.cpuHL.low;
+    } else if constexpr (Index == 6) {
+        return gbc.read8(gbc.cpuHL.word);
+    } else {
+        return gbc.cpuA;
+    }
+}
+
+template <int Index>
+inline void CpuOps::writeOperand(Gbc& gbc, uint8_t value) {
+    if constexpr (Index == 0) {
+        gbc.cpuBC.high = value;
+    } else if constexpr (Index == 1) {
+        gbc.cpuBC.low = value;
+    } else if constexpr (Index == 2) {
+        gbc.cpuDE.high = value;
+    } else if constexpr (Index == 3) {
+        gbc.cpuDE.low = value;
+    } else if constexpr (Index == 4) {
+        gbc.cpuHL.high = value;
+    } else if constexpr (Index == 5) {
+        gbc.cpuHL.low = value;
+    } else if constexpr (Index == 6) {
+        gbc.write8(gbc.cpuHL.word, value);
+    } else {
+        gbc.cpuA = value;
+    }
+}
+
+// Register pairs follow the opcode encoding: BC, DE, HL, SP
+inline unsigned int CpuOps::getPair(Gbc& gbc, int index) {
+    switch (index) {
+        case 0: return gbc.cpuBC.word;
+        case 1: return gbc.cpuDE.word;
+        case 2: return gbc.cpuHL.word;
+        default: return gbc.cpuSp;
+    }
+}
+
+inline void CpuOps::setPair(Gbc& gbc, int index, unsigned int value) {
+    switch (index) {
+        case 0:
+            gbc.cpuBC.word = (uint16_t)value;
+            break;
+        case 1:
+            gbc.cpuDE.word = (uint16_t)value;
+            break;
+        case 2:
+            gbc.cpuHL.word = (uint16_t)value;
+            break;
+        default:
+            gbc.cpuSp = value & 0xffffU;
+            break;
+    }
+}
+
+// Operations follow the opcode encoding: add, adc, sub, sbc, and, xor, or, cp. Flags are only recorded here and
+// evaluated when needed, see LazyFlags.
+template <int Operation>
+inline void CpuOps::alu(Gbc& gbc, uint8_t value) {
+    if constexpr (Operation == 0) {
+        gbc.lazyFlags.record(LazyFlags::ADD, gbc.cpuA, value);
+        gbc.cpuA += value;
+    } else if constexpr (Operation == 1) {
+        const uint8_t carry = gbc.peekFlags() & 0x10U;
+        gbc.lazyFlags.record(LazyFlags::ADC, gbc.cpuA, value, carry);
+        gbc.cpuA += value + (carry >> 4U);
+    } else if constexpr (Operation == 2) {
+        gbc.lazyFlags.record(LazyFlags::SUB, gbc.cpuA, value);
+        gbc.cpuA -= value;
+    } else if constexpr (Operation == 3) {
+        const uint8_t carry = gbc.peekFlags() & 0x10U;
+        gbc.lazyFlags.record(LazyFlags::SBC, gbc.cpuA, value, carry);
+        gbc.cpuA -= value + (carry >> 4U);
+    } else if constexpr (Operation == 4) {
+        gbc.lazyFlags.record(LazyFlags::AND, gbc.cpuA, value);
+        gbc.cpuA &= value;
+    } else if constexpr (Operation == 5) {
+        gbc.lazyFlags.record(LazyFlags::XOR, gbc.cpuA, value);
+        gbc.cpuA ^= value;
+    } else if constexpr (Operation == 6) {
+        gbc.lazyFlags.record(LazyFlags::OR, gbc.cpuA, value);
+        gbc.cpuA |= value;
+    } else {
+        gbc.lazyFlags.record(LazyFlags::CP, gbc.cpuA, value);
+    }
+}
+
+// Operations follow the extended opcode encoding: rlc, rrc, rl, rr, sla, sra, swap, srl
+template <int Operation>
+inline uint8_t CpuOps::rotateOrShift(Gbc& gbc, uint8_t value) {
+    uint8_t result;
+    uint8_t carry;
+    if constexpr (Operation == 0) {
+        carry = value & 0x80U;
+        result = (uint8_t)((value << 1U) | (carry >> 7U));
+    } else if constexpr (Operation == 1) {
+        carry = value & 0x01U;
+        result = (uint8_t)((value >> 1U) | (carry << 7U));
+    } else if constexpr (Operation == 2) {
+        carry = value & 0x80U;
+        result = (uint8_t)((value << 1U) | ((gbc.peekFlags() & 0x10U) >> 4U));
+    } else if constexpr (Operation == 3) {
+        carry = value & 0x01U;
+        result = (uint8_t)((value >> 1U) | ((gbc.peekFlags() & 0x10U) << 3U));
+    } else if constexpr (Operation == 4) {
+        carry = value & 0x80U;
+        result = (uint8_t)(value << 1U);
+    } else if constexpr (Operation == 5) {
+        carry = value & 0x01U;
+        result = (uint8_t)((value >> 1U) | (value & 0x80U));
+    } else if constexpr (Operation == 6) {
+        carry = 0x00;
+        result = (uint8_t)((value << 4U) | (value >> 4U));
+    } else {
+        carry = value & 0x01U;
+        result = (uint8_t)(value >> 1U);
+    }
+    gbc.lazyFlags.clear();
+    gbc.cpuF = carry != 0x00 ? 0x10U : 0x00U;
+    if (result == 0x00) gbc.cpuF |= 0x80U;
+    return result;
+}
+
+inline void CpuOps::push(Gbc& gbc, uint32_t value) {
+    gbc.cpuSp -= 2;
+    gbc.write16(gbc.cpuSp, (uint8_t)(value & 0xffU), (uint8_t)(value >> 8U));
+}
+
+inline uint32_t CpuOps::pop(Gbc& gbc) {
+    uint8_t lsb, msb;
+    gbc.read16(gbc.cpuSp, &lsb, &msb);
+    gbc.cpuSp += 2;
+    return ((unsigned int)msb << 8U) + (unsigned int)lsb;
+}
+
+// Conditions follow the opcode encoding: NZ, Z, NC, C
+template <int Condition>
+inline bool CpuOps::conditionMet(Gbc& gbc) {
+    if constexpr (Condition == 0) {
+        return (gbc.peekFlags() & 0x80U) == 0x00;
+    } else if constexpr (Condition == 1) {
+        return (gbc.peekFlags() & 0x80U) != 0x00;
+    } else if constexpr (Condition == 2) {
+        return (gbc.peekFlags() & 0x10U) == 0x00;
+    } else {
+        return (gbc.peekFlags() & 0x10U) != 0x00;
+    }
+}
+
+template <uint8_t Op>
+inline int CpuOps::execute(Gbc& gbc, uint32_t operand) {
+    constexpr int x = Op >> 6U;
+    constexpr int y = (Op >> 3U) & 0x07U;
+    constexpr int z = Op & 0x07U;
+
+    if constexpr (Op == 0x00) { // nop
+        return 4;
+    } else if constexpr (Op == 0x08) { // ld (nn), SP
+        gbc.write16(operand, (uint8_t)(gbc.cpuSp & 0x00ffU), (uint8_t)((gbc.cpuSp >> 8U) & 0x00ffU));
+        return 20;
+    } else if constexpr (Op == 0x10) { // stop
+        gbc.cpuMode = CPU_STOPPED;
+        return 4;
+    } else if constexpr (Op == 0x18) { // jr d
+        const uint32_t branchEnd = gbc.cpuPc;
+        gbc.cpuPc += (uint32_t)(int8_t)operand;
+        return gbc.idleLoops.jumped(gbc, gbc.cpuPc, branchEnd, 12);
+    } else if constexpr (x == 0 && z == 0) { // jr cc, d
+        if (conditionMet<y - 4>(gbc)) {
+            const uint32_t branchEnd = gbc.cpuPc;
+            gbc.cpuPc += (uint32_t)(int8_t)operand;
+            return gbc.idleLoops.jumped(gbc, gbc.cpuPc, branchEnd, 12);
+        }
+        return 8;
+    } else if constexpr (x == 0 && z == 1 && (y & 1) == 0) { // ld rr, nn
+        setPair(gbc, y >> 1, operand);
+        return 12;
+    } else if constexpr (Op == 0x29) { // add HL, HL
+        gbc.materialiseFlags();
+        gbc.cpuF &= 0x80U;
+        if ((gbc.cpuHL.high & 0x80U) != 0x00) gbc.cpuF |= 0x10U;
+        if ((gbc.cpuHL.high & 0x08U) != 0x00) gbc.cpuF |= 0x20U;
+        setPair(gbc, 2, getPair(gbc, 2) << 1U);
+        return 8;
+    } else if constexpr (Op == 0x39) { // add HL, SP
+        gbc.materialiseFlags();
+        gbc.cpuF &= 0x80U;
+        gbc.cpuHL.word += (uint16_t)gbc.cpuSp;
+        const auto value = (uint8_t)(gbc.cpuSp >> 8U);
+        if (gbc.cpuHL.high < value) gbc.cpuF |= 0x10U;
+        if ((gbc.cpuHL.high & 0x0fU) < (value & 0x0fU)) gbc.cpuF |= 0x20U;
+        return 8;
+    } else if constexpr (x == 0 && z == 1) { // add HL, BC or DE
+        const unsigned int value = getPair(gbc, y >> 1);
+        const unsigned int hl = gbc.cpuHL.word;
+        gbc.materialiseFlags();
+        gbc.cpuF &= 0x80U;
+        if (hl + value > 0xffffU) gbc.cpuF |= 0x10U;
+        if ((hl & 0x0fffU) + (value & 0x0fffU) > 0x0fffU) gbc.cpuF |= 0x20U;
+        gbc.cpuHL.word = (uint16_t)(hl + value);
+        return 8;
+    } else if constexpr (x == 0 && z == 2) { // ld (rr), A and ld A, (rr), with HL incremented or decremented
+        constexpr int pair = y < 4 ? y >> 1 : 2;
+        const unsigned int address = getPair(gbc, pair);
+        if constexpr ((y & 1) == 0) {
+            gbc.write8(address, gbc.cpuA);
+        } else {
+            gbc.cpuA = gbc.read8(address);
+        }
+        if constexpr (y == 4 || y == 5) {
+            setPair(gbc, 2, address + 1);
+        } else if constexpr (y == 6 || y == 7) {
+            setPair(gbc, 2, address - 1);
+        }
+        return 8;
+    } else if constexpr (x == 0 && z == 3) { // inc rr or dec rr
+        if constexpr ((y & 1) == 0) {
+            setPair(gbc, y >> 1, getPair(gbc, y >> 1) + 1);
+        } else {
+            setPair(gbc, y >> 1, getPair(gbc, y >> 1) - 1);
+        }
+        return 8;
+    } else if constexpr (x == 0 && z == 4) { // inc r
+        const uint8_t value = readOperand<y>(gbc);
+        gbc.lazyFlags.record(LazyFlags::INC, value, 0, gbc.peekFlags() & 0x10U);
+        writeOperand<y>(gbc, (uint8_t)(value + 1));
+        return y == 6 ? 12 : 4;
+    } else if constexpr (x == 0 && z == 5) { // dec r
+        const uint8_t value = readOperand<y>(gbc);
+        gbc.lazyFlags.record(LazyFlags::DEC, value, 0, gbc.peekFlags() & 0x10U);
+        writeOperand<y>(gbc, (uint8_t)(value - 1));
+        return y == 6 ? 12 : 4;
+    } else if constexpr (x == 0 && z == 6) { // ld r, n
+        writeOperand<y>(gbc, (uint8_t)operand);
+        return y == 6 ? 12 : 8;
+    } else if constexpr (x == 0 && y < 4) { // rlca, rrca, rla, rra
+        gbc.cpuA = rotateOrShift<y>(gbc, gbc.cpuA);
+        gbc.cpuF &= 0x10U;
+        return 4;
+    } else if constexpr (Op == 0x27) { // daa
+        gbc.materialiseFlags();
+        if ((gbc.cpuF & 0x40U) == 0x00) {
+            if (((gbc.cpuA & 0x0fU) > 0x09) || ((gbc.cpuF & 0x20U) != 0x00)) {
+                gbc.cpuA += 0x06;
+            }
+            const uint8_t carry = gbc.cpuF & 0x10U;
+            gbc.cpuF &= 0x40U;
+            if ((gbc.cpuA > 0x9f) || (carry != 0x00)) {
+                gbc.cpuA += 0x60;
+                gbc.cpuF |= 0x10U;
+            }
+        } else {
+            if (((gbc.cpuA & 0x0fU) > 0x09) || ((gbc.cpuF & 0x20U) != 0x00)) {
+                gbc.cpuA -= 0x06;
+            }
+            const uint8_t carry = gbc.cpuF & 0x10U;
+            gbc.cpuF &= 0x40U;
+            if ((gbc.cpuA > 0x9f) || (carry != 0x00)) {
+                gbc.cpuA -= 0x60;
+                gbc.cpuF |= 0x10U;
+            }
+        }
+        if (gbc.cpuA == 0x00) gbc.cpuF |= 0x80U;
+        return 4;
+    } else if constexpr (Op == 0x2f) { // cpl
+        gbc.cpuA = ~gbc.cpuA;
+        gbc.materialiseFlags();
+        gbc.cpuF |= 0x60U;
+        return 4;
+    } else if constexpr (Op == 0x37) { // scf
+        gbc.materialiseFlags();
+        gbc.cpuF &= 0x80U;
+        gbc.cpuF |= 0x10U;
+        return 4;
+    } else if constexpr (Op == 0x3f) { // ccf
+        gbc.materialiseFlags();
+        gbc.cpuF = (gbc.cpuF & 0x80U) | ((gbc.cpuF & 0x30U) ^ 0x30U);
+        return 4;
+    } else if constexpr (Op == 0x76) { // halt
+        gbc.cpuMode = CPU_HALTED;
+        return 4;
+    } else if constexpr (x == 1) { // ld r, r
+        if constexpr (y != z) {
+            writeOperand<y>(gbc, readOperand<z>(gbc));
+        }
+        return y == 6 || z == 6 ? 8 : 4;
+    } else if constexpr (x == 2) { // alu A, r
+        alu<y>(gbc, readOperand<z>(gbc));
+        return z == 6 ? 8 : 4;
+    } else if constexpr (Op == 0xde) { // sbc A, n
+        const uint8_t original = gbc.cpuA;
+        const uint8_t carry = gbc.peekFlags() & 0x10U;
+        gbc.lazyFlags.clear();
+        gbc.cpuF = 0x40;
+        gbc.cpuA -= (uint8_t)operand;
+        if (carry != 0x00) {
+            if (gbc.cpuA == 0x00) {
+                gbc.cpuF |= 0x30U;
+            }
+            gbc.cpuA--;
+        }
+        if (gbc.cpuA > original) gbc.cpuF |= 0x10U;
+        if (gbc.cpuA == 0x00) gbc.cpuF |= 0x80U;
+        if ((gbc.cpuA & 0x0fU) > (original & 0x0fU)) gbc.cpuF |= 0x20U;
+        return 8;
+    } else if constexpr (x == 3 && z == 6) { // alu A, n
+        alu<y>(gbc, (uint8_t)operand);
+        return 8;
+    } else if constexpr (x == 3 && z == 0 && y < 4) { // ret cc
+        if (conditionMet<y>(gbc)) {
+#ifdef _WIN32
+            if (debugger.totalBreakEnables > 0) {
+                debugger.breakLastCallReturned = 1;
+            }
+#endif
+            gbc.cpuPc = pop(gbc);
+            return 20;
+        }
+        return 8;
+    } else if constexpr (Op == 0xe0) { // ldh (n), A
+        gbc.write8(0xff00 + operand, gbc.cpuA);
+        return 12;
+    } else if constexpr (Op == 0xe8) { // add SP, d
+        gbc.lazyFlags.clear();
+        gbc.cpuF = 0x00;
+        if (operand >= 0x80) {
+            const unsigned int offset = 256 - operand;
+            gbc.cpuSp -= offset;
+            if ((gbc.cpuSp & 0x0000ffffU) > (offset & 0x0000ffffU)) gbc.cpuF |= 0x10U;
+            if ((gbc.cpuSp & 0x000000ffU) > (offset & 0x000000ffU)) gbc.cpuF |= 0x20U;
+        } else {
+            gbc.cpuSp += operand;
+            if ((gbc.cpuSp & 0x0000ffffU) < (operand & 0x0000ffffU)) gbc.cpuF |= 0x10U;
+            if ((gbc.cpuSp & 0x000000ffU) < (operand & 0x000000ffU)) gbc.cpuF |= 0x20U;
+        }
+        return 16;
+    } else if constexpr (Op == 0xf0) { // ldh A, (n)
+        gbc.cpuA = gbc.read8(0xff00 + operand);
+        return 12;
+    } else if constexpr (Op == 0xf8) { // ld HL, SP+d
+        gbc.lazyFlags.clear();
+        gbc.cpuF = 0x00;
+        unsigned int address = gbc.cpuSp;
+        if (operand >= 0x80) {
+            address -= 256 - operand;
+            if (address > gbc.cpuSp) gbc.cpuF |= 0x10U;
+            if ((address & 0x00ffffffU) > (gbc.cpuSp & 0x00ffffffU)) gbc.cpuF |= 0x20U;
+        } else {
+            address += operand;
+            if (gbc.cpuSp > address) gbc.cpuF |= 0x10U;
+            if ((gbc.cpuSp & 0x00ffffffU) > (address & 0x00ffffffU)) gbc.cpuF |= 0x20U;
+        }
+        gbc.cpuHL.word = (uint16_t)address;
+        return 12;
+    } else if constexpr (Op == 0xf1) { // pop AF
+        const uint32_t value = pop(gbc);
+        gbc.cpuA = (uint8_t)(value >> 8U);
+        gbc.lazyFlags.clear();
+        gbc.cpuF = (uint8_t)(value & 0xf0U);
+        return 12;
+    } else if constexpr (x == 3 && z == 1 && (y & 1) == 0) { // pop rr
+        setPair(gbc, y >> 1, pop(gbc));
+        return 12;
+    } else if constexpr (Op == 0xc9 || Op == 0xd9) { // ret, reti
+#ifdef _WIN32
+        if (debugger.totalBreakEnables > 0) {
+            debugger.breakLastCallReturned = 1;
+        }
+#endif
+        gbc.cpuPc = pop(gbc);
+        if constexpr (Op == 0xd9) {
+            gbc.cpuIme = true;
+        }
+        return 16;
+    } else if constexpr (Op == 0xe9) { // jp HL
+        gbc.cpuPc = getPair(gbc, 2);
+        return 4;
+    } else if constexpr (Op == 0xf9) { // ld SP, HL
+        gbc.cpuSp = getPair(gbc, 2);
+        return 8;
+    } else if constexpr (Op == 0xc3) { // jp nn
+        const uint32_t branchEnd = gbc.cpuPc;
+        gbc.cpuPc = operand;
+        return gbc.idleLoops.jumped(gbc, operand, branchEnd, 16);
+    } else if constexpr (x == 3 && z == 2 && y < 4) { // jp cc, nn
+        if (conditionMet<y>(gbc)) {
+            const uint32_t branchEnd = gbc.cpuPc;
+            gbc.cpuPc = operand;
+            return gbc.idleLoops.jumped(gbc, operand, branchEnd, 16);
+        }
+        return 12;
+    } else if constexpr (Op == 0xe2) { // ldh (C), A
+        gbc.write8(0xff00 + (unsigned int)gbc.cpuBC.low, gbc.cpuA);
+        return 8;
+    } else if constexpr (Op == 0xea) { // ld (nn), A
+        gbc.write8(operand, gbc.cpuA);
+        return 16;
+    } else if constexpr (Op == 0xf2) { // ldh A, (C)
+        gbc.cpuA = gbc.read8(0xff00 + (unsigned int)gbc.cpuBC.low);
+        return 8;
+    } else if constexpr (Op == 0xfa) { // ld A, (nn)
+        gbc.cpuA = gbc.read8(operand);
+        return 16;
+    } else if constexpr (Op == 0xcb) { // extended instructions
+        return extendedTable[operand](gbc, operand);
+    } else if constexpr (Op == 0xf3) { // di
+        gbc.cpuIme = false;
+        return 4;
+    } else if constexpr (Op == 0xfb) { // ei
+        gbc.cpuIme = true;
+        return 4;
+    } else if constexpr (Op == 0xcd || (x == 3 && z == 4 && y < 4)) { // call nn, call cc, nn
+        if constexpr (Op != 0xcd) {
+            if (!conditionMet<y>(gbc)) {
+                return 12;
+            }
+        }
+#ifdef _WIN32
+        if (debugger.totalBreakEnables > 0) {
+            debugger.breakLastCallAt = gbc.cpuPc - 3;
+            debugger.breakLastCallTo = operand;
+            debugger.breakLastCallReturned = 0;
+        }
+#endif
+        push(gbc, gbc.cpuPc);
+        gbc.cpuPc = operand;
+        return 24;
+    } else if constexpr (Op == 0xf5) { // push AF
+        gbc.materialiseFlags();
+        push(gbc, ((uint32_t)gbc.cpuA << 8U) + (uint32_t)gbc.cpuF);
+        return 16;
+    } else if constexpr (x == 3 && z == 5 && (y & 1) == 0) { // push rr
+        push(gbc, getPair(gbc, y >> 1));
+        return 16;
+    } else if constexpr (x == 3 && z == 7) { // rst n
+#ifdef _WIN32
+        if (debugger.totalBreakEnables > 0) {
+            debugger.breakLastCallAt = gbc.cpuPc - 1;
+            debugger.breakLastCallTo = y * 8;
+            debugger.breakLastCallReturned = 0;
+        }
+#endif
+        push(gbc, gbc.cpuPc);
+        gbc.cpuPc = y * 8;
+        return 16;
+    } else { // Removed instructions: d3, db, dd, e3, e4, eb, ec, ed, f4, fc, fd
+        gbc.cpuPc--;
+        return gbc.runInvalidInstruction(Op);
+    }
+}
+
+template <uint8_t Op>
+inline int CpuOps::executeExtended(Gbc& gbc, uint32_t) {
+    constexpr int x = Op >> 6U;
+    constexpr int y = (Op >> 3U) & 0x07U;
+    constexpr int z = Op & 0x07U;
+    constexpr uint8_t bitMask = 0x01U << (unsigned int)y;
+
+    if constexpr (x == 0) { // rlc, rrc, rl, rr, sla, sra, swap, srl
+        writeOperand<z>(gbc, rotateOrShift<y>(gbc, readOperand<z>(gbc)));
+        return z == 6 ? 16 : 8;
+    } else if constexpr (x == 1) { // bit n, r
+        gbc.materialiseFlags();
+        gbc.cpuF &= 0x30U;
+        gbc.cpuF |= 0x20U;
+        if ((readOperand<z>(gbc) & bitMask) == 0x00) gbc.cpuF |= 0x80U;
+        return z == 6 ? 12 : 8;
+    } else if constexpr (x == 2) { // res n, r
+        writeOperand<z>(gbc, readOperand<z>(gbc) & (uint8_t)~bitMask);
+        return z == 6 ? 16 : 8;
+    } else { // set n, r
+        writeOperand<z>(gbc, readOperand<z>(gbc) | bitMask);
+        return z == 6 ? 16 : 8;
+    }
+}
+
+#define INSTRUCTION_LENGTH(h, l) lengthOfInstruction(0x##h##l),
+#define MAIN_HANDLER(h, l) &CpuOps::execute<0x##h##l>,
+#define EXTENDED_HANDLER(h, l) &CpuOps::executeExtended<0x##h##l>,
+
+const uint8_t CpuOps::instructionLengths[256] = { ALL_OPCODES(INSTRUCTION_LENGTH) };
+const OpHandler CpuOps::mainTable[256] = { ALL_OPCODES(MAIN_HANDLER) };
+const OpHandler CpuOps::extendedTable[256] = { ALL_OPCODES(EXTENDED_HANDLER) };
+
+int CpuOps::dispatch(Gbc& gbc) {
+    const uint8_t instr = gbc.fetch8(gbc.cpuPc);
+    const uint8_t length = instructionLengths[instr];
+    uint32_t operand = 0;
+    if (length > 1) {
+        operand = gbc.fetch8(gbc.cpuPc + 1);
+        if (length > 2) {
+            operand += (uint32_t)gbc.fetch8(gbc.cpuPc + 2) << 8U;
+        }
+    }
+    gbc.cpuPc += length;
+
+#if defined(__GNUC__) || defined(__clang__)
+    // Jump straight to an inlined copy of each handler rather than calling through the table
+#define LABEL_ADDRESS(h, l) &&op_##h##l,
+#define LABEL_BODY(h, l) op_##h##l: return execute<0x##h##l>(gbc, operand);
+    static const void* const labels[256] = { ALL_OPCODES(LABEL_ADDRESS) };
+    goto *labels[instr];
+    ALL_OPCODES(LABEL_BODY)
+#undef LABEL_ADDRESS
+#undef LABEL_BODY
+#else
+    return mainTable[instr](gbc, operand);
+#endif
+}
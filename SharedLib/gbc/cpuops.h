@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+class Gbc;
+
+// Opcode handler, run after the dispatcher has fetched any immediate operand and moved the PC past the
+// instruction; returns how many clocks the instruction consumed
+typedef int (*OpHandler)(Gbc& gbc, uint32_t operand);
+
+class CpuOps {
+    // Register operands follow the opcode encoding: B, C, D, E, H, L, (HL), A
+    template <int Index> static uint8_t readOperand(Gbc& gbc);
+    template <int Index> static void writeOperand(Gbc& gbc, uint8_t value);
+    static unsigned int getPair(Gbc& gbc, int index);
+    static void setPair(Gbc& gbc, int index, unsigned int value);
+
+    template <int Operation> static void alu(Gbc& gbc, uint8_t value);
+    template <int Operation> static uint8_t rotateOrShift(Gbc& gbc, uint8_t value);
+    static void push(Gbc& gbc, uint32_t value);
+    static uint32_t pop(Gbc& gbc);
+    template <int Condition> static bool conditionMet(Gbc& gbc);
+
+    template <uint8_t Op> static int execute(Gbc& gbc, uint32_t operand);
+    template <uint8_t Op> static int executeExtended(Gbc& gbc, uint32_t operand);
+
+public:
+    static const OpHandler mainTable[256];
+    static const OpHandler extendedTable[256];
+    static const uint8_t instructionLengths[256];
+
+    // Fetch, decode and run the instruction at the PC; a drop-in replacement for Gbc::performOp
+    static int dispatch(Gbc& gbc);
+};
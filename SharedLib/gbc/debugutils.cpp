@@ -13,10 +13,10 @@ void DebugUtils::writeTraceFile(Gbc* gbc, FILE* file) {
     stream << "Registers:" << std::endl;
     stream << "PC=0x" << std::setw(4) << (int)gbc->cpuPc << std::endl;
     stream << "SP=0x" << std::setw(4) << (int)gbc->cpuSp << std::endl;
-    stream << "AF=0x" << std::setw(2) << (int)gbc->cpuA << std::setw(2) << (int)gbc->cpuF << std::endl;
-    stream << "BC=0x" << std::setw(2) << (int)gbc->cpuB << std::setw(2) << (int)gbc->cpuC << std::endl;
-    stream << "DE=0x" << std::setw(2) << (int)gbc->cpuD << std::setw(2) << (int)gbc->cpuE << std::endl;
-    stream << "HL=0x" << std::setw(2) << (int)gbc->cpuH << std::setw(2) << (int)gbc->cpuL << std::endl;
+    stream << "AF=0x" << std::setw(2) << (int)gbc->cpuA << std::setw(2) << (int)gbc->peekFlags() << std::endl;
+    stream << "BC=0x" << std::setw(4) << (int)gbc->cpuBC.word << std::endl;
+    stream << "DE=0x" << std::setw(4) << (int)gbc->cpuDE.word << std::endl;
+    stream << "HL=0x" << std::setw(4) << (int)gbc->cpuHL.word << std::endl;
     stream << std::endl;
 
     // Print current ROM bank:
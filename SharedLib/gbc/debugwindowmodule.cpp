@@ -705,19 +705,19 @@ void DebugWindowModule::loadMemoryDetails(int statusChanged) {
 		text << "CPU regs AFBCDEHL ";
 		Insert = (int)(gbc->cpuA); text << Insert;
 		if (Insert < 10) text << "   "; else if (Insert < 100) text << "  "; else text << " ";
-		Insert = (int)(gbc->cpuF); text << Insert;
+		Insert = (int)(gbc->peekFlags()); text << Insert;
 		if (Insert < 10) text << "   "; else if (Insert < 100) text << "  "; else text << " ";
-		Insert = (int)(gbc->cpuB); text << Insert;
+		Insert = (int)(gbc->cpuBC.high); text << Insert;
 		if (Insert < 10) text << "   "; else if (Insert < 100) text << "  "; else text << " ";
-		Insert = (int)(gbc->cpuC); text << Insert;
+		Insert = (int)(gbc->cpuBC.low); text << Insert;
 		if (Insert < 10) text << "   "; else if (Insert < 100) text << "  "; else text << " ";
-		Insert = (int)(gbc->cpuD); text << Insert;
+		Insert = (int)(gbc->cpuDE.high); text << Insert;
 		if (Insert < 10) text << "   "; else if (Insert < 100) text << "  "; else text << " ";
-		Insert = (int)(gbc->cpuE); text << Insert;
+		Insert = (int)(gbc->cpuDE.low); text << Insert;
 		if (Insert < 10) text << "   "; else if (Insert < 100) text << "  "; else text << " ";
-		Insert = (int)(gbc->cpuH); text << Insert;
+		Insert = (int)(gbc->cpuHL.high); text << Insert;
 		if (Insert < 10) text << "   "; else if (Insert < 100) text << "  "; else text << " ";
-		Insert = (int)(gbc->cpuL); text << Insert;
+		Insert = (int)(gbc->cpuHL.low); text << Insert;
 		if (Insert < 10) text << "   "; else if (Insert < 100) text << "  "; else text << " ";
 		text << "\r\nPC " << gbc->cpuPc;
 		text << "\r\nSP " << gbc->cpuSp;
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+
+// Deadlines on the Gbc's cycle counter for the hardware that would otherwise be polled after every instruction.
+// There are only a handful of event types and each is pending at most once, so every type has a fixed slot and the
+// earliest deadline is cached; checking whether anything is due is then a single comparison.
+class EventScheduler {
+public:
+    // Due events run in deadline order, ties going to the lowest value, which follows the order the per-instruction
+    // checks used to run in
+    enum Event : uint8_t {
+        LY_COMPARE = 0,
+        TIMER_OVERFLOW,
+        SERIAL,
+        VIDEO,
+        EVENT_COUNT
+    };
+
+    static constexpr uint64_t NEVER = UINT64_MAX;
+
+private:
+    uint64_t deadlines[EVENT_COUNT]{};
+    uint64_t nextDeadline = NEVER;
+
+    inline void findNextDeadline() {
+        nextDeadline = NEVER;
+        for (uint64_t deadline : deadlines) {
+            if (deadline < nextDeadline) {
+                nextDeadline = deadline;
+            }
+        }
+    }
+
+public:
+    EventScheduler() {
+        clear();
+    }
+
+    inline void clear() {
+        for (uint64_t& deadline : deadlines) {
+            deadline = NEVER;
+        }
+        nextDeadline = NEVER;
+    }
+
+    inline void schedule(Event event, uint64_t deadline) {
+        deadlines[event] = deadline;
+        findNextDeadline();
+    }
+
+    inline void cancel(Event event) {
+        schedule(event, NEVER);
+    }
+
+    [[nodiscard]] inline uint64_t getNextDeadline() const { return nextDeadline; }
+
+    // Take the earliest event with a deadline at or before the given cycle, or return EVENT_COUNT if none is due
+    inline Event takeDueEvent(uint64_t cycle) {
+        if (nextDeadline > cycle) {
+            return EVENT_COUNT;
+        }
+        auto event = (Event)0;
+        for (int i = 1; i < EVENT_COUNT; i++) {
+            if (deadlines[i] < deadlines[event]) {
+                event = (Event)i;
+            }
+        }
+        cancel(event);
+        return event;
+    }
+};
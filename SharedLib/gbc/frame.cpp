@@ -1,26 +1,109 @@
 #include "frame.h"
 
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    // Cheap rather than strong; a collision would only leave one frame undrawn
+    inline uint64_t hashWords(uint64_t hash, const void* data, size_t bytes) {
+        const auto* byteData = static_cast<const uint8_t*>(data);
+        for (size_t offset = 0; offset < bytes; offset += sizeof(uint64_t)) {
+            uint64_t word;
+            memcpy(&word, byteData + offset, sizeof(word));
+            hash = (hash ^ word) * 0x9e3779b97f4a7c15ULL;
+            hash ^= hash >> 29U;
+        }
+        return hash;
+    }
+}
+
 Frame::Frame() {
     status = FrameStatus::AVAILABLE;
+    format = PixelFormat::RGBA;
     buffer = new uint32_t[BASE_FRAME_W * (BASE_FRAME_H + PADDING_ROWS)];
+    indices = new uint8_t[BASE_FRAME_W * BASE_FRAME_H]();
+    snapshots = new uint32_t[BASE_FRAME_H * SNAPSHOT_COLOURS]();
+    snapshotCount = 0;
+    unchanged = false;
 }
 
 Frame::~Frame() {
     delete[] buffer;
+    delete[] indices;
+    delete[] snapshots;
 }
 
-uint32_t* Frame::getForDrawing() {
+uint32_t* Frame::getForDrawing(PixelFormat pixelFormat) {
     if (status != FrameStatus::AVAILABLE) {
         return nullptr;
     }
     status = FrameStatus::BEING_DRAWN;
+    format = pixelFormat;
+    snapshotCount = 0;
+    unchanged = false;
     return buffer;
 }
 
-bool Frame::markForRendering() {
+void Frame::recordPalettes(unsigned int lineNo, const uint32_t* bg, size_t bgCount, const uint32_t* obj,
+                           size_t objCount, bool changed) {
+    if (changed || snapshotCount == 0) {
+        // Lines drawn again after the LCD restarts part way through a frame can outnumber the snapshots; the last is
+        // overwritten then
+        snapshotCount = std::min(snapshotCount + 1, (unsigned int)BASE_FRAME_H);
+        uint32_t* snapshot = &snapshots[(snapshotCount - 1) * SNAPSHOT_COLOURS];
+        memcpy(snapshot, bg, bgCount * sizeof(uint32_t));
+        memcpy(snapshot + bgCount, obj, objCount * sizeof(uint32_t));
+        snapshotHashes[snapshotCount - 1] = hashWords(0, snapshot, (bgCount + objCount) * sizeof(uint32_t));
+    }
+    lineSnapshots[lineNo] = (uint8_t)(snapshotCount - 1);
+}
+
+void Frame::convertToRgba() {
+    for (size_t lineNo = 0; lineNo < BASE_FRAME_H; lineNo++) {
+        const uint32_t* palette = &snapshots[lineSnapshots[lineNo] * SNAPSHOT_COLOURS];
+        const uint8_t* src = &indices[lineNo * BASE_FRAME_W];
+        uint32_t* dst = &buffer[lineNo * BASE_FRAME_W];
+        for (size_t x = 0; x < BASE_FRAME_W; x++) {
+            dst[x] = src[x] == BLANK_INDEX ? 0x000000ffU : palette[src[x]];
+        }
+    }
+}
+
+// Indexed lines are hashed along with the palettes they index
+void Frame::hashLine(unsigned int lineNo) {
+    if (format == PixelFormat::INDEXED) {
+        lineHashes[lineNo] = hashWords(snapshotHashes[lineSnapshots[lineNo]], &indices[lineNo * BASE_FRAME_W],
+                                       BASE_FRAME_W);
+    } else {
+        lineHashes[lineNo] = hashWords(0, &buffer[lineNo * BASE_FRAME_W], BASE_FRAME_W * sizeof(uint32_t));
+    }
+}
+
+void Frame::clear() {
+    if (format == PixelFormat::INDEXED) {
+        memset(indices, BLANK_INDEX, BASE_FRAME_W * BASE_FRAME_H);
+        memset(lineSnapshots, 0, sizeof(lineSnapshots));
+        snapshotHashes[0] = 0;
+    } else {
+        std::fill(buffer, buffer + BASE_FRAME_W * BASE_FRAME_H, 0x000000ffU);
+    }
+    for (unsigned int lineNo = 0; lineNo < BASE_FRAME_H; lineNo++) {
+        hashLine(lineNo);
+    }
+}
+
+bool Frame::markForScaling() {
     if (status != FrameStatus::BEING_DRAWN) {
         return false;
     }
+    status = FrameStatus::BEING_SCALED;
+    return true;
+}
+
+bool Frame::markForRendering() {
+    if (status != FrameStatus::BEING_SCALED) {
+        return false;
+    }
     status = FrameStatus::BEING_RENDERED;
     return true;
 }
@@ -1,31 +1,76 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 
 constexpr size_t BASE_FRAME_W = 160;
 constexpr size_t BASE_FRAME_H = 144;
 constexpr size_t PADDING_ROWS = 10;
-constexpr size_t FRAME_SCALE_FACTOR = 4;
+
+// How a frame is drawn into: straight to RGBA, or a byte per pixel indexing a snapshot of the palettes in use on its
+// line, which is only turned into RGBA once the frame is finished
+enum class PixelFormat {
+    RGBA,
+    INDEXED
+};
 
 class Frame {
     enum class FrameStatus {
         AVAILABLE,
         BEING_DRAWN,
+        BEING_SCALED,
         BEING_RENDERED
     };
 
-    FrameStatus status;
+    // Handed between the emulation, scaler and render threads, each of which only moves it on from its own stage
+    std::atomic<FrameStatus> status;
+    PixelFormat format;
     uint32_t* buffer;
 
+    // Indexed pixels, and for each line which of the palette snapshots they index. A line shares the snapshot of the
+    // line before unless the palettes changed in between.
+    uint8_t* indices;
+    uint8_t lineSnapshots[BASE_FRAME_H]{};
+    uint32_t* snapshots;
+    unsigned int snapshotCount;
+
+    // A hash of each line's content as drawn, taken while it's still in the cache, and of each palette snapshot for
+    // the indexed lines to take in. A frame whose hashes all match the last one finished is marked unchanged.
+    uint64_t lineHashes[BASE_FRAME_H]{};
+    uint64_t snapshotHashes[BASE_FRAME_H]{};
+    bool unchanged;
+
 public:
+    static constexpr size_t SNAPSHOT_COLOURS = 64;
+    static constexpr uint8_t BLANK_INDEX = 0xff;
+
     Frame();
     ~Frame();
-    [[nodiscard]] uint32_t* getForDrawing();
+    [[nodiscard]] uint32_t* getForDrawing(PixelFormat pixelFormat);
+    [[nodiscard]] bool markForScaling();
     [[nodiscard]] bool markForRendering();
     [[nodiscard]] bool markAvailable();
 
     [[nodiscard]] inline bool isAvailable() const { return status == FrameStatus::AVAILABLE; }
     [[nodiscard]] inline bool isBeingDrawn() const { return status == FrameStatus::BEING_DRAWN; }
+    [[nodiscard]] inline bool isBeingScaled() const { return status == FrameStatus::BEING_SCALED; }
     [[nodiscard]] inline bool isBeingRendered() const { return status == FrameStatus::BEING_RENDERED; }
     [[nodiscard]] inline uint32_t* getBuffer() const { return buffer; }
+
+    // Indexed drawing; OBJ colours follow the BG colours in each snapshot, and BLANK_INDEX is always black
+    [[nodiscard]] inline PixelFormat getFormat() const { return format; }
+    [[nodiscard]] inline uint8_t* getIndices() const { return indices; }
+    void recordPalettes(unsigned int lineNo, const uint32_t* bg, size_t bgCount, const uint32_t* obj, size_t objCount,
+                        bool changed);
+    void convertToRgba();
+
+    // Content hashes, and whether the frame was found to be no different from the one before it
+    void hashLine(unsigned int lineNo);
+    [[nodiscard]] inline const uint64_t* getLineHashes() const { return lineHashes; }
+    [[nodiscard]] inline bool isUnchanged() const { return unchanged; }
+    inline void setUnchanged(bool isUnchanged) { unchanged = isUnchanged; }
+
+    // Fill with black in whichever format the frame is being drawn in
+    void clear();
 };
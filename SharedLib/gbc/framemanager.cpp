@@ -1,48 +1,99 @@
 #include "framemanager.h"
 
-#include <filters.h>
-
-xbr_data xbrData;
-xbr_params xbrParams1;
-xbr_params xbrParams2;
-uint32_t* extendedBuffer1;
-uint32_t* extendedBuffer2;
+#include <algorithm>
+#include <cstring>
+#include <memory>
 
 FrameManager::FrameManager() :
     frame1(),
     frame2(),
-    nextFrameToBegin(1) {
+    extendedBuffer1(nullptr),
+    extendedBuffer2(nullptr),
+    extendedScale1(0),
+    extendedScale2(0),
+    nextFrameToBegin(1),
+    nextFrameToRender(1),
+    pixelFormat(PixelFormat::RGBA),
+    frameSkip(0),
+    framesSkipped(0),
+    fastForwarding(false),
+    fullFrameRequested(true),
+    framesFinished(0),
+    framesElided(0),
+    scalerType(DEFAULT_SCALER),
+    frameScaler(FrameScaler::make(DEFAULT_SCALER)),
+    scalerBands(std::make_unique<BandPool>(1)),
+    scaler([this](Frame& frame) { scaleFrame(frame); }) {
+}
 
-	delete[] extendedBuffer1;
-	delete[] extendedBuffer2;
-	extendedBuffer1 = new uint32_t[BASE_FRAME_W * BASE_FRAME_H * FRAME_SCALE_FACTOR * FRAME_SCALE_FACTOR];
-	extendedBuffer2 = new uint32_t[BASE_FRAME_W * BASE_FRAME_H * FRAME_SCALE_FACTOR * FRAME_SCALE_FACTOR];
+FrameManager::~FrameManager() {
+    // Let the scaler finish with the buffers before they go
+    scaler.waitUntilIdle();
+    delete[] extendedBuffer1;
+    delete[] extendedBuffer2;
+}
 
-	xbr_init_data(&xbrData);
+void FrameManager::upscale(const Frame& frame, uint32_t* output) const {
+    scalerBands->run(BASE_FRAME_H, [&](unsigned int firstRow, unsigned int rowCount) {
+        frameScaler->scaleRows(frame.getBuffer(), output, firstRow, rowCount);
+    });
+}
 
-	xbrParams1.data = &xbrData;
-	xbrParams1.inHeight = BASE_FRAME_H;
-	xbrParams1.inWidth = BASE_FRAME_W;
-	xbrParams1.input = (uint8_t*)frame1.getBuffer();
-	xbrParams1.inPitch = BASE_FRAME_W * sizeof(uint32_t);
-	xbrParams1.output = (uint8_t*)extendedBuffer1;
-	xbrParams1.outPitch = BASE_FRAME_W * 4 * sizeof(uint32_t);
+// Only called for a frame being finished, when neither the scaler thread nor the renderer can be using its buffer
+void FrameManager::fitExtendedBuffer(uint32_t*& buffer, unsigned int& bufferScale) const {
+    const unsigned int scale = frameScaler->getScaleFactor();
+    if (bufferScale != scale) {
+        delete[] buffer;
+        buffer = new uint32_t[BASE_FRAME_W * BASE_FRAME_H * scale * scale];
+        bufferScale = scale;
+    }
+}
 
-	xbrParams2.data = &xbrData;
-	xbrParams2.inHeight = BASE_FRAME_H;
-	xbrParams2.inWidth = BASE_FRAME_W;
-	xbrParams2.input = (uint8_t*)frame2.getBuffer();
-	xbrParams2.inPitch = BASE_FRAME_W * sizeof(uint32_t);
-	xbrParams2.output = (uint8_t*)extendedBuffer2;
-	xbrParams2.outPitch = BASE_FRAME_W * FRAME_SCALE_FACTOR * sizeof(uint32_t);
+// Applies to frames begun from now on
+void FrameManager::setPixelFormat(PixelFormat format) {
+    pixelFormat = format;
+    requestFullFrame();
 }
 
-FrameManager::~FrameManager() = default;
+// Frames left undrawn after each one drawn, or AUTO_FRAME_SKIP
+void FrameManager::setFrameSkip(int frames) {
+    frameSkip = frames;
+    framesSkipped = 0;
+}
+
+// While running faster than real time, frames are skipped automatically whatever the setting
+void FrameManager::setFastForwarding(bool fastForward) {
+    fastForwarding = fastForward;
+}
+
+// Whether the frame about to start should go undrawn - not begun, so that no lines are drawn into it and it's never
+// upscaled. Called once at the start of each frame, before beginNewFrame.
+bool FrameManager::skipNextFrame() {
+    if (fastForwarding || frameSkip == AUTO_FRAME_SKIP) {
+        return frame1.isBeingScaled() || frame1.isBeingRendered() || frame2.isBeingScaled() || frame2.isBeingRendered();
+    }
+    if (framesSkipped < frameSkip) {
+        framesSkipped++;
+        return true;
+    }
+    framesSkipped = 0;
+    return false;
+}
 
 bool FrameManager::frameIsInProgress() const {
     return frame1.isBeingDrawn() || frame2.isBeingDrawn();
 }
 
+Frame* FrameManager::getInProgressFrame() {
+    if (frame1.isBeingDrawn()) {
+        return &frame1;
+    } else if(frame2.isBeingDrawn()) {
+        return &frame2;
+    } else {
+        return nullptr;
+    }
+}
+
 uint32_t* FrameManager::getInProgressFrameBuffer() const {
     if (frame1.isBeingDrawn()) {
         return frame1.getBuffer();
@@ -56,48 +107,144 @@ uint32_t* FrameManager::getInProgressFrameBuffer() const {
 uint32_t* FrameManager::beginNewFrame() {
     if ((nextFrameToBegin == 1) && frame1.isAvailable()) {
         nextFrameToBegin = 2;
-        return frame1.getForDrawing();
+        return frame1.getForDrawing(pixelFormat);
     } else if ((nextFrameToBegin == 2) && frame2.isAvailable()) {
         nextFrameToBegin = 1;
-        return frame2.getForDrawing();
+        return frame2.getForDrawing(pixelFormat);
     } else {
         return nullptr;
     }
 }
 
+// A frame no different from the last one finished is neither converted nor upscaled. Its upscaled buffer still holds
+// whatever it did before, so it's marked for the renderer to keep showing what it already has.
+bool FrameManager::elideIfUnchanged(Frame& frame) {
+    framesFinished++;
+    const bool fullFrame = fullFrameRequested.exchange(false);
+    const bool unchanged = !fullFrame && memcmp(frame.getLineHashes(), lastLineHashes, sizeof(lastLineHashes)) == 0;
+    frame.setUnchanged(unchanged);
+    if (unchanged) {
+        framesElided++;
+    } else {
+        memcpy(lastLineHashes, frame.getLineHashes(), sizeof(lastLineHashes));
+    }
+    return unchanged;
+}
+
+// Only checks whether the frame is unchanged before handing it to the scaler thread, which does the rest
 int FrameManager::finishCurrentFrame() {
     if (frame1.isBeingDrawn()) {
-		xbr_filter_xbr4x(&xbrParams1);
-        if (!frame1.markForRendering()) {
+        (void)elideIfUnchanged(frame1);
+        fitExtendedBuffer(extendedBuffer1, extendedScale1);
+        if (!frame1.markForScaling()) {
             return 0;
         }
+        scaler.queue(frame1);
         return 1;
     } else if (frame2.isBeingDrawn()) {
-		xbr_filter_xbr4x(&xbrParams2);
-        if (!frame2.markForRendering()) {
+        (void)elideIfUnchanged(frame2);
+        fitExtendedBuffer(extendedBuffer2, extendedScale2);
+        if (!frame2.markForScaling()) {
             return 0;
         }
+        scaler.queue(frame2);
         return 2;
     } else {
         return 0;
     }
 }
 
+// Runs on the scaler thread
+void FrameManager::scaleFrame(Frame& frame) {
+    if (!frame.isUnchanged()) {
+        if (frame.getFormat() == PixelFormat::INDEXED) {
+            frame.convertToRgba();
+        }
+        upscale(frame, &frame == &frame1 ? extendedBuffer1 : extendedBuffer2);
+    }
+    (void)frame.markForRendering();
+}
+
+void FrameManager::waitForScaling() {
+    scaler.waitUntilIdle();
+}
+
+// Threads to upscale each frame with, including the scaler thread itself. Called from the thread finishing frames, as
+// the pool can only be swapped while there are none left to scale.
+void FrameManager::setScalerThreads(unsigned int threads) {
+    threads = std::max(threads, 1U);
+    if (threads != scalerBands->getThreadCount()) {
+        scaler.waitUntilIdle();
+        scalerBands = std::make_unique<BandPool>(threads);
+    }
+}
+
+// Applies to frames finished from now on, so frames already finished may still come out at the old size. Called from
+// the thread finishing frames, like setScalerThreads. The next frame is scaled in full, as whatever is on display from
+// before can't be kept in a different size.
+void FrameManager::setScaler(ScalerType type) {
+    if (type != scalerType) {
+        scaler.waitUntilIdle();
+        frameScaler = FrameScaler::make(type);
+        scalerType = type;
+        requestFullFrame();
+    }
+}
+
+// The factor a renderable frame was scaled up by, which gives the size of its buffer, or zero for any other buffer
+unsigned int FrameManager::getFrameScale(const uint32_t* frameBuffer) const {
+    if (frame1.isBeingRendered() && frameBuffer == extendedBuffer1) {
+        return extendedScale1;
+    } else if (frame2.isBeingRendered() && frameBuffer == extendedBuffer2) {
+        return extendedScale2;
+    }
+    return 0;
+}
+
+// Frames are begun alternately, so they're rendered alternately too, which keeps them in order when both are ready
 uint32_t* FrameManager::getRenderableFrameBuffer() {
-    if (frame1.isBeingRendered()) {
+    if (nextFrameToRender == 1 && frame1.isBeingRendered()) {
         return extendedBuffer1;
-    } else if (frame2.isBeingRendered()) {
+    } else if (nextFrameToRender == 2 && frame2.isBeingRendered()) {
         return extendedBuffer2;
     } else {
         return nullptr;
     }
 }
 
+// Buffers are only compared once their frames are known to be the renderer's, as the others may be being reallocated
+bool FrameManager::isUnchanged(const uint32_t* frameBuffer) const {
+    if (frame1.isBeingRendered() && frameBuffer == extendedBuffer1) {
+        return frame1.isUnchanged();
+    } else if (frame2.isBeingRendered() && frameBuffer == extendedBuffer2) {
+        return frame2.isUnchanged();
+    }
+    return false;
+}
+
+// The frame as drawn, before upscaling; like the upscaled buffer, only valid until the frame is freed
+const uint32_t* FrameManager::getSourceFrameBuffer(const uint32_t* frameBuffer) const {
+    if (frame1.isBeingRendered() && frameBuffer == extendedBuffer1) {
+        return frame1.getBuffer();
+    } else if (frame2.isBeingRendered() && frameBuffer == extendedBuffer2) {
+        return frame2.getBuffer();
+    }
+    return nullptr;
+}
+
+// The next frame finished is drawn in full, for when what's on display can no longer be relied on. Safe from any
+// thread, so the renderer can ask for one when it loses what it was showing.
+void FrameManager::requestFullFrame() {
+    fullFrameRequested = true;
+}
+
 bool FrameManager::freeFrame(const uint32_t* frameBuffer) {
-    if (frameBuffer == extendedBuffer1) {
-        return frame1.markAvailable();
-    } else if (frameBuffer == extendedBuffer2) {
-        return frame2.markAvailable();
+    if (frame1.isBeingRendered() && frameBuffer == extendedBuffer1 && frame1.markAvailable()) {
+        nextFrameToRender = 2;
+        return true;
+    } else if (frame2.isBeingRendered() && frameBuffer == extendedBuffer2 && frame2.markAvailable()) {
+        nextFrameToRender = 1;
+        return true;
     }
     return false;
 }
@@ -1,18 +1,82 @@
 #pragma once
 
 #include "frame.h"
+#include "bandpool.h"
+#include "framescaler.h"
+#include "scalerthread.h"
+
+#include <atomic>
+#include <memory>
 
 class FrameManager {
     Frame frame1;
     Frame frame2;
+
+    // Upscaled buffers, and the scale factors they were last made for, each sized for the scaler in use as its frame
+    // is finished
+    uint32_t* extendedBuffer1;
+    uint32_t* extendedBuffer2;
+    unsigned int extendedScale1;
+    unsigned int extendedScale2;
+    void fitExtendedBuffer(uint32_t*& buffer, unsigned int& bufferScale) const;
     int nextFrameToBegin;
+    int nextFrameToRender;
+    PixelFormat pixelFormat;
+    int frameSkip;
+    int framesSkipped;
+    bool fastForwarding;
+
+    // Line hashes of the last frame finished that wasn't found unchanged, and how many frames were. Only the emulation
+    // thread, which finishes frames, touches these. Any thread can ask for the next frame finished to be drawn in full
+    // whatever its hashes, which the emulation thread takes up as it finishes that frame.
+    uint64_t lastLineHashes[BASE_FRAME_H]{};
+    std::atomic<bool> fullFrameRequested;
+    uint64_t framesFinished;
+    uint64_t framesElided;
+    bool elideIfUnchanged(Frame& frame);
+    void upscale(const Frame& frame, uint32_t* output) const;
+
+    // Finished frames are converted and upscaled on the scaler's thread, which shares the rows of each out between
+    // the band pool's threads and itself
+    void scaleFrame(Frame& frame);
+    ScalerType scalerType;
+    std::unique_ptr<FrameScaler> frameScaler;
+    std::unique_ptr<BandPool> scalerBands;
+    ScalerThread scaler;
 public:
+    // Skip frames for as long as a finished one is still waiting for the scaler or the renderer, rather than a fixed
+    // number
+    static constexpr int AUTO_FRAME_SKIP = -1;
+
     FrameManager();
     ~FrameManager();
+    void setPixelFormat(PixelFormat format);
+    void setFrameSkip(int frames);
+    void setFastForwarding(bool fastForward);
+    [[nodiscard]] bool skipNextFrame();
     [[nodiscard]] bool frameIsInProgress() const;
+    [[nodiscard]] Frame* getInProgressFrame();
     [[nodiscard]] uint32_t* getInProgressFrameBuffer() const;
     uint32_t* beginNewFrame();
     [[nodiscard]] int finishCurrentFrame();
     uint32_t* getRenderableFrameBuffer();
     [[nodiscard]] bool freeFrame(const uint32_t* frameBuffer);
+    [[nodiscard]] bool isUnchanged(const uint32_t* frameBuffer) const;
+    [[nodiscard]] const uint32_t* getSourceFrameBuffer(const uint32_t* frameBuffer) const;
+    void requestFullFrame();
+    [[nodiscard]] inline uint64_t getFinishedFrameCount() const { return framesFinished; }
+    [[nodiscard]] inline uint64_t getElidedFrameCount() const { return framesElided; }
+
+    // Scaling happens off the emulation thread; a finished frame is only renderable once it's done. Latencies are
+    // from a frame being finished to it being renderable.
+    void waitForScaling();
+    void setScalerThreads(unsigned int threads);
+    void setScaler(ScalerType type);
+    [[nodiscard]] inline ScalerType getScaler() const { return scalerType; }
+    [[nodiscard]] unsigned int getFrameScale(const uint32_t* frameBuffer) const;
+    [[nodiscard]] inline unsigned int getScalerThreads() const { return scalerBands->getThreadCount(); }
+    [[nodiscard]] inline uint64_t getScaledFrameCount() const { return scaler.getScaledFrameCount(); }
+    [[nodiscard]] inline uint64_t getLastScaleLatencyMicros() const { return scaler.getLastLatencyMicros(); }
+    [[nodiscard]] inline uint64_t getMaxScaleLatencyMicros() const { return scaler.getMaxLatencyMicros(); }
+    [[nodiscard]] inline uint64_t getAverageScaleLatencyMicros() const { return scaler.getAverageLatencyMicros(); }
 };
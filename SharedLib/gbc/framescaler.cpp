@@ -0,0 +1,171 @@
+#include "framescaler.h"
+#include "frame.h"
+
+#include <filters.h>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    // The RGB to YUV table xBR works from is the same for every instance and never changes once built, so it's built
+    // once, by whichever instance gets there first, and shared
+    const xbr_data* sharedXbrData() {
+        static const std::unique_ptr<xbr_data> data = [] {
+            auto built = std::make_unique<xbr_data>();
+            xbr_init_data(built.get());
+            return built;
+        }();
+        return data.get();
+    }
+
+    // Copies the frame as it is, leaving any scaling to the renderer
+    class PassthroughScaler : public FrameScaler {
+    public:
+        [[nodiscard]] unsigned int getScaleFactor() const override { return 1; }
+
+        void scaleRows(const uint32_t* input, uint32_t* output, unsigned int firstRow,
+                       unsigned int rowCount) const override {
+            memcpy(&output[firstRow * BASE_FRAME_W], &input[firstRow * BASE_FRAME_W],
+                   rowCount * BASE_FRAME_W * sizeof(uint32_t));
+        }
+    };
+
+    // Each pixel becomes a square block of itself
+    class NearestScaler : public FrameScaler {
+        const unsigned int factor;
+    public:
+        explicit NearestScaler(unsigned int factor) : factor(factor) {}
+        [[nodiscard]] unsigned int getScaleFactor() const override { return factor; }
+
+        // Each row is widened once, then copied down the rest of its block
+        void scaleRows(const uint32_t* input, uint32_t* output, unsigned int firstRow,
+                       unsigned int rowCount) const override {
+            const size_t outWidth = BASE_FRAME_W * factor;
+            for (unsigned int y = firstRow; y < firstRow + rowCount; y++) {
+                const uint32_t* src = &input[y * BASE_FRAME_W];
+                uint32_t* dst = &output[y * factor * outWidth];
+                for (size_t x = 0; x < BASE_FRAME_W; x++) {
+                    std::fill(dst + x * factor, dst + (x + 1) * factor, src[x]);
+                }
+                for (unsigned int copy = 1; copy < factor; copy++) {
+                    memcpy(dst + copy * outWidth, dst, outWidth * sizeof(uint32_t));
+                }
+            }
+        }
+    };
+
+    // Scale2x, also known as EPX: each corner of a pixel's block takes the colour of the two neighbours it's between
+    // if they match each other but not the other two, which rounds off diagonal edges without blending any colours.
+    // Neighbours beyond the edges are the edge pixels themselves.
+    class Scale2xScaler : public FrameScaler {
+    public:
+        [[nodiscard]] unsigned int getScaleFactor() const override { return 2; }
+
+        void scaleRows(const uint32_t* input, uint32_t* output, unsigned int firstRow,
+                       unsigned int rowCount) const override {
+            const size_t outWidth = BASE_FRAME_W * 2;
+            for (unsigned int y = firstRow; y < firstRow + rowCount; y++) {
+                const uint32_t* above = &input[(y > 0 ? y - 1 : y) * BASE_FRAME_W];
+                const uint32_t* row = &input[y * BASE_FRAME_W];
+                const uint32_t* below = &input[(y < BASE_FRAME_H - 1 ? y + 1 : y) * BASE_FRAME_W];
+                uint32_t* topDst = &output[y * 2 * outWidth];
+                uint32_t* bottomDst = topDst + outWidth;
+                for (size_t x = 0; x < BASE_FRAME_W; x++) {
+                    const uint32_t e = row[x];
+                    const uint32_t b = above[x];
+                    const uint32_t h = below[x];
+                    const uint32_t d = row[x > 0 ? x - 1 : x];
+                    const uint32_t f = row[x < BASE_FRAME_W - 1 ? x + 1 : x];
+                    if (b != h && d != f) {
+                        topDst[x * 2] = d == b ? d : e;
+                        topDst[x * 2 + 1] = b == f ? f : e;
+                        bottomDst[x * 2] = d == h ? d : e;
+                        bottomDst[x * 2 + 1] = h == f ? f : e;
+                    } else {
+                        topDst[x * 2] = e;
+                        topDst[x * 2 + 1] = e;
+                        bottomDst[x * 2] = e;
+                        bottomDst[x * 2 + 1] = e;
+                    }
+                }
+            }
+        }
+    };
+
+    // The 4x filter has a version working on several pixels at once, which is used where the platform has one
+    class XbrScaler : public FrameScaler {
+        using RowsFilter = void (*)(const xbr_params*, int, int);
+
+        const unsigned int factor;
+        const RowsFilter rowsFilter;
+        const xbr_data* data;
+    public:
+        explicit XbrScaler(unsigned int factor) :
+            factor(factor),
+            rowsFilter(factor == 2 ? xbr_filter_xbr2x_rows
+                       : factor == 3 ? xbr_filter_xbr3x_rows
+                       : xbr_filter_xbr4x_simd_rows),
+            data(sharedXbrData()) {}
+        [[nodiscard]] unsigned int getScaleFactor() const override { return factor; }
+
+        void scaleRows(const uint32_t* input, uint32_t* output, unsigned int firstRow,
+                       unsigned int rowCount) const override {
+            xbr_params params;
+            params.data = data;
+            params.inHeight = BASE_FRAME_H;
+            params.inWidth = BASE_FRAME_W;
+            params.input = (const uint8_t*)input;
+            params.inPitch = BASE_FRAME_W * sizeof(uint32_t);
+            params.output = (uint8_t*)output;
+            params.outPitch = (int)(BASE_FRAME_W * factor * sizeof(uint32_t));
+            rowsFilter(&params, (int)firstRow, (int)rowCount);
+        }
+    };
+
+    constexpr const char* TYPE_NAMES[SCALER_TYPE_COUNT] = {
+        "none",
+        "nearest2x",
+        "nearest3x",
+        "nearest4x",
+        "scale2x",
+        "xbr2x",
+        "xbr3x",
+        "xbr4x"
+    };
+}
+
+std::unique_ptr<FrameScaler> FrameScaler::make(ScalerType type) {
+    switch (type) {
+        case ScalerType::PASSTHROUGH:
+            return std::make_unique<PassthroughScaler>();
+        case ScalerType::NEAREST_2X:
+            return std::make_unique<NearestScaler>(2);
+        case ScalerType::NEAREST_3X:
+            return std::make_unique<NearestScaler>(3);
+        case ScalerType::NEAREST_4X:
+            return std::make_unique<NearestScaler>(4);
+        case ScalerType::SCALE2X:
+            return std::make_unique<Scale2xScaler>();
+        case ScalerType::XBR_2X:
+            return std::make_unique<XbrScaler>(2);
+        case ScalerType::XBR_3X:
+            return std::make_unique<XbrScaler>(3);
+        case ScalerType::XBR_4X:
+        default:
+            return std::make_unique<XbrScaler>(4);
+    }
+}
+
+const char* FrameScaler::getTypeName(ScalerType type) {
+    const auto index = (unsigned int)type;
+    return index < SCALER_TYPE_COUNT ? TYPE_NAMES[index] : "";
+}
+
+bool FrameScaler::findType(const std::string& name, ScalerType& type) {
+    for (unsigned int index = 0; index < SCALER_TYPE_COUNT; index++) {
+        if (name == TYPE_NAMES[index]) {
+            type = (ScalerType)index;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// The ways a finished frame can be scaled up for the renderer, from cheapest to dearest within each kind
+enum class ScalerType {
+    PASSTHROUGH,
+    NEAREST_2X,
+    NEAREST_3X,
+    NEAREST_4X,
+    SCALE2X,
+    XBR_2X,
+    XBR_3X,
+    XBR_4X
+};
+
+constexpr unsigned int SCALER_TYPE_COUNT = 8;
+constexpr ScalerType DEFAULT_SCALER = ScalerType::XBR_4X;
+
+// Scales frames of BASE_FRAME_W by BASE_FRAME_H pixels up by a whole number factor. Any band of the input's rows can
+// be scaled on its own, to output rows scale factor times as many, so bands can be shared out between threads; rows
+// either side of a band may be read, but only its own output rows are written.
+class FrameScaler {
+public:
+    virtual ~FrameScaler() = default;
+    [[nodiscard]] virtual unsigned int getScaleFactor() const = 0;
+    virtual void scaleRows(const uint32_t* input, uint32_t* output, unsigned int firstRow,
+                           unsigned int rowCount) const = 0;
+
+    [[nodiscard]] static std::unique_ptr<FrameScaler> make(ScalerType type);
+
+    // Short names for choosing a scaler by, such as "nearest2x"
+    [[nodiscard]] static const char* getTypeName(ScalerType type);
+    [[nodiscard]] static bool findType(const std::string& name, ScalerType& type);
+};
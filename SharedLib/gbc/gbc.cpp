@@ -1,6 +1,7 @@
 #include "gbc.h"
 
 #include "colourutils.h"
+#include "cpuops.h"
 
 #include <algorithm>
 #include <stdexcept>
@@ -13,23 +14,14 @@
 extern DebugWindowModule debugger;
 #endif
 
-uint32_t stockPaletteBg[4] = { 0xffffffffU, 0xff88b0b0U, 0xff507878U, 0xff000000U };
-uint32_t stockPaletteObj1[4] = { 0xffffffffU, 0xff5050f0U, 0xff2020a0U, 0xff000000U };
-uint32_t stockPaletteObj2[4] = { 0xffffffffU, 0xffa0a0a0U, 0xff404040U, 0xff000000U };
-
-// Values set while draw across a row - zero allows sprite to be drawn if OBJ priority is set, non-zero will
-// possibly block sprites being drawn (depends on several factors, e.g. OBJ priority attribute as well as
-// BG priority attribute in VRAM bank 1 for CGB mode)
-uint32_t bgColorNumbers[160];
-uint32_t bgDisplayPriorities[160];
+constexpr uint32_t stockPaletteBg[4] = { 0xffffffffU, 0xff88b0b0U, 0xff507878U, 0xff000000U };
+constexpr uint32_t stockPaletteObj1[4] = { 0xffffffffU, 0xff5050f0U, 0xff2020a0U, 0xff000000U };
+constexpr uint32_t stockPaletteObj2[4] = { 0xffffffffU, 0xffa0a0a0U, 0xff404040U, 0xff000000U };
 
 constexpr int MULTIPLIER_ARRAY_SIZE = 21;
 constexpr int CLOCK_MULTIPLIERS[MULTIPLIER_ARRAY_SIZE] = { 1,  1,  1, 1, 1,  2, 1, 4, 2, 4,  1,  5, 3, 7, 2, 5,  3, 5, 8, 12, 20 };
 constexpr int CLOCK_DIVISORS[MULTIPLIER_ARRAY_SIZE] =    { 20, 12, 8, 5, 3,  5, 2, 7, 3, 5,  1,  4, 2, 4, 1, 2,  1, 1, 1, 1,  1  };
-
-#define CPU_RUNNING   0x00U
-#define CPU_HALTED    0x01U
-#define CPU_STOPPED   0x02U
+constexpr int NORMAL_SPEED_COMBO = 10;
 
 #define GPU_HBLANK    0x00U
 #define GPU_VBLANK    0x01U
@@ -50,16 +42,17 @@ Gbc::Gbc() {
 
     // Initialise vars, many will be overwritten when reset() is called
     cpuPc = cpuSp = 0;
-    cpuA = cpuB = cpuC = cpuD = cpuE = cpuF = cpuH = cpuL = 0;
+    cpuA = cpuBC.high = cpuBC.low = cpuDE.high = cpuDE.low = cpuF = cpuHL.high = cpuHL.low = 0;
     clocksAcc = 0;
     cpuClockFreq = 1;
     cpuDividerCount = 1;
-    gpuClockFactor = 1;
+    cpuClockShift = 1;
     gpuTimeInMode = 0;
     blankedScreen = false;
     needClear = true;
     cpuMode = CPU_RUNNING;
     gpuMode = GPU_VBLANK;
+    dueEventsRunner = &Gbc::runDueEventsFor<HardwareModel::DMG>;
 
     // Flag not running and no ROM loaded
     isRunning = false;
@@ -67,14 +60,13 @@ Gbc::Gbc() {
     romProperties.valid = false;
     clockMultiply = 1;
     clockDivide = 1;
-    currentClockMultiplierCombo = 10;
+    currentClockMultiplierCombo = NORMAL_SPEED_COMBO;
 
     // Allocate emulated RAM
-    rom.resize(256 * 16384);
     wram.resize(8 * 4096);
     vram.resize(2 * 8192);
     ioPorts.resize(256);
-    tileSet = new uint32_t[2 * 384 * 8 * 8]; // 2 VRAM banks, 384 tiles, 8 rows, 8 pixels per row
+    tileCache.attach(vram.data());
     sgb.monoData = new uint32_t[160 * 152];
     sgb.mappedVramForTrnOp = new uint8_t[4096];
     sgb.palettes = new uint32_t[4 * 4];
@@ -86,7 +78,6 @@ Gbc::Gbc() {
 
 Gbc::~Gbc() {
     // Release emulated RAM
-    delete[] tileSet;
     delete[] sgb.monoData;
     delete[] sgb.mappedVramForTrnOp;
     delete[] sgb.palettes;
@@ -105,33 +96,48 @@ int Gbc::runInvalidInstruction(uint8_t instruction) {
 
 void Gbc::doWork(uint64_t timeDiffMillis, InputSet& inputs) {
     if (isRunning && !isPaused) {
-        // Determine how many clock cycles to emulate, cap at 1000000 (about a quarter of a second)
+        // Determine how many clock cycles to emulate, capping those saved up at 1000000 (about a quarter of a second)
         const int64_t adjustedFrequency = cpuClockFreq * clockMultiply / clockDivide;
-        clocksAcc += (int)((double)timeDiffMillis * 0.001 * (double)adjustedFrequency);
+        auto clocks = (int32_t)((double)timeDiffMillis * 0.001 * (double)adjustedFrequency);
         auto approxMultiplier = (const int32_t)(clockMultiply / clockDivide + 1);
-        if (clocksAcc > (1000000 * approxMultiplier)) {
-            clocksAcc = 1000000 * approxMultiplier;
-        }
+        clocks = std::min(clocks, 1000000 * approxMultiplier - clocksAcc);
 
         // Copy inputs
         keys.keyDir = inputs.keyDir;
         keys.keyBut = inputs.keyBut;
 
-        if (clocksAcc < 2000) {
+        // Save up short intervals until there's enough to be worth a run
+        if (clocksAcc + clocks < 2000) {
+            clocksAcc += clocks;
             return;
         }
+        (void)runCycles(clocks);
+    }
+}
 
-        // Execute this many clock cycles and catch errors
-        //try
-        //{
-        executeAccumulatedClocks();
-        //}
-        //catch (const std::runtime_error& err)
-        //{
-        //	accumulatedClocks = 0;
-        //	std::cerr << err.what() << std::endl;
-        //}
+// Runs for the given number of CPU clocks, on top of any left over from or overrun by the last run. The last
+// instruction can take the run a few clocks past the end; that many fewer are run next time.
+Gbc::RunResult Gbc::runCycles(int32_t clocks) {
+    if (!isRunning) {
+        return { 0, false };
     }
+    clocksAcc += clocks;
+    const int32_t clocksAtStart = clocksAcc;
+    frameCompleted = false;
+    clocksHeldBack = 0;
+    executeAccumulatedClocks();
+    return { (int64_t)clocksAtStart - clocksHeldBack - clocksAcc, frameCompleted };
+}
+
+// Runs until the end of the instruction during which the next VBlank begins. With the LCD off there is none; the run
+// stops after as long as a frame would have taken instead. Clocks left over from the last run aren't carried into
+// the next, so that every call ends at a VBlank whatever came before.
+Gbc::RunResult Gbc::runFrame() {
+    stopAtVBlank = true;
+    const RunResult result = runCycles((int32_t)toCpuClocks(FRAME_DOTS << DOT_SHIFT));
+    stopAtVBlank = false;
+    clocksAcc = std::min(clocksAcc, 0);
+    return result;
 }
 
 bool Gbc::loadRom(std::string fileName, const uint8_t* data, int dataLength, AppPlatform& appPlatform) {
@@ -139,6 +145,17 @@ bool Gbc::loadRom(std::string fileName, const uint8_t* data, int dataLength, App
         romProperties.valid = false;
         return false;
     }
+    return loadRom(std::move(fileName), RomImage::copyOf(data, (size_t)dataLength), appPlatform);
+}
+
+// The image is kept rather than copied, so instances loading the same one share it
+bool Gbc::loadRom(std::string fileName, const RomImage& image, AppPlatform& appPlatform) {
+    const uint8_t* data = image.data();
+    const size_t dataLength = image.size();
+    if (dataLength < 32768) {
+        romProperties.valid = false;
+        return false;
+    }
 
     // Read ROM header. Starts at 0x0100 with NOP and a jump (usually to 0x0150, after the header) (total 4 bytes)
     // Logo at 0x0104 (48 bytes)
@@ -372,15 +389,12 @@ bool Gbc::loadRom(std::string fileName, const uint8_t* data, int dataLength, App
     }
 
     // Bytes 0x4e and 0x4f are a global checksum (all bytes in ROM except these two). Is never checked.
-    // Load ROM data into memory.
-    if (romProperties.sizeBytes > dataLength) {
+    // Every bank the header says the ROM has must be there, as bank switching is only masked to that many.
+    if ((size_t)romProperties.sizeBytes > dataLength) {
         romProperties.valid = false;
         return false;
     }
-    if (dataLength > 4194304) {
-        dataLength = 4194304;
-    }
-    memcpy(rom.data(), data, dataLength);
+    rom = image;
 
     // Remember this file to re-open next time
     //saveLastFileName(FileName, 512);
@@ -402,12 +416,15 @@ void Gbc::reset() {
     }
 
     // Reset clock multipliers
-    currentClockMultiplierCombo = 10;
+    currentClockMultiplierCombo = NORMAL_SPEED_COMBO;
     clockMultiply = 1;
     clockDivide = 1;
+    frameManager.setFastForwarding(false);
+    frameManager.requestFullFrame();
 
     // Initialise control variables
     cpuIme = false;
+    lazyFlags.clear();
     cpuMode = CPU_RUNNING;
     gpuMode = GPU_SCAN_OAM;
     gpuTimeInMode = 0;
@@ -424,11 +441,14 @@ void Gbc::reset() {
 #endif
 
     // Clear graphic caches
-    std::fill(tileSet, tileSet + 2 * 384 * 8 * 8, 0);
+    tileCache.invalidateAll();
     std::fill(sgb.monoData, sgb.monoData + 160 * 152, 0);
     std::fill(sgb.palettes, sgb.palettes + 4 * 4, 0);
     std::fill(sgb.sysPalettes, sgb.sysPalettes + 512 * 4, 0);
     std::fill(sgb.chrPalettes, sgb.chrPalettes + 18 * 20, 0);
+    blockCache.clear();
+    recompiler.clear();
+    idleLoops.clear();
 
     // Resetting IO ports may avoid graphical glitches when switching to a colour game. Clearing VRAM may help too.
     std::fill(ioPorts.data(), ioPorts.data() + 256, 0);
@@ -438,15 +458,16 @@ void Gbc::reset() {
     bankOffset = 0x4000;
     wramBankOffset = 0x1000;
     vramBankOffset = 0x0000;
+    mapMemory();
     cpuPc = 0x0100;
     cpuSp = 0xfffe;
     cpuF = 0xb0;
-    cpuB = 0x00;
-    cpuC = 0x13;
-    cpuD = 0x00;
-    cpuE = 0xd8;
-    cpuH = 0x01U;
-    cpuL = 0x4d;
+    cpuBC.high = 0x00;
+    cpuBC.low = 0x13;
+    cpuDE.high = 0x00;
+    cpuDE.low = 0xd8;
+    cpuHL.high = 0x01U;
+    cpuHL.low = 0x4d;
     ioPorts[5] = 0x00;
     ioPorts[6] = 0x00;
     ioPorts[7] = 0x00;
@@ -483,8 +504,9 @@ void Gbc::reset() {
     if (romProperties.cgbFlag) {
         romProperties.sgbFlag = false;
         cpuClockFreq = GB_FREQ;
-        gpuClockFactor = 1;
-        readLine = &Gbc::readLineCgb;
+        cpuClockShift = 1;
+        hardwareModel = HardwareModel::CGB;
+        dueEventsRunner = &Gbc::runDueEventsFor<HardwareModel::CGB>;
         cpuA = 0x11;
         ioPorts[38] = 0xf1;
         sgb.freezeScreen = false;
@@ -492,8 +514,9 @@ void Gbc::reset() {
     } else if (romProperties.sgbFlag) {
         romProperties.cgbFlag = false;
         cpuClockFreq = SGB_FREQ;
-        gpuClockFactor = 1;
-        readLine = &Gbc::readLineSgb;
+        cpuClockShift = 1;
+        hardwareModel = HardwareModel::SGB;
+        dueEventsRunner = &Gbc::runDueEventsFor<HardwareModel::SGB>;
         cpuA = 0x01U;
         ioPorts[38] = 0xf0;
         sgb.readingCommand = false;
@@ -508,13 +531,15 @@ void Gbc::reset() {
         romProperties.sgbFlag = false;
         romProperties.cgbFlag = false;
         cpuClockFreq = GB_FREQ;
-        gpuClockFactor = 1;
-        readLine = &Gbc::readLineGb;
+        cpuClockShift = 1;
+        hardwareModel = HardwareModel::DMG;
+        dueEventsRunner = &Gbc::runDueEventsFor<HardwareModel::DMG>;
         cpuA = 0x01U;
         ioPorts[38] = 0xf1;
         sgb.freezeScreen = false;
         sgb.multEnabled = false;
     }
+    applyPixelFormat();
 
     // Other stuff:
     audioUnit.reset(ioPorts.data(), cpuClockFreq);
@@ -529,6 +554,7 @@ void Gbc::reset() {
     sram.timerLatch = 0x00;
     lastLYCompare = 1; // Will prevent LYC causing interrupts immediately
     blankedScreen = false;
+    restartScheduler();
 
     isRunning = true;
     isPaused = false;
@@ -553,278 +579,540 @@ void Gbc::executeAccumulatedClocks() {
         ioPorts[0x0f] |= 0x10U;
         keyStateChanged = false;
     }
+    idleLoops.disarm();
+
+    // Runs only pay for breakpoint checks while the debug window has some set, or is paused. Read and write
+    // breakpoints work by taking the watched pages out of the page table, so it's rebuilt whenever they might
+    // have changed.
+#ifdef _WIN32
+    const bool debugging = debugger.totalBreakEnables > 0 || debugger.breakCodeIsSet();
+    if (debugging || debuggingRun) {
+        debuggingRun = debugging;
+        mapMemory();
+    }
+    if (debugging) {
+        runAccumulatedClocks<true>();
+    } else {
+        runAccumulatedClocks<false>();
+    }
+#else
+    runAccumulatedClocks<false>();
+#endif
+
+    // Leave registers up to date for anything looking in from outside
+    syncSubsystems();
+}
+
+template <bool Debugging>
+void Gbc::runAccumulatedClocks() {
+    if constexpr (!Debugging) {
+        recompiler.beginRun(*this);
+    }
 
     while (clocksAcc > 0) {
 #ifdef _WIN32
-        if (debugger.breakCodeIsSet()) {
-            isPaused = true;
-            break;
+        if constexpr (Debugging) {
+            if (debugger.breakCodeIsSet()) {
+                isPaused = true;
+                break;
+            }
         }
 #endif
 
+        // A halted or stopped CPU skips ahead to the first point anything could wake it
+        if (cpuMode != CPU_RUNNING) {
+            completeInstruction(idleClocks());
+            continue;
+        }
+
+        // The recompiler runs a whole native block, or one interpreted instruction, completing each itself. It
+        // can't stop for breakpoints part-way through a block, so debugging runs leave it out.
+        if (!Debugging && recompiler.isEnabled()) {
+            recompiler.execute(*this);
+            continue;
+        }
+
         // Run appropriate opcode; returns how many clocks it consumes
+#ifdef GBC_USE_OPCODE_SWITCH
+        materialiseFlags(); // The switch reads and writes cpuF directly
         int clocksPassedByInstruction = performOp();
-        cpuPc &= 0xffffU; // Clamp PC to 16 bits
-        clocksAcc -= clocksPassedByInstruction;
-
-        // Check for interrupts:
-        const bool cpuHalted = cpuMode == CPU_HALTED;
-        if (cpuIme || cpuHalted) {
-            uint8_t triggeredInterrupts = ioPorts[0xff] & ioPorts[0x0f] & 0x1fU;
-            if (triggeredInterrupts) {
-                uint32_t toAddress = cpuPc;
-                if (triggeredInterrupts & 0x01U) {
-                    // VBlank
-                    ioPorts[0x0f] &= 0x1eU;
-                    toAddress = 0x0040;
-                } else if (triggeredInterrupts & 0x02U) {
-                    // LCD Stat
-                    ioPorts[0x0f] &= 0x1dU;
-                    toAddress = 0x0048;
-                } else if (triggeredInterrupts & 0x04U) {
-                    // Timer
-                    ioPorts[0x0f] &= 0x1bU;
-                    toAddress = 0x0050;
-                } else if (triggeredInterrupts & 0x08U) {
-                    // Serial
-                    ioPorts[0x0f] &= 0x17U;
-                    toAddress = 0x0058;
-                } else if (triggeredInterrupts & 0x10U) {
-                    // Joypad
-                    ioPorts[0x0f] &= 0x0fU;
-                    toAddress = 0x0060;
-                }
-
-                // Unless halted with IME unset, push PC onto stack and go to interrupt handler address
-                if (!cpuHalted || cpuIme) {
-                    cpuSp -= 2;
-                    write16(cpuSp, (uint8_t)(cpuPc & 0xffU), (uint8_t)(cpuPc >> 8U));
-                    cpuPc = toAddress;
-                }
-                cpuMode = CPU_RUNNING;
-                cpuIme = false;
-            }
-        }
+#else
+        int clocksPassedByInstruction = blockCache.isEnabled() ? blockCache.execute(*this) : CpuOps::dispatch(*this);
+#endif
+        completeInstruction(clocksPassedByInstruction);
 
 #ifdef _WIN32
-        if (debugger.breakOnPc) {
-            if (cpuPc == debugger.breakPcAddr) {
-                debugger.setBreakCode(DebugWindowModule::BreakCode::REACHED_ADDRESS);
+        if constexpr (Debugging) {
+            if (debugger.breakOnPc) {
+                if (cpuPc == debugger.breakPcAddr) {
+                    debugger.setBreakCode(DebugWindowModule::BreakCode::REACHED_ADDRESS);
+                }
             }
         }
 #endif
-        // While CPU is in stop mode, nothing much still runs
-        if (cpuMode == CPU_STOPPED) {
-            if (switchRunningSpeed()) {
-                clocksAcc -= 131072;
-                cpuMode = CPU_RUNNING;
+    }
+}
+
+// Everything that follows an instruction: interrupts, timers, audio, serial and the GPU
+void Gbc::completeInstruction(int clocksPassedByInstruction) {
+    executedInstructions++;
+    cpuPc &= 0xffffU; // Clamp PC to 16 bits
+    clocksAcc -= clocksPassedByInstruction;
+
+    // Check for interrupts:
+    const bool cpuHalted = cpuMode == CPU_HALTED;
+    if (cpuIme || cpuHalted) {
+        uint8_t triggeredInterrupts = ioPorts[0xff] & ioPorts[0x0f] & 0x1fU;
+        if (triggeredInterrupts) {
+            uint32_t toAddress = cpuPc;
+            if (triggeredInterrupts & 0x01U) {
+                // VBlank
+                ioPorts[0x0f] &= 0x1eU;
+                toAddress = 0x0040;
+            } else if (triggeredInterrupts & 0x02U) {
+                // LCD Stat
+                ioPorts[0x0f] &= 0x1dU;
+                toAddress = 0x0048;
+            } else if (triggeredInterrupts & 0x04U) {
+                // Timer
+                ioPorts[0x0f] &= 0x1bU;
+                toAddress = 0x0050;
+            } else if (triggeredInterrupts & 0x08U) {
+                // Serial
+                ioPorts[0x0f] &= 0x17U;
+                toAddress = 0x0058;
+            } else if (triggeredInterrupts & 0x10U) {
+                // Joypad
+                ioPorts[0x0f] &= 0x0fU;
+                toAddress = 0x0060;
+            }
+
+            // Unless halted with IME unset, push PC onto stack and go to interrupt handler address
+            if (!cpuHalted || cpuIme) {
+                cpuSp -= 2;
+                write16(cpuSp, (uint8_t)(cpuPc & 0xffU), (uint8_t)(cpuPc >> 8U));
+                cpuPc = toAddress;
             }
-            continue;
+            cpuMode = CPU_RUNNING;
+            cpuIme = false;
+            idleLoops.disarm();
+        }
+    }
+
+    // While CPU is in stop mode, nothing much still runs
+    if (cpuMode == CPU_STOPPED) {
+        if (switchRunningSpeed()) {
+            clocksAcc -= 131072;
+            cpuMode = CPU_RUNNING;
         }
+        return;
+    }
 
-        bool displayEnabled = ioPorts[0x0040] & 0x80U;
+    // Timers, audio, serial and the GPU only need attention once one of their deadlines has passed
+    cycleCounter += fromCpuClocks((uint64_t)clocksPassedByInstruction);
+    if (cycleCounter >= scheduler.getNextDeadline()) {
+        runDueEvents();
+    }
+}
 
-        // Permanent compare of LY and LYC
-        if ((ioPorts[0x44] == ioPorts[0x45]) && displayEnabled) {
-            ioPorts[0x41] |= 0x04U; // Set coincidence flag
-            // Request interrupt if this signal goes low to high
-            if (((ioPorts[0x41] & 0x40U) != 0x00) && (lastLYCompare == 0)) {
-                ioPorts[0x0f] |= 0x02U;
-            }
-            lastLYCompare = 1;
+// Clocks to let pass in one go while the CPU waits in HALT or STOP mode, in place of an instruction
+int Gbc::idleClocks() {
+    // Wake straight away from a halt for an interrupt that's already pending; they don't end stop mode
+    if ((cpuMode == CPU_HALTED && (ioPorts[0xff] & ioPorts[0x0f] & 0x1fU) != 0x00) || clocksAcc <= 4) {
+        return 4;
+    }
+
+    // Otherwise only a scheduled event can raise one. Nothing runs at all in stop mode, where a key press arriving
+    // with the next run is the only way out, so the rest of this run can go.
+    auto clocks = (uint64_t)clocksAcc;
+    if (cpuMode == CPU_HALTED && scheduler.getNextDeadline() > cycleCounter) {
+        const uint64_t untilDeadline = scheduler.getNextDeadline() - cycleCounter;
+        clocks = std::min(clocks, toCpuClocks(untilDeadline + fromCpuClocks(1) - 1));
+    }
+    return (int)((clocks + 3U) & ~(uint64_t)3U);
+}
+
+template <HardwareModel Model>
+void Gbc::runDueEventsFor() {
+    idleLoops.disarm();
+    EventScheduler::Event event;
+    while ((event = scheduler.takeDueEvent(cycleCounter)) != EventScheduler::EVENT_COUNT) {
+        switch (event) {
+            case EventScheduler::LY_COMPARE:
+                compareLy();
+                break;
+            case EventScheduler::TIMER_OVERFLOW:
+                overflowTimer();
+                break;
+            case EventScheduler::SERIAL:
+                completeSerialTransfer();
+                break;
+            case EventScheduler::VIDEO:
+                stepVideo<Model>();
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+// Rebuild every deadline from the current state, after a reset or loading a state
+void Gbc::restartScheduler() {
+    scheduler.clear();
+    dividerSyncedAt = timerSyncedAt = audioSyncedAt = serialSyncedAt = videoSyncedAt = cycleCounter;
+    scheduleTimer();
+    if (serialIsTransferring) {
+        if (serialClockIsExternal) {
+            scheduler.schedule(EventScheduler::SERIAL, cycleCounter + 1);
         } else {
-            ioPorts[0x41] &= 0xfbU; // Clear coincidence flag
-            lastLYCompare = 0;
+            scheduleSerial();
         }
+    }
+    scheduleVideo();
+    scheduler.schedule(EventScheduler::LY_COMPARE, cycleCounter + 1);
+}
+
+// Bring every lazily-updated register up to the current cycle, e.g. before the state is observed from outside
+void Gbc::syncSubsystems() {
+    syncDivider();
+    syncTimer();
+    syncAudio();
+    syncSerial();
+    syncVideo();
+}
 
-        // Handling of timers
-        cpuDividerCount += clocksPassedByInstruction;
-        if (cpuDividerCount >= 256) {
-            cpuDividerCount -= 256;
-            ioPorts[0x04]++;
+// Compare LY and LYC. Runs at the end of the instruction following any change to either, or to the LCD enable.
+void Gbc::compareLy() {
+    const bool displayEnabled = ioPorts[0x0040] & 0x80U;
+    if ((ioPorts[0x44] == ioPorts[0x45]) && displayEnabled) {
+        ioPorts[0x41] |= 0x04U; // Set coincidence flag
+        // Request interrupt if this signal goes low to high
+        if (((ioPorts[0x41] & 0x40U) != 0x00) && (lastLYCompare == 0)) {
+            ioPorts[0x0f] |= 0x02U;
         }
-        if (cpuTimerRunning != 0) {
-            cpuTimerCount++;
-            if (cpuTimerCount >= cpuTimerIncTime) {
-                cpuTimerCount -= cpuTimerIncTime;
-                ioPorts[0x05]++;
-                if (ioPorts[0x05] == 0x00) {
-                    ioPorts[0x05] = ioPorts[0x06];
-                    ioPorts[0x0f] |= 0x04U;
-                }
+        lastLYCompare = 1;
+    } else {
+        ioPorts[0x41] &= 0xfbU; // Clear coincidence flag
+        lastLYCompare = 0;
+    }
+}
+
+void Gbc::syncDivider() {
+    const uint64_t count = cpuDividerCount + toCpuClocks(cycleCounter - dividerSyncedAt);
+    ioPorts[0x04] += (uint8_t)(count >> 8U);
+    cpuDividerCount = (uint32_t)(count & 0xffU);
+    dividerSyncedAt = cycleCounter;
+}
+
+// TIMA can't pass 0xff here, as the overflow event always comes first
+void Gbc::syncTimer() {
+    if (cpuTimerRunning) {
+        const uint64_t count = cpuTimerCount + toCpuClocks(cycleCounter - timerSyncedAt);
+        ioPorts[0x05] += (uint8_t)(count / cpuTimerIncTime);
+        cpuTimerCount = (uint32_t)(count % cpuTimerIncTime);
+    }
+    timerSyncedAt = cycleCounter;
+}
+
+void Gbc::scheduleTimer() {
+    if (cpuTimerRunning) {
+        const uint64_t clocksToOverflow = (uint64_t)(0x100U - ioPorts[0x05]) * cpuTimerIncTime - cpuTimerCount;
+        scheduler.schedule(EventScheduler::TIMER_OVERFLOW, timerSyncedAt + fromCpuClocks(clocksToOverflow));
+    } else {
+        scheduler.cancel(EventScheduler::TIMER_OVERFLOW);
+    }
+}
+
+void Gbc::overflowTimer() {
+    // Reload from TMA and count on from the exact cycle TIMA wrapped
+    timerSyncedAt += fromCpuClocks((uint64_t)(0x100U - ioPorts[0x05]) * cpuTimerIncTime - cpuTimerCount);
+    cpuTimerCount = 0;
+    ioPorts[0x05] = ioPorts[0x06];
+    ioPorts[0x0f] |= 0x04U;
+    scheduleTimer();
+}
+
+// The audio unit samples its channels once per call, so it runs in short steps however far behind it is; that way
+// its output doesn't depend on how often it's synced
+void Gbc::syncAudio() {
+    while (audioSyncedAt < cycleCounter) {
+        const uint64_t clocks = std::min(cycleCounter - audioSyncedAt, AUDIO_SYNC_INTERVAL << DOT_SHIFT);
+        audioUnit.simulate(clocks >> DOT_SHIFT);
+        audioSyncedAt += clocks;
+    }
+}
+
+void Gbc::syncSerial() {
+    if (serialIsTransferring && !serialClockIsExternal) {
+        serialTimer -= (int32_t)toCpuClocks(cycleCounter - serialSyncedAt);
+    }
+    serialSyncedAt = cycleCounter;
+}
+
+// Schedule the end of a transfer clocked by this side, the serial timer counting CPU clocks
+void Gbc::scheduleSerial() {
+    scheduler.schedule(EventScheduler::SERIAL, cycleCounter + fromCpuClocks(std::max(serialTimer, 1)));
+}
+
+// Handle serial port timeout
+void Gbc::completeSerialTransfer() {
+    syncSerial();
+    if (serialIsTransferring) {
+        if (!serialClockIsExternal) {
+            serialIsTransferring = false;
+            ioPorts[0x02] &= 0x03U; // Clear the transferring indicator
+            ioPorts[0x0f] |= 0x08U; // Request a serial interrupt
+            ioPorts[1] = 0xffU;
+        } else {
+            if (serialTimer == 1) {
+                serialTimer = 0;
             }
         }
+    }
+}
 
-        // Handle audio
-        audioUnit.simulate(clocksPassedByInstruction / gpuClockFactor);
+void Gbc::syncVideo() {
+    if (ioPorts[0x0040] & 0x80U) {
+        gpuTimeInMode += (int32_t)((cycleCounter - videoSyncedAt) >> DOT_SHIFT);
+    }
+    videoSyncedAt = cycleCounter;
+}
 
-        // Handle serial port timeout
-        if (serialIsTransferring) {
-            if (!serialClockIsExternal) {
-                serialTimer -= clocksPassedByInstruction;
-                if (serialTimer <= 0) {
-                    serialIsTransferring = false;
-                    ioPorts[0x02] &= 0x03U; // Clear the transferring indicator
-                    ioPorts[0x0f] |= 0x08U; // Request a serial interrupt
-                    ioPorts[1] = 0xffU;
-                }
-            } else {
-                if (serialTimer == 1) {
-                    serialTimer = 0;
-                }
-            }
+// Unlike DIV and TIMA, LY and STAT aren't worked out when read. The GPU still steps at every mode change, as that's
+// where a line is drawn from the registers and VRAM as they stand, where H-blank HDMA runs and where the STAT and
+// V-blank interrupts are raised; reads see the registers as the last step left them.
+void Gbc::scheduleVideo() {
+    if (ioPorts[0x0040] & 0x80U) {
+        int32_t modeLength;
+        switch (gpuMode) {
+            case GPU_HBLANK: modeLength = 204; break;
+            case GPU_VBLANK: modeLength = 456; break;
+            case GPU_SCAN_OAM: modeLength = 80; break;
+            case GPU_SCAN_VRAM: modeLength = 172; break;
+            default: modeLength = 0; break;
         }
+        const int32_t remaining = std::max(modeLength - gpuTimeInMode, 0);
+        scheduler.schedule(EventScheduler::VIDEO, videoSyncedAt + ((uint64_t)remaining << DOT_SHIFT));
+    } else if (!blankedScreen) {
+        // Tidy up after the display was switched off, at the end of the current instruction
+        scheduler.schedule(EventScheduler::VIDEO, cycleCounter + 1);
+    } else {
+        scheduler.cancel(EventScheduler::VIDEO);
+    }
+}
 
-        // Handle GPU timings
-        if (displayEnabled) {
-            // Double CPU speed mode affects instruction rate but should not affect GPU speed
-            gpuTimeInMode += clocksPassedByInstruction / gpuClockFactor;
-            switch (gpuMode) {
-                case GPU_HBLANK:
-                    // Spends 204 cycles here, then moves to next line. After 144th hblank, move to vblank.
-                    if (gpuTimeInMode >= 204) {
-                        gpuTimeInMode -= 204;
-                        ioPorts[0x0044]++;
-                        if (ioPorts[0x0044] == 144) {
-                            gpuMode = GPU_VBLANK;
-                            ioPorts[0x0041] &= 0xfcU;
-                            ioPorts[0x0041] |= GPU_VBLANK;
-                            // Set interrupt request for VBLANK
-                            ioPorts[0x000f] |= 0x01U;
-                            accessOam = true;
-                            accessVram = true;
-                            if ((ioPorts[0x0041] & 0x10U) != 0x00) {
-                                // Request status int if condition met
-                                ioPorts[0x000f] |= 0x02U;
-                            }
-                            // This is where stuff can be drawn - on the beginning of the vblank
-                            if (!sgb.freezeScreen) {
-                                if (frameManager.frameIsInProgress()) {
-                                    auto frameBuffer = frameManager.getInProgressFrameBuffer();
-                                    if ((frameBuffer != nullptr) && romProperties.sgbFlag) {
-                                        sgb.colouriseFrame(frameBuffer);
+// Handle GPU timings, once the current mode has run its course or the display was switched off
+template <HardwareModel Model>
+void Gbc::stepVideo() {
+    syncVideo();
+    const bool displayEnabled = ioPorts[0x0040] & 0x80U;
+    if (displayEnabled) {
+        switch (gpuMode) {
+            case GPU_HBLANK:
+                // Spends 204 cycles here, then moves to next line. After 144th hblank, move to vblank.
+                if (gpuTimeInMode >= 204) {
+                    gpuTimeInMode -= 204;
+                    ioPorts[0x0044]++;
+                    if (ioPorts[0x0044] == 144) {
+                        gpuMode = GPU_VBLANK;
+                        ioPorts[0x0041] &= 0xfcU;
+                        ioPorts[0x0041] |= GPU_VBLANK;
+                        // Set interrupt request for VBLANK, and end the run here if it's running a frame at a time
+                        ioPorts[0x000f] |= 0x01U;
+                        frameCompleted = true;
+                        if (stopAtVBlank && clocksAcc > 0) {
+                            clocksHeldBack = clocksAcc;
+                            clocksAcc = 0;
+                        }
+                        setVideoAccess(true, true);
+                        if ((ioPorts[0x0041] & 0x10U) != 0x00) {
+                            // Request status int if condition met
+                            ioPorts[0x000f] |= 0x02U;
+                        }
+                        // This is where stuff can be drawn - on the beginning of the vblank
+                        if (!sgb.freezeScreen) {
+                            if (frameManager.frameIsInProgress()) {
+                                auto frameBuffer = frameManager.getInProgressFrameBuffer();
+                                if ((frameBuffer != nullptr) && Model == HardwareModel::SGB) {
+                                    sgb.colouriseFrame(frameBuffer);
+                                    for (unsigned int lineNo = 0; lineNo < BASE_FRAME_H; lineNo++) {
+                                        frameManager.getInProgressFrame()->hashLine(lineNo);
                                     }
-                                    frameManager.finishCurrentFrame();
                                 }
+                                frameManager.finishCurrentFrame();
                             }
-                        } else {
-                            gpuMode = GPU_SCAN_OAM;
-                            ioPorts[0x0041] &= 0xfcU;
-                            ioPorts[0x0041] |= GPU_SCAN_OAM;
-                            accessOam = false;
-                            accessVram = true;
-                            if (ioPorts[0x0041] & 0x20U) {
-                                // Request status int if condition met
-                                ioPorts[0x000f] |= 0x02U;
-                            }
-                        }
-                    }
-                    break;
-                case GPU_VBLANK:
-                    if (gpuTimeInMode >= 456) {
-                        // 10 of these lines in vblank
-                        gpuTimeInMode -= 456;
-                        ioPorts[0x0044]++;
-                        if (ioPorts[0x0044] >= 154) {
-                            gpuMode = GPU_SCAN_OAM;
-                            ioPorts[0x0041] &= 0xfcU;
-                            ioPorts[0x0041] |= GPU_SCAN_OAM;
-                            ioPorts[0x0044] = 0;
-                            accessOam = false;
-                            accessVram = true;
-                            if (ioPorts[0x0041] & 0x20U) {
-                                // Request status int if condition met
-                                ioPorts[0x000f] |= 0x02U;
-                            }
-
-                            // LCD starting at top of frame, ready a frame buffer if available
-                            frameManager.beginNewFrame();
                         }
-                    }
-                    break;
-                case GPU_SCAN_OAM:
-                    if (gpuTimeInMode >= 80) {
-                        gpuTimeInMode -= 80;
-                        gpuMode = GPU_SCAN_VRAM;
+                    } else {
+                        gpuMode = GPU_SCAN_OAM;
                         ioPorts[0x0041] &= 0xfcU;
-                        ioPorts[0x0041] |= GPU_SCAN_VRAM;
-                        accessOam = false;
-                        accessVram = false;
+                        ioPorts[0x0041] |= GPU_SCAN_OAM;
+                        setVideoAccess(false, true);
+                        if (ioPorts[0x0041] & 0x20U) {
+                            // Request status int if condition met
+                            ioPorts[0x000f] |= 0x02U;
+                        }
                     }
-                    break;
-                case GPU_SCAN_VRAM:
-                    if (gpuTimeInMode >= 172) {
-                        gpuTimeInMode -= 172;
-                        gpuMode = GPU_HBLANK;
+                }
+                break;
+            case GPU_VBLANK:
+                if (gpuTimeInMode >= 456) {
+                    // 10 of these lines in vblank
+                    gpuTimeInMode -= 456;
+                    ioPorts[0x0044]++;
+                    if (ioPorts[0x0044] >= 154) {
+                        gpuMode = GPU_SCAN_OAM;
                         ioPorts[0x0041] &= 0xfcU;
-                        ioPorts[0x0041] |= GPU_HBLANK;
-                        accessOam = true;
-                        accessVram = true;
-                        if (ioPorts[0x0041] & 0x08U) {
+                        ioPorts[0x0041] |= GPU_SCAN_OAM;
+                        ioPorts[0x0044] = 0;
+                        setVideoAccess(false, true);
+                        if (ioPorts[0x0041] & 0x20U) {
                             // Request status int if condition met
                             ioPorts[0x000f] |= 0x02U;
                         }
-                        // Run DMA if applicable
-                        if (ioPorts[0x55] < 0xff) {
-                            unsigned int tempAddr, tempAddr2;
-                            // H-blank DMA currently active
-                            tempAddr = (ioPorts[0x51] << 8U) + ioPorts[0x52]; // DMA source
-                            if ((tempAddr & 0xe000U) == 0x8000U) {
-                                // Don't do transfers within VRAM
-                                goto end_dma_op;
-                            }
-                            if (tempAddr >= 0xe000U) {
-                                // Don't take source data from these addresses either
-                                goto end_dma_op;
-                            }
-                            tempAddr2 = (ioPorts[0x53] << 8U) + ioPorts[0x54] + 0x8000U; // DMA destination
-                            for (int count = 0; count < 16; count++) {
-                                write8(tempAddr2, read8(tempAddr));
-                                tempAddr++;
-                                tempAddr2++;
-                                tempAddr2 &= 0x9fffU; // Keep it within VRAM
-                            }
-                            end_dma_op:
-                            //if (ClockFreq == GBC_FREQ) clocks_acc -= 64;
-                            //else clocks_acc -= 32;
-                            ioPorts[0x55]--;
-                            if (ioPorts[0x55] < 0x80U) {
-                                // End the DMA
-                                ioPorts[0x55] = 0xffU;
-                            }
-                        }
 
-                        // Process current line's graphics
-                        if (frameManager.frameIsInProgress()) {
-                            (*this.*readLine)(frameManager.getInProgressFrameBuffer());
+                        // LCD starting at top of frame, ready a frame buffer if available and the frame isn't being skipped.
+                        // Skipped frames are timed and raise interrupts as usual, but nothing is drawn.
+                        if (!frameManager.skipNextFrame()) {
+                            frameManager.beginNewFrame();
+                        }
+                    }
+                }
+                break;
+            case GPU_SCAN_OAM:
+                if (gpuTimeInMode >= 80) {
+                    gpuTimeInMode -= 80;
+                    gpuMode = GPU_SCAN_VRAM;
+                    ioPorts[0x0041] &= 0xfcU;
+                    ioPorts[0x0041] |= GPU_SCAN_VRAM;
+                    setVideoAccess(false, false);
+                }
+                break;
+            case GPU_SCAN_VRAM:
+                if (gpuTimeInMode >= 172) {
+                    gpuTimeInMode -= 172;
+                    gpuMode = GPU_HBLANK;
+                    ioPorts[0x0041] &= 0xfcU;
+                    ioPorts[0x0041] |= GPU_HBLANK;
+                    setVideoAccess(true, true);
+                    if (ioPorts[0x0041] & 0x08U) {
+                        // Request status int if condition met
+                        ioPorts[0x000f] |= 0x02U;
+                    }
+                    // Run DMA if applicable, one block per H-blank
+                    if (Model == HardwareModel::CGB && ioPorts[0x55] < 0xff) {
+                        transferHdma(1);
+                        ioPorts[0x55]--;
+                        if (ioPorts[0x55] < 0x80U) {
+                            // End the DMA
+                            ioPorts[0x55] = 0xffU;
                         }
                     }
-                    break;
-                default: // Error that should never happen:
-                    isRunning = false;
-                    clocksAcc = 0;
-                    break;
-            }
-        } else {
-            if (!blankedScreen) {
-                accessOam = true;
-                accessVram = true;
-                ioPorts[0x0044] = 0;
-                gpuTimeInMode = 0;
-                gpuMode = GPU_SCAN_OAM;
-                blankedScreen = true;
 
-                // Mark any started frames as complete - probably won't do much
-                while (frameManager.frameIsInProgress()) {
-                    frameManager.finishCurrentFrame();
+                    // Process current line's graphics
+                    if (frameManager.frameIsInProgress()) {
+                        readLine<Model>(*frameManager.getInProgressFrame());
+                    }
                 }
+                break;
+            default: // Error that should never happen:
+                isRunning = false;
+                clocksAcc = 0;
+                break;
+        }
+    } else {
+        if (!blankedScreen) {
+            setVideoAccess(true, true);
+            ioPorts[0x0044] = 0;
+            gpuTimeInMode = 0;
+            gpuMode = GPU_SCAN_OAM;
+            blankedScreen = true;
+
+            // Mark any started frames as complete - probably won't do much
+            while (frameManager.frameIsInProgress()) {
+                frameManager.finishCurrentFrame();
             }
         }
     }
+
+    // LY may have moved on; compare it with LYC after the next instruction as before
+    scheduler.schedule(EventScheduler::LY_COMPARE, cycleCounter + 1);
+    scheduleVideo();
+}
+
+void Gbc::mapMemory() {
+    for (unsigned int page = 0x00U; page < 0x100U; page++) {
+        readPages[page] = nullptr;
+        writePages[page] = nullptr;
+    }
+    for (unsigned int page = 0x00U; page < 0x40U; page++) {
+        readPages[page] = rom.data() + page * 0x100U;
+    }
+    for (unsigned int page = 0xc0U; page < 0xd0U; page++) {
+        uint8_t* memory = wram.data() + (page & 0x0fU) * 0x100U;
+        readPages[page] = writePages[page] = memory;
+        readPages[page + 0x20U] = writePages[page + 0x20U] = memory;
+    }
+    mapRomBank();
+    mapWramBank();
+    mapVram();
+    unmapWatchedPages();
+}
+
+void Gbc::mapRomBank() {
+    // Out-of-range banks are left to readUnmapped
+    const bool inRange = bankOffset + 0x4000U <= rom.size();
+    for (unsigned int page = 0x40U; page < 0x80U; page++) {
+        readPages[page] = inRange ? rom.data() + bankOffset + (page & 0x3fU) * 0x100U : nullptr;
+    }
+    unmapWatchedPages();
+}
+
+void Gbc::mapWramBank() {
+    // 0xd000 - 0xdfff, and its echo at 0xf000 - 0xfdff
+    for (unsigned int page = 0xd0U; page < 0xe0U; page++) {
+        uint8_t* memory = wram.data() + wramBankOffset + (page & 0x0fU) * 0x100U;
+        readPages[page] = writePages[page] = memory;
+        if (page < 0xdeU) {
+            readPages[page + 0x20U] = writePages[page + 0x20U] = memory;
+        }
+    }
+    unmapWatchedPages();
+}
+
+void Gbc::mapVram() {
+    // Readable only: writes go through write8 to keep the decoded tile set up to date
+    for (unsigned int page = 0x80U; page < 0xa0U; page++) {
+        readPages[page] = accessVram ? vram.data() + vramBankOffset + (page & 0x1fU) * 0x100U : nullptr;
+    }
+    unmapWatchedPages();
+}
+
+// While a debugging run has read or write breakpoints set, the pages holding their addresses are left to the slow
+// paths of read8 and write8, which check for them
+void Gbc::unmapWatchedPages() {
+#ifdef _WIN32
+    if (debuggingRun) {
+        if (debugger.breakOnRead) {
+            readPages[(debugger.breakReadAddr >> 8U) & 0xffU] = nullptr;
+        }
+        if (debugger.breakOnWrite) {
+            writePages[(debugger.breakWriteAddr >> 8U) & 0xffU] = nullptr;
+        }
+    }
+#endif
 }
 
 uint8_t Gbc::read8(unsigned int address) {
     address &= 0xffffU;
+    const uint8_t* page = readPages[address >> 8U];
+    if (page != nullptr) {
+        return page[address & 0xffU];
+    }
+    return readUnmapped(address);
+}
+
+// Reads from the pages that mapMemory couldn't point at plain memory, or that hold a read breakpoint
+uint8_t Gbc::readUnmapped(unsigned int address) {
 #ifdef _WIN32
     if (debugger.breakOnRead) {
         if (address == debugger.breakReadAddr) {
@@ -832,16 +1120,18 @@ uint8_t Gbc::read8(unsigned int address) {
 
             // Recall read function, prevent recursive calls
             debugger.breakOnRead = false;
-            debugger.breakReadByte = (unsigned int)read8(address);
+            debugger.breakReadByte = (unsigned int)readUnmapped(address);
             debugger.breakOnRead = true;
         }
     }
 #endif
 
-    if (address < 0x4000U) {
+    if (address >= 0xff80U) {
+        return ioPorts[(address & 0xffU)];
+    } else if (address < 0x4000U) {
         return rom[address];
     } else if (address < 0x8000U) {
-        return rom[bankOffset + (address & 0x3fffU)];
+        return readRomBank(address);
     } else if (address < 0xa000U) {
         if (accessVram) {
             return vram[vramBankOffset + (address & 0x1fffU)];
@@ -891,13 +1181,20 @@ uint8_t Gbc::read8(unsigned int address) {
 
 void Gbc::read16(unsigned int address, uint8_t* msb, uint8_t* lsb) {
     address &= 0xffffU;
+    const uint8_t* page = readPages[address >> 8U];
+    if (page != nullptr && (address & 0xffU) != 0xffU) {
+        *msb = page[address & 0xffU];
+        *lsb = page[(address & 0xffU) + 1];
+        return;
+    }
+
     if (address < 0x4000U) {
         *msb = rom[address];
         *lsb = rom[address + 1];
         return;
     } else if (address < 0x8000U) {
-        *msb = rom[bankOffset + (address & 0x3fffU)];
-        *lsb = rom[bankOffset + ((address + 1) & 0x3fffU)];
+        *msb = readRomBank(address);
+        *lsb = readRomBank(address + 1);
         return;
     } else if (address < 0xa000U) {
         if (accessVram) {
@@ -962,6 +1259,13 @@ void Gbc::read16(unsigned int address, uint8_t* msb, uint8_t* lsb) {
 
 void Gbc::write8(unsigned int address, uint8_t byte) {
     address &= 0xffffU;
+    uint8_t* page = writePages[address >> 8U];
+    if (page != nullptr) {
+        // Only WRAM is mapped for writing
+        page[address & 0xffU] = byte;
+        blockCache.wramWritten((uint32_t)(page + (address & 0xffU) - wram.data()));
+        return;
+    }
 #ifdef _WIN32
     if (debugger.breakOnWrite) {
         if (address == debugger.breakWriteAddr) {
@@ -970,165 +1274,18 @@ void Gbc::write8(unsigned int address, uint8_t byte) {
         }
     }
 #endif
-    if (address < 0x8000U) {
-        switch (romProperties.mbc) {
-            case MBC1:
-                if (address < 0x2000U) {
-                    // Only 4 bits are used. Writing 0xa enables SRAM
-                    byte = byte & 0x0fU;
-                    sram.enableFlag = byte == 0x0aU;
-                    return;
-                } else if (address < 0x4000U) {
-                    // Set low 5 bits of bank number
-                    bankOffset &= 0xfff80000U;
-                    byte = byte & 0x1fU;
-                    if (byte == 0x00) {
-                        byte++;
-                    }
-                    bankOffset |= ((unsigned int)byte * 0x4000U);
-                    bankOffset &= (romProperties.bankSelectMask * 0x4000U);
-                    return;
-                } else if (address < 0x6000U) {
-                    byte &= 0x03U;
-                    if (romProperties.mbcMode != 0) {
-                        sram.bankOffset = (unsigned int)byte * 0x2000U; // Select RAM bank
-                    } else {
-                        bankOffset &= 0xffe7c000U;
-                        bankOffset |= (unsigned int)byte * 0x80000U;
-                        bankOffset &= (romProperties.bankSelectMask * 0x4000U);
-                    }
-                    return;
-                } else {
-                    if (sram.sizeBytes > 8192) {
-                        romProperties.mbcMode = byte & 0x01U;
-                    } else {
-                        romProperties.mbcMode = 0;
-                    }
-                    return;
-                }
-            case MBC2:
-                if (address < 0x1000U) {
-                    // Only 4 bits are used. Writing 0xa enables SRAM.
-                    byte = byte & 0x0fU;
-                    sram.enableFlag = byte == 0x0aU;
-                    return;
-                } else if (address < 0x2100U) {
-                    return;
-                } else if (address < 0x21ffU) {
-                    byte &= 0x0fU;
-                    byte &= romProperties.bankSelectMask;
-                    if (byte == 0) {
-                        byte++;
-                    }
-                    bankOffset = (unsigned int)byte * 0x4000U;
-                    return;
-                }
-                return;
-            case MBC3:
-                if (address < 0x2000U) {
-                    byte = byte & 0x0fU;
-                    sram.enableFlag = byte == 0x0aU; // Also enables timer registers
-#ifdef _WIN32
-                    if (sram.enableFlag) {
-                        if (debugger.breakOnSramEnable) {
-                            debugger.setBreakCode(DebugWindowModule::BreakCode::ENABLED_SRAM);
-                        }
-                    } else {
-                        if (debugger.breakOnSramDisable) {
-                            debugger.setBreakCode(DebugWindowModule::BreakCode::DISABLED_SRAM);
-                        }
-                    }
-#endif
-                    return;
-                } else if (address < 0x4000U) {
-                    byte &= romProperties.bankSelectMask;
-                    if (byte == 0) {
-                        byte++;
-                    }
-                    bankOffset = (unsigned int)byte * 0x4000U;
-                    return;
-                } else if (address < 0x6000U) {
-                    byte &= 0x0fU;
-                    if (byte < 0x04U) {
-                        sram.bankOffset = (unsigned int)byte * 0x2000U;
-                        sram.timerMode = 0;
-                    } else if ((byte >= 0x08U) && (byte < 0x0dU)) {
-                        sram.timerMode = (unsigned int)byte;
-                    } else {
-                        sram.timerMode = 0;
-                    }
-                    return;
-                } else {
-                    byte &= 0x01U;
-                    if ((sram.timerLatch == 0x00U) && (byte == 0x01U)) {
-                        latchTimerData();
-                    }
-                    sram.timerLatch = (unsigned int)byte;
-                    return;
-                }
-                break;
-            case MBC5:
-                if (address < 0x2000U) {
-                    // RAMG - 4 bits, enable external RAM by writing 0xa
-                    byte = byte & 0x0fU;
-                    sram.enableFlag = byte == 0x0aU;
-                    return;
-                } else if (address < 0x3000U) {
-                    // ROMB0 - lower 8 bits of 9-bit ROM bank (note MBC5 can select bank 0 here)
-                    uint32_t maskedByte = byte & romProperties.bankSelectMask;
-                    bankOffset &= 0x00400000U;
-                    bankOffset |= (maskedByte * 0x4000U);
-                    return;
-                }
-                else if (address < 0x4000U) {
-                    // ROMB1 - 1 bit, upper bit of 9-bit RAM bank (note MBC5 can select bank 0 here)
-                    byte &= 0x01U;
-                    bankOffset &= 0x003fc000U;
-                    if (byte != 0x00U) {
-                        bankOffset |= 0x00400000U;
-                    }
-                    bankOffset &= (romProperties.bankSelectMask * 0x4000U);
-                    return;
-                } else if (address < 0x6000U) {
-                    // RAMB - 4-bit RAM bank
-                    byte &= 0x0fU;
-                    sram.bankOffset = (unsigned int)byte * 0x2000U;
-                    return;
-                }
 
-                // Writing to 0x6000 - 0x7fff does nothing
-                return;
-        }
+    if (address < 0x8000U) {
+        blockCache.bankChanged();
+        writeBankControl(address, byte);
+        mapRomBank();
     } else if (address < 0xa000U) {
         if (accessVram) {
             // Mask to address within range 0x0000-0x1fff and write to that VRAM address
             address = address & 0x1fffU;
             vram[vramBankOffset + address] = byte;
 
-            // Decode character set from GB format to something more computer-friendly
-            if (address < 0x1800U) {
-
-                // Get the pair of bytes just modified (i.e. one row in the character)
-                // Note there are 384 characters in the map, per VRAM bank, each stored with 16 bytes
-                size_t relativeVramAddress = address & 0x1ffeU;
-                uint32_t byte1 = 0x000000ffU & (uint32_t)vram[vramBankOffset + relativeVramAddress];
-                uint32_t byte2 = 0x000000ffU & (uint32_t)vram[vramBankOffset + relativeVramAddress + 1];
-
-                // Find the address into decoded data to update now
-                // The output format uses 64 bytes per tile rather than 16, hence input address * 4
-                size_t outputAddress = relativeVramAddress * 4;
-                if (vramBankOffset) {
-                    outputAddress += 24576;
-                }
-                tileSet[outputAddress++] = ((byte2 >> 6U) & 0x02U) + (byte1 >> 7U);
-                tileSet[outputAddress++] = ((byte2 >> 5U) & 0x02U) + ((byte1 >> 6U) & 0x01U);
-                tileSet[outputAddress++] = ((byte2 >> 4U) & 0x02U) + ((byte1 >> 5U) & 0x01U);
-                tileSet[outputAddress++] = ((byte2 >> 3U) & 0x02U) + ((byte1 >> 4U) & 0x01U);
-                tileSet[outputAddress++] = ((byte2 >> 2U) & 0x02U) + ((byte1 >> 3U) & 0x01U);
-                tileSet[outputAddress++] = ((byte2 >> 1U) & 0x02U) + ((byte1 >> 2U) & 0x01U);
-                tileSet[outputAddress++] = (byte2 & 0x02U) + ((byte1 >> 1U) & 0x01U);
-                tileSet[outputAddress] = ((byte2 << 1U) & 0x02U) + (byte1 & 0x01U);
-            }
+            tileCache.invalidate(vramBankOffset + address);
         }
     } else if (address < 0xc000U) {
         if (sram.enableFlag) {
@@ -1149,12 +1306,16 @@ void Gbc::write8(unsigned int address, uint8_t byte) {
         }
     } else if (address < 0xd000U) {
         wram[address & 0x0fffU] = byte;
+        blockCache.wramWritten(address & 0x0fffU);
     } else if (address < 0xe000U) {
         wram[wramBankOffset + (address & 0x0fffU)] = byte;
+        blockCache.wramWritten(wramBankOffset + (address & 0x0fffU));
     } else if (address < 0xf000U) {
         wram[address & 0x0fffU] = byte;
+        blockCache.wramWritten(address & 0x0fffU);
     } else if (address < 0xfe00U) {
         wram[wramBankOffset + (address & 0x0fffU)] = byte;
+        blockCache.wramWritten(wramBankOffset + (address & 0x0fffU));
     } else if (address < 0xfea0U) {
         if (accessOam) {
             oam[(address & 0x00ffU) % 160] = byte;
@@ -1165,12 +1326,154 @@ void Gbc::write8(unsigned int address, uint8_t byte) {
         writeIO(address & 0x007fU, byte);
     } else {
         ioPorts[address & 0x00ffU] = byte;
+        blockCache.hramWritten(address);
     }
 
 }
 
+// Writes to the ROM area, which go to the memory bank controller
+void Gbc::writeBankControl(unsigned int address, uint8_t byte) {
+    switch (romProperties.mbc) {
+        case MBC1:
+            if (address < 0x2000U) {
+                // Only 4 bits are used. Writing 0xa enables SRAM
+                byte = byte & 0x0fU;
+                sram.enableFlag = byte == 0x0aU;
+                return;
+            } else if (address < 0x4000U) {
+                // Set low 5 bits of bank number
+                bankOffset &= 0xfff80000U;
+                byte = byte & 0x1fU;
+                if (byte == 0x00) {
+                    byte++;
+                }
+                bankOffset |= ((unsigned int)byte * 0x4000U);
+                bankOffset &= (romProperties.bankSelectMask * 0x4000U);
+                return;
+            } else if (address < 0x6000U) {
+                byte &= 0x03U;
+                if (romProperties.mbcMode != 0) {
+                    sram.bankOffset = (unsigned int)byte * 0x2000U; // Select RAM bank
+                } else {
+                    bankOffset &= 0xffe7c000U;
+                    bankOffset |= (unsigned int)byte * 0x80000U;
+                    bankOffset &= (romProperties.bankSelectMask * 0x4000U);
+                }
+                return;
+            } else {
+                if (sram.sizeBytes > 8192) {
+                    romProperties.mbcMode = byte & 0x01U;
+                } else {
+                    romProperties.mbcMode = 0;
+                }
+                return;
+            }
+        case MBC2:
+            if (address < 0x1000U) {
+                // Only 4 bits are used. Writing 0xa enables SRAM.
+                byte = byte & 0x0fU;
+                sram.enableFlag = byte == 0x0aU;
+                return;
+            } else if (address < 0x2100U) {
+                return;
+            } else if (address < 0x21ffU) {
+                byte &= 0x0fU;
+                byte &= romProperties.bankSelectMask;
+                if (byte == 0) {
+                    byte++;
+                }
+                bankOffset = (unsigned int)byte * 0x4000U;
+                return;
+            }
+            return;
+        case MBC3:
+            if (address < 0x2000U) {
+                byte = byte & 0x0fU;
+                sram.enableFlag = byte == 0x0aU; // Also enables timer registers
+#ifdef _WIN32
+                if (sram.enableFlag) {
+                    if (debugger.breakOnSramEnable) {
+                        debugger.setBreakCode(DebugWindowModule::BreakCode::ENABLED_SRAM);
+                    }
+                } else {
+                    if (debugger.breakOnSramDisable) {
+                        debugger.setBreakCode(DebugWindowModule::BreakCode::DISABLED_SRAM);
+                    }
+                }
+#endif
+                return;
+            } else if (address < 0x4000U) {
+                byte &= romProperties.bankSelectMask;
+                if (byte == 0) {
+                    byte++;
+                }
+                bankOffset = (unsigned int)byte * 0x4000U;
+                return;
+            } else if (address < 0x6000U) {
+                byte &= 0x0fU;
+                if (byte < 0x04U) {
+                    sram.bankOffset = (unsigned int)byte * 0x2000U;
+                    sram.timerMode = 0;
+                } else if ((byte >= 0x08U) && (byte < 0x0dU)) {
+                    sram.timerMode = (unsigned int)byte;
+                } else {
+                    sram.timerMode = 0;
+                }
+                return;
+            } else {
+                byte &= 0x01U;
+                if ((sram.timerLatch == 0x00U) && (byte == 0x01U)) {
+                    latchTimerData();
+                }
+                sram.timerLatch = (unsigned int)byte;
+                return;
+            }
+            break;
+        case MBC5:
+            if (address < 0x2000U) {
+                // RAMG - 4 bits, enable external RAM by writing 0xa
+                byte = byte & 0x0fU;
+                sram.enableFlag = byte == 0x0aU;
+                return;
+            } else if (address < 0x3000U) {
+                // ROMB0 - lower 8 bits of 9-bit ROM bank (note MBC5 can select bank 0 here)
+                uint32_t maskedByte = byte & romProperties.bankSelectMask;
+                bankOffset &= 0x00400000U;
+                bankOffset |= (maskedByte * 0x4000U);
+                return;
+            }
+            else if (address < 0x4000U) {
+                // ROMB1 - 1 bit, upper bit of 9-bit RAM bank (note MBC5 can select bank 0 here)
+                byte &= 0x01U;
+                bankOffset &= 0x003fc000U;
+                if (byte != 0x00U) {
+                    bankOffset |= 0x00400000U;
+                }
+                bankOffset &= (romProperties.bankSelectMask * 0x4000U);
+                return;
+            } else if (address < 0x6000U) {
+                // RAMB - 4-bit RAM bank
+                byte &= 0x0fU;
+                sram.bankOffset = (unsigned int)byte * 0x2000U;
+                return;
+            }
+
+            // Writing to 0x6000 - 0x7fff does nothing
+            return;
+    }
+}
+
 void Gbc::write16(unsigned int address, uint8_t msb, uint8_t lsb) {
     address &= 0xffffU;
+    uint8_t* page = writePages[address >> 8U];
+    if (page != nullptr && (address & 0xffU) != 0xffU) {
+        const auto wramIndex = (uint32_t)(page + (address & 0xffU) - wram.data());
+        page[address & 0xffU] = msb;
+        page[(address & 0xffU) + 1] = lsb;
+        blockCache.wramWritten(wramIndex);
+        blockCache.wramWritten(wramIndex + 1);
+        return;
+    }
 #ifdef _WIN32
     if (debugger.breakOnWrite) {
         if (address == debugger.breakWriteAddr) {
@@ -1182,6 +1485,7 @@ void Gbc::write16(unsigned int address, uint8_t msb, uint8_t lsb) {
         }
     }
 #endif
+
     if (address < 0x8000U) {
         write8(address, msb);
         write8(address + 1, lsb);
@@ -1189,6 +1493,8 @@ void Gbc::write16(unsigned int address, uint8_t msb, uint8_t lsb) {
         if (accessVram) {
             vram[vramBankOffset + (address & 0x1fffU)] = msb;
             vram[vramBankOffset + ((address + 1) & 0x1fffU)] = lsb;
+            tileCache.invalidate(vramBankOffset + (address & 0x1fffU));
+            tileCache.invalidate(vramBankOffset + ((address + 1) & 0x1fffU));
         }
     } else if (address < 0xbfffU) {
         if (sram.enableFlag) {
@@ -1202,15 +1508,23 @@ void Gbc::write16(unsigned int address, uint8_t msb, uint8_t lsb) {
     } else if (address < 0xcfffU) {
         wram[address & 0x0fffU] = msb;
         wram[(address + 1) & 0x0fffU] = lsb;
+        blockCache.wramWritten(address & 0x0fffU);
+        blockCache.wramWritten((address + 1) & 0x0fffU);
     } else if (address < 0xdfffU) {
         wram[wramBankOffset + (address & 0x0fffU)] = msb;
         wram[wramBankOffset + ((address + 1) & 0x0fffU)] = lsb;
+        blockCache.wramWritten(wramBankOffset + (address & 0x0fffU));
+        blockCache.wramWritten(wramBankOffset + ((address + 1) & 0x0fffU));
     } else if (address < 0xefffU) {
         wram[address & 0x0fffU] = msb;
         wram[(address + 1) & 0x0fffU] = lsb;
+        blockCache.wramWritten(address & 0x0fffU);
+        blockCache.wramWritten((address + 1) & 0x0fffU);
     } else if (address < 0xfdffU) {
         wram[wramBankOffset + (address & 0x0fffU)] = msb;
         wram[wramBankOffset + ((address + 1) & 0x0fffU)] = lsb;
+        blockCache.wramWritten(wramBankOffset + (address & 0x0fffU));
+        blockCache.wramWritten(wramBankOffset + ((address + 1) & 0x0fffU));
     } else if (address < 0xfe9fU) {
         if (accessOam) {
             oam[(address & 0x00ffU) % 160] = msb;
@@ -1225,6 +1539,8 @@ void Gbc::write16(unsigned int address, uint8_t msb, uint8_t lsb) {
     } else {
         ioPorts[address & 0x00ffU] = msb;
         ioPorts[(address + 1) & 0x00ffU] = lsb;
+        blockCache.hramWritten(address);
+        blockCache.hramWritten(address + 1);
     }
 }
 
@@ -1246,6 +1562,12 @@ uint8_t Gbc::readIO(unsigned int ioIndex) {
             return ioPorts[1];
         case 0x02: // Serial control
             return ioPorts[2];
+        case 0x04: // Divider
+            syncDivider();
+            return ioPorts[0x04];
+        case 0x05: // Timer counter
+            syncTimer();
+            return ioPorts[0x05];
         case 0x11: // NR11
             return ioPorts[0x11] & 0xc0U;
         case 0x13: // NR13
@@ -1264,6 +1586,9 @@ uint8_t Gbc::readIO(unsigned int ioIndex) {
             return ioPorts[0x1e] & 0x40U;
         case 0x23: // NR44
             return ioPorts[0x23] & 0x40U;
+        case 0x26: // NR52 (channel status bits are updated as the audio unit runs)
+            syncAudio();
+            return ioPorts[0x26];
         case 0x69: // CBG background palette data (using address set by 0xff68)
             if (romProperties.cgbFlag == 0) {
                 return 0;
@@ -1282,6 +1607,12 @@ uint8_t Gbc::readIO(unsigned int ioIndex) {
 void Gbc::writeIO(unsigned int ioIndex, uint8_t data) {
     uint8_t byte;
     unsigned int word, count;
+
+    // The audio unit runs behind; bring it up to date before anything changes how it sounds
+    if (ioIndex >= 0x10U && ioIndex < 0x40U) {
+        syncAudio();
+    }
+
     switch (ioIndex) {
         case 0x00U:
             byte = data & 0x30U;
@@ -1376,21 +1707,32 @@ void Gbc::writeIO(unsigned int ioIndex, uint8_t data) {
                     } else if ((data & 0x02U) != 0x00U) {
                         serialTimer /= 32;
                     }
+                    serialSyncedAt = cycleCounter;
+                    scheduleSerial();
                 } else {
                     // Listen for a transfer
                     serialClockIsExternal = true;
                     serialTimer = 1;
+                    scheduler.schedule(EventScheduler::SERIAL, cycleCounter + 1);
                 }
             } else {
                 ioPorts[2] = data & 0x83U;
                 serialIsTransferring = false;
                 serialRequest = false;
+                scheduler.cancel(EventScheduler::SERIAL);
             }
             return;
         case 0x04: // Divider register (writing resets to 0)
+            syncDivider();
             ioPorts[0x04] = 0x00U;
             return;
+        case 0x05: // Timer counter
+            syncTimer();
+            ioPorts[0x05] = data;
+            scheduleTimer();
+            return;
         case 0x07: // Timer control
+            syncTimer();
             cpuTimerRunning = data & 0x04U;
             switch (data & 0x03U) {
                 case 0:
@@ -1407,6 +1749,8 @@ void Gbc::writeIO(unsigned int ioIndex, uint8_t data) {
                     break;
             }
             ioPorts[0x07] = data & 0x07U;
+            cpuTimerCount %= cpuTimerIncTime;
+            scheduleTimer();
             return;
         case 0x10:
             ioPorts[0x10] = data & 0x7fU;
@@ -1477,9 +1821,9 @@ void Gbc::writeIO(unsigned int ioIndex, uint8_t data) {
             audioUnit.updateWaveformData(ioIndex);
             return;
         case 0x40: // LCD ctrl
+            syncVideo();
             if (data < 128) {
-                accessVram = true;
-                accessOam = true;
+                setVideoAccess(true, true);
                 blankedScreen = false;
                 ioPorts[0x41] &= 0xfcU;
                 ioPorts[0x44] = 0;
@@ -1494,9 +1838,7 @@ void Gbc::writeIO(unsigned int ioIndex, uint8_t data) {
 
                         // If a frame was obtained, clear it to black and flag it for rendering
                         if (frameBuffer) {
-                            for (ioIndex = 0; ioIndex < 160 * 144; ioIndex++) {
-                                frameBuffer[ioIndex] = 0x000000ffU;
-                            }
+                            frameManager.getInProgressFrame()->clear();
                             frameManager.finishCurrentFrame();
                         }
                     }
@@ -1504,12 +1846,14 @@ void Gbc::writeIO(unsigned int ioIndex, uint8_t data) {
             } else {
                 if (ioPorts[0x40] < 0x80) {
                     // LCD being enabled, attempt to reserve a frame buffer for drawing
-                    if (!frameManager.frameIsInProgress()) {
+                    if (!frameManager.frameIsInProgress() && !frameManager.skipNextFrame()) {
                         frameManager.beginNewFrame();
                     }
                 }
             }
             ioPorts[0x40] = data;
+            scheduleVideo();
+            scheduler.schedule(EventScheduler::LY_COMPARE, cycleCounter + 1);
             return;
         case 0x41: // LCD status
             ioPorts[0x41] &= 0x07U; // Bits 0-2 are read-only. Bit 7 doesn't exist.
@@ -1517,15 +1861,23 @@ void Gbc::writeIO(unsigned int ioIndex, uint8_t data) {
             return;
         case 0x44: // LCD Line No (read-only)
             return;
+        case 0x45: // LY compare
+            ioPorts[0x45] = data;
+            scheduler.schedule(EventScheduler::LY_COMPARE, cycleCounter + 1);
+            return;
         case 0x46: // Launch OAM DMA transfer
             ioPorts[0x46] = data;
             if (data < 0x80U) {
                 return; // Cannot copy from ROM in this way
             }
             word = ((unsigned int)data) << 8U;
-            for (count = 0; count < 160; count++) {
-                oam[count] = read8(word);
-                word++;
+            if (readPages[data] != nullptr) {
+                memcpy(oam, readPages[data], 160);
+            } else {
+                for (count = 0; count < 160; count++) {
+                    oam[count] = read8(word);
+                    word++;
+                }
             }
             return;
         case 0x47: // Mono palette
@@ -1555,6 +1907,7 @@ void Gbc::writeIO(unsigned int ioIndex, uint8_t data) {
             if (romProperties.cgbFlag) {
                 ioPorts[0x4f] = data & 0x01U; // 1-bit register
                 vramBankOffset = (unsigned int)(data & 0x01U) * 0x2000U;
+                mapVram();
             }
             return;
         case 0x51: // HDMA1
@@ -1580,27 +1933,9 @@ void Gbc::writeIO(unsigned int ioIndex, uint8_t data) {
                     ioPorts[0x55] = data; // Can be used to halt H-blank DMA
                     return;
                 }
-                word = (ioPorts[0x51] << 8U) + ioPorts[0x52]; // DMA source
-                if ((word & 0xe000U) == 0x8000U) {
-                    // Don't do transfers within VRAM
-                    return;
-                }
-                if (word >= 0xe000U) {
-                    // Don't take source data from these addresses either
+                if (!transferHdma((data & 0x7fU) + 1)) {
                     return;
                 }
-                unsigned int word2 = (ioPorts[0x53] << 8U) + ioPorts[0x54] + 0x8000U; // DMA destination
-                unsigned int bytesToTransfer = data & 0x7fU;
-                bytesToTransfer++;
-                bytesToTransfer *= 16;
-                for (count = 0; count < bytesToTransfer; count++) {
-                    write8(word2, read8(word));
-                    word++;
-                    word2++;
-                    word2 &= 0x9fffU; // Keep it within VRAM
-                }
-                //if (ClockFreq == GBC_FREQ) clocks_acc -= BytesToTransfer * 4;
-                //else clocks_acc -= BytesToTransfer * 2;
                 ioPorts[0x55] = 0xffU;
             } else {
                 // H-blank DMA
@@ -1621,6 +1956,7 @@ void Gbc::writeIO(unsigned int ioIndex, uint8_t data) {
             return;
         case 0x69: // CBG background palette data (using address set by 0xff68)
             cgbBgPalData[cgbBgPalIndex] = data;
+            palettesChanged = true;
             cgbBgPalette[cgbBgPalIndex >> 1U] = REMAP_555_8888((unsigned int)cgbBgPalData[cgbBgPalIndex & 0xfeU], (unsigned int)cgbBgPalData[cgbBgPalIndex | 0x01U]);
             if (cgbBgPalIncr) {
                 cgbBgPalIndex++;
@@ -1640,6 +1976,7 @@ void Gbc::writeIO(unsigned int ioIndex, uint8_t data) {
             return;
         case 0x6b: // CBG sprite palette data (using address set by 0xff6a)
             cgbObjPalData[cgbObjPalIndex] = data;
+            palettesChanged = true;
             cgbObjPalette[cgbObjPalIndex >> 1U] = REMAP_555_8888((unsigned int)cgbObjPalData[cgbObjPalIndex & 0xfeU], (unsigned int)cgbObjPalData[cgbObjPalIndex | 0x01U]);
             if (cgbObjPalIncr) {
                 cgbObjPalIndex++;
@@ -1656,6 +1993,8 @@ void Gbc::writeIO(unsigned int ioIndex, uint8_t data) {
             data = data != 0 ? data : 1;
             wramBankOffset = (unsigned int)data * 0x1000U;
             ioPorts[0x70] = data;
+            blockCache.bankChanged();
+            mapWramBank();
             return;
         default:
             ioPorts[ioIndex] = data;
@@ -1667,19 +2006,78 @@ void Gbc::latchTimerData() {
 
 }
 
+// The CPU is held up while a DMA transfer runs, though everything else carries on
+void Gbc::stallCpu(uint64_t cycles) {
+    clocksAcc -= (int32_t)toCpuClocks(cycles);
+    cycleCounter += cycles;
+}
+
+// Copy 16-byte blocks from the HDMA source into VRAM, advancing the source and destination past them. Blocks are
+// aligned, so each one comes from a single page and lands in VRAM without wrapping; unless a page is unmapped or
+// watched by the debugger, it's copied in one go, and the tiles covered are invalidated together at the end.
+// Returns false without copying anything if the source is somewhere HDMA can't read from.
+bool Gbc::transferHdma(unsigned int blocks) {
+    unsigned int source = ((unsigned int)ioPorts[0x51] << 8U) + ioPorts[0x52];
+    if ((source & 0xe000U) == 0x8000U || source >= 0xe000U) {
+        // Don't do transfers within VRAM, or take source data from above WRAM
+        return false;
+    }
+    const unsigned int start = ((unsigned int)ioPorts[0x53] << 8U) + ioPorts[0x54];
+    bool directWrites = accessVram;
+#ifdef _WIN32
+    if (debugger.breakOnWrite && (debugger.breakWriteAddr & 0xe000U) == 0x8000U) {
+        directWrites = false;
+    }
+#endif
+
+    unsigned int destination = start;
+    for (unsigned int block = 0; block < blocks; block++) {
+        const uint8_t* page = readPages[(source >> 8U) & 0xffU];
+        if (page != nullptr && directWrites) {
+            memcpy(&vram[vramBankOffset + destination], page + (source & 0xffU), 16);
+        } else {
+            for (unsigned int count = 0; count < 16; count++) {
+                write8(0x8000U + destination + count, read8(source + count));
+            }
+        }
+        source += 16;
+        destination = (destination + 16) & 0x1fffU; // Keep it within VRAM
+    }
+
+    // The whole transfer wraps at most once
+    const unsigned int end = start + blocks * 16;
+    tileCache.invalidateRange(vramBankOffset + start, vramBankOffset + std::min(end, 0x2000U));
+    if (end > 0x2000U) {
+        tileCache.invalidateRange(vramBankOffset, vramBankOffset + end - 0x2000U);
+    }
+
+    ioPorts[0x51] = (uint8_t)(source >> 8U);
+    ioPorts[0x52] = (uint8_t)source;
+    ioPorts[0x53] = (uint8_t)(destination >> 8U);
+    ioPorts[0x54] = (uint8_t)destination;
+    stallCpu(blocks * HDMA_BLOCK_CYCLES);
+    return true;
+}
+
 bool Gbc::switchRunningSpeed() {
     bool speedChangeRequested = romProperties.cgbFlag && (ioPorts[0x4d] & 0x01U);
     if (speedChangeRequested) {
-        // Speed change was requested in CGB mode
+        // Speed change was requested in CGB mode. Catch up at the old speed first, then move the deadlines of
+        // everything that counts CPU clocks; the GPU and audio run at the same speed either way.
+        syncSubsystems();
         ioPorts[0x4d] &= 0x80U;
         if (ioPorts[0x4d] == 0x00) {
             ioPorts[0x4d] = 0x80U;
             cpuClockFreq = GBC_FREQ;
-            gpuClockFactor = 2;
+            cpuClockShift = 0;
         } else {
             ioPorts[0x4d] = 0x00;
             cpuClockFreq = GB_FREQ;
-            gpuClockFactor = 1;
+            cpuClockShift = 1;
+        }
+        scheduleTimer();
+        if (serialIsTransferring && !serialClockIsExternal) {
+            scheduleSerial();
         }
     }
     return speedChangeRequested;
@@ -1701,6 +2099,7 @@ bool Gbc::switchRunningSpeed() {
 
 
 void Gbc::translatePaletteBg(unsigned int paletteData) {
+    palettesChanged = true;
     translatedPaletteBg[0] = stockPaletteBg[paletteData & 0x03U];
     translatedPaletteBg[1] = stockPaletteBg[(paletteData & 0x0cU) / 4];
     translatedPaletteBg[2] = stockPaletteBg[(paletteData & 0x30U) / 16];
@@ -1712,6 +2111,7 @@ void Gbc::translatePaletteBg(unsigned int paletteData) {
 }
 
 void Gbc::translatePaletteObj1(unsigned int paletteData) {
+    palettesChanged = true;
     translatedPaletteObj[1] = stockPaletteObj1[(paletteData & 0x0cU) / 4];
     translatedPaletteObj[2] = stockPaletteObj1[(paletteData & 0x30U) / 16];
     translatedPaletteObj[3] = stockPaletteObj1[(paletteData & 0xc0U) / 64];
@@ -1721,6 +2121,7 @@ void Gbc::translatePaletteObj1(unsigned int paletteData) {
 }
 
 void Gbc::translatePaletteObj2(unsigned int paletteData) {
+    palettesChanged = true;
     translatedPaletteObj[5] = stockPaletteObj2[(paletteData & 0x0cU) / 4];
     translatedPaletteObj[6] = stockPaletteObj2[(paletteData & 0x30U) / 16];
     translatedPaletteObj[7] = stockPaletteObj2[(paletteData & 0xc0U) / 64];
@@ -1729,7 +2130,120 @@ void Gbc::translatePaletteObj2(unsigned int paletteData) {
     sgbPaletteTranslationObj[7] = (paletteData & 0xc0U) / 64;
 }
 
-void Gbc::readLineGb(uint32_t* frameBuffer) {
+template <HardwareModel Model>
+void Gbc::readLine(Frame& frame) {
+    const bool indexed = frame.getFormat() == PixelFormat::INDEXED;
+    if constexpr (Model == HardwareModel::CGB) {
+        indexed ? readLineCgb<true>(frame) : readLineCgb<false>(frame);
+    } else if constexpr (Model == HardwareModel::SGB) {
+        readLineSgb();
+    } else {
+        indexed ? readLineGb<true>(frame) : readLineGb<false>(frame);
+    }
+
+    // SGB lines only reach the frame once it's coloured, which hashes them then
+    if constexpr (Model != HardwareModel::SGB) {
+        frame.hashLine(ioPorts[0x44]);
+    }
+}
+
+// Where a line renderer draws a line of the frame, and in what
+template <bool Indexed>
+static inline auto frameLine(Frame& frame, unsigned int lineNo) {
+    if constexpr (Indexed) {
+        return &frame.getIndices()[160 * lineNo];
+    } else {
+        return &frame.getBuffer()[160 * lineNo];
+    }
+}
+
+// 0xff in each byte of the result where that byte of the input is non-zero, otherwise 0x00
+static inline uint64_t nonZeroBytes(uint64_t bytes) {
+    const uint64_t highBits = (((bytes & 0x7f7f7f7f7f7f7f7fULL) + 0x7f7f7f7f7f7f7f7fULL) | bytes) & 0x8080808080808080ULL;
+    return (highBits >> 7U) * 0xffU;
+}
+
+// Picks the sprites on a line the way the OAM scan does - the first 10 in OAM whose rows include it, whatever their X
+// position - and draws them into spriteLine highest priority first, each pixel keeping the first sprite pixel that
+// isn't transparent. Returns false if none of them are on-screen, otherwise the pixels from start up to end that they
+// may have drawn to.
+template <HardwareModel Model>
+bool Gbc::composeSprites(unsigned int lineNo, bool largeSprites, unsigned int& start, unsigned int& end) {
+    const unsigned int height = largeSprites ? 16 : 8;
+    unsigned int spriteCount = 0;
+    for (unsigned int offset = 0; offset < 160 && spriteCount < 10; offset += 4) {
+        const unsigned int scrY = oam[offset];
+        if (lineNo + 16 >= scrY && lineNo + 16 < scrY + height) {
+            lineSprites[spriteCount++] = (uint8_t)offset;
+        }
+    }
+    if (spriteCount == 0) {
+        return false;
+    }
+
+    // Outside CGB mode the sprite furthest left has priority, with OAM order breaking ties; in it, OAM order alone
+    if constexpr (Model != HardwareModel::CGB) {
+        for (unsigned int sprite = 1; sprite < spriteCount; sprite++) {
+            const uint8_t offset = lineSprites[sprite];
+            unsigned int position = sprite;
+            while (position > 0 && oam[lineSprites[position - 1] + 1] > oam[offset + 1]) {
+                lineSprites[position] = lineSprites[position - 1];
+                position--;
+            }
+            lineSprites[position] = offset;
+        }
+    }
+
+    memset(spriteLine, 0, sizeof(spriteLine));
+    start = 160;
+    end = 0;
+    for (unsigned int sprite = 0; sprite < spriteCount; sprite++) {
+        const unsigned int offset = lineSprites[sprite];
+        const unsigned int scrX = oam[offset + 1];
+        if (scrX == 0 || scrX > 167) {
+            // Off-screen, though still counted towards the limit
+            continue;
+        }
+        unsigned int tileNo = oam[offset + 2];
+        const unsigned int spriteFlags = oam[offset + 3];
+
+        // Get row within the sprite, flipped vertically if it is; 8x16 sprites take the top or bottom tile of a pair
+        unsigned int pixY = lineNo + 16 - oam[offset];
+        if (spriteFlags & 0x40U) {
+            pixY = height - 1 - pixY;
+        }
+        if (largeSprites) {
+            tileNo = (tileNo & 0xfeU) | (pixY >> 3U);
+            pixY &= 0x07U;
+        }
+
+        // Set which palette to draw with, as an offset into the OBJ palettes, along with the priority flag
+        unsigned int attributes = spriteFlags & 0x80U;
+        if constexpr (Model == HardwareModel::CGB) {
+            if (spriteFlags & 0x08U) {
+                tileNo += 384;
+            }
+            attributes |= 4 * (spriteFlags & 0x07U);
+        } else {
+            attributes |= spriteFlags & 0x10U ? 4 : 0;
+        }
+        const uint8_t* tileSetPointer = spriteFlags & 0x20U ? tileCache.flippedRow(tileNo, pixY) : tileCache.row(tileNo, pixY);
+
+        // The sprite covers pixels scrX - 8 up to scrX, clipped to the screen. All 8 of its pixels are drawn at once
+        // into the line, whose first pixel is at spriteLine[8], filling those not already taken with its opaque ones.
+        start = std::min(start, scrX < 8 ? 0 : scrX - 8);
+        end = std::max(end, std::min(scrX, 160U));
+        uint64_t pixels, drawn;
+        memcpy(&pixels, tileSetPointer, 8);
+        memcpy(&drawn, &spriteLine[scrX], 8);
+        drawn |= nonZeroBytes(pixels) & ~nonZeroBytes(drawn) & (pixels | attributes * 0x0101010101010101ULL);
+        memcpy(&spriteLine[scrX], &drawn, 8);
+    }
+    return start < end;
+}
+
+template <bool Indexed>
+void Gbc::readLineGb(Frame& frame) {
     // Get relevant parameters from status registers and such:
     const uint8_t lcdCtrl = ioPorts[0x40];
     uint8_t scrY = ioPorts[0x42];
@@ -1740,69 +2254,45 @@ void Gbc::readLineGb(uint32_t* frameBuffer) {
     unsigned int tileMapBase = lcdCtrl & 0x08U ? 0x1c00 : 0x1800;
 
     // More variables
-    unsigned int offset, max;
+    unsigned int offset;
     unsigned int pixX, pixY, tileX, tileY;
-    unsigned int pixelNo = 0;
-    uint32_t* dstPointer;
-    const uint32_t* tileSetPointer;
-
-    // Sprite-specific stuff:
-    unsigned int paletteOffset;
-    unsigned int getPix;
+    unsigned int pixelNo;
+    auto dstPointer = frameLine<Indexed>(frame, lineNo);
 
     // Check if LCD is disabled or all elements (BG, window, sprites) are disabled (write a black row if that's the case):
     if ((lcdCtrl & 0x80U) == 0x00U || (lcdCtrl & 0x23U) == 0x00U) {
-        dstPointer = &frameBuffer[lineNo * 160];
-        for (pixX = 0; pixX < 160; pixX++) {
-            *dstPointer++ = 0x000000ffU;
+        if constexpr (Indexed) {
+            memset(dstPointer, Frame::BLANK_INDEX, 160);
+        } else {
+            for (pixX = 0; pixX < 160; pixX++) {
+                dstPointer[pixX] = 0x000000ffU;
+            }
         }
         return;
     }
 
+    // Indices are into the palettes as they are for this line, OBJ colours following BG ones
+    if constexpr (Indexed) {
+        frame.recordPalettes(lineNo, translatedPaletteBg, 4, translatedPaletteObj, 8, palettesChanged);
+        palettesChanged = false;
+    }
+
     // Draw background if enabled
     if (lcdCtrl & 0x01U) {
-        // Set point to draw to
-        dstPointer = &frameBuffer[160 * lineNo];
-
         // Set starting point of VRAM data to read, in terms of pixel coordinates within the tile, and tile coordinates within the tilemap
         pixX = scrX % 8;
         pixY = (lineNo + scrY) % 8;
         tileX = scrX / 8;
         tileY = ((lineNo + scrY) % 256) / 8;
 
-        // Draw first 20 tiles (including partial leftmost tile)
-        for (offset = 0; offset < 20; offset++) {
-            // Get tile no. and point to the tileset data to read
+        // Gather the 20 tiles across the line, plus the partial 21st if the first is partial too
+        const unsigned int tileCount = pixX > 0 ? 21 : 20;
+        for (offset = 0; offset < tileCount; offset++) {
             unsigned int tileNo = ((unsigned int)vram[tileMapBase + 32 * tileY + tileX] ^ tileSetIndexInverter) + tileSetIndexOffset;
-            tileSetPointer = &tileSet[tileNo * 64 + 8 * pixY + pixX];
-
-            // Draw up to 8 pixels of this tile
-            while (pixX < 8) {
-                uint32_t colourIndex = *tileSetPointer++;
-                *dstPointer++ = translatedPaletteBg[colourIndex];
-                bgColorNumbers[pixelNo++] = colourIndex; // Draw sprites where BG wrote 0 or OBJ has priority
-                pixX++;
-            }
-
-            // Reset pixel counter and get next tile coordinates
-            pixX = 0;
+            lineTiles[offset] = { tileCache.row(tileNo, pixY), translatedPaletteBg, 0, 0 };
             tileX = (tileX + 1) % 32;
         }
-
-        // Draw partial 21st tile. Find out how many pixels of it to draw.
-        max = scrX % 8;
-
-        // Get tile no
-        unsigned int tileNo = ((unsigned int)vram[tileMapBase + 32 * tileY + tileX] ^ tileSetIndexInverter) + tileSetIndexOffset;
-        tileSetPointer = &tileSet[tileNo * 64 + 8 * pixY + pixX];
-
-        // Draw up to 8 pixels of this tile
-        while (pixX < max) {
-            uint32_t colourIndex = *tileSetPointer++;
-            *dstPointer++ = translatedPaletteBg[colourIndex];
-            bgColorNumbers[pixelNo++] = colourIndex; // Draw sprites where BG wrote 0 or OBJ has priority
-            pixX++;
-        }
+        LineKernels::drawTiles(lineTiles, pixX, 160, dstPointer, bgColorNumbers);
     }
 
     // Draw window if enabled and on-screen
@@ -1815,166 +2305,36 @@ void Gbc::readLineGb(uint32_t* frameBuffer) {
             scrX -= 7;
         }
 
-        // Set point to draw to
-        dstPointer = &frameBuffer[160 * lineNo + scrX];
-        unsigned int rowPixel = scrX;
-
         // Set starting point of VRAM data to read, in terms of pixel coordinates within the tile, and tile coordinates within the tilemap
-        pixX = 0;
         pixY = (lineNo - scrY) % 8;
-        tileX = 0;
         tileY = (lineNo - scrY) / 8;
 
-        // Check how many complete tiles to draw
-        max = (160 - scrX) / 8;
-
-        // Draw all the complete tiles until the end of the line
-        for (offset = 0; offset < max; offset++) {
-            // Get tile no
+        // Gather the tiles from the window's left edge to the end of the line, the last of which may be partial
+        const unsigned int pixelCount = 160 - scrX;
+        const unsigned int tileCount = (pixelCount + 7) / 8;
+        for (tileX = 0; tileX < tileCount; tileX++) {
             unsigned int tileNo = ((unsigned int)vram[tileMapBase + 32 * tileY + tileX] ^ tileSetIndexInverter) + tileSetIndexOffset;
-            tileSetPointer = &tileSet[tileNo * 64 + 8 * pixY + pixX];
-
-            // Draw the 8 pixels of this tile
-            while (pixX < 8) {
-                uint32_t colourIndex = *tileSetPointer++;
-                *dstPointer++ = translatedPaletteBg[colourIndex];
-                bgColorNumbers[rowPixel++] = colourIndex; // Draw sprites where BG wrote 0 or OBJ has priority
-                pixX++;
-            }
-
-            // Reset pixel counter and get next tile coordinates
-            pixX = 0;
-            tileX = (tileX + 1) % 32;
-        }
-
-        // Draw partial last tile. Find out how many pixels of it to draw.
-        max = (unsigned int)((168 - scrX) % 8);
-
-        // Get tile no
-        unsigned int tileNo = ((unsigned int)vram[tileMapBase + 32 * tileY + tileX] ^ tileSetIndexInverter) + tileSetIndexOffset;
-        tileSetPointer = &tileSet[tileNo * 64 + 8 * pixY + pixX];
-
-        // Draw up to 8 pixels of this tile
-        while (pixX < max) {
-            uint32_t colourIndex = *tileSetPointer++;
-            *dstPointer++ = translatedPaletteBg[colourIndex];
-            bgColorNumbers[rowPixel++] = colourIndex; // Draw sprites where BG wrote 0 or OBJ has priority
-            pixX++;
+            lineTiles[tileX] = { tileCache.row(tileNo, pixY), translatedPaletteBg, 0, 0 };
         }
+        LineKernels::drawTiles(lineTiles, 0, pixelCount, &dstPointer[scrX], &bgColorNumbers[scrX]);
     }
 
-    // Draw sprites if enabled
-    if (lcdCtrl & 0x02U) {
-        const uint8_t largeSprites = lcdCtrl & 0x04U;
-
-        // Draw each sprite that is visible
-        for (offset = 156; offset < 160; offset -= 4) {
-            // Get coords check if off-screen
-            scrY = oam[offset];
-            if (scrY == 0) {
-                continue;
-            } else if (scrY > 159) {
-                continue;
-            }
-            scrX = oam[offset + 1];
-            if (scrX == 0) {
-                continue;
-            } else if (scrX > 167) {
-                continue;
-            }
-
-            // Check if the current scan line would pass through an 8x16 sprite
-            if (lineNo + 16 < scrY) {
-                continue;
-            } else if (lineNo >= scrY) {
-                continue;
-            }
-            unsigned int tileNo = oam[offset + 2];
-            unsigned int spriteFlags = oam[offset + 3];
-
-            // Check sprite size, and accordingly re-assess visibility and adjust tilemap index
-            if (largeSprites) {
-                if (lineNo + 8 >= scrY) {
-                    tileNo |= 0x01U;
-                } else {
-                    tileNo &= 0xfeU;
-                }
-            } else if (lineNo + 8 >= scrY) {
-                continue;
-            }
-
-            // Get pixel row within tile that will be drawn
-            pixY = (lineNo + 16 - scrY) % 8;
-
-            // Set which palette to draw with
-            paletteOffset = spriteFlags & 0x10U ? 4 : 0;
-
-            // Get first pixel in tile row to draw, plus how many pixels to draw, and adjust the starting point to write to in the image
-            if (scrX < 8) {
-                pixX = 8 - scrX;
-                max = scrX;
-                scrX = 0;
-            } else if (scrX > 160) {
-                pixX = 0;
-                max = 168 - scrX;
-                scrX -= 8;
-            } else {
-                pixX = 0;
-                max = 8;
-                scrX -= 8;
-            }
-
-            // Adjust X if horizontally flipping
-            int tileSetPointerDirection;
-            if (spriteFlags & 0x20U) {
-                pixX = 7 - pixX;
-                tileSetPointerDirection = -1;
+    // Draw sprites if enabled, where BG wrote 0 or OBJ has priority
+    unsigned int spritesStart, spritesEnd;
+    if ((lcdCtrl & 0x02U) && composeSprites<HardwareModel::DMG>(lineNo, lcdCtrl & 0x04U, spritesStart, spritesEnd)) {
+        for (pixelNo = spritesStart; pixelNo < spritesEnd; pixelNo++) {
+            const unsigned int sprite = spriteLine[pixelNo + 8];
+            const bool visible = sprite != 0 && ((sprite & 0x80U) == 0 || bgColorNumbers[pixelNo] == 0);
+            if constexpr (Indexed) {
+                dstPointer[pixelNo] = visible ? (uint8_t)(4 + (sprite & 0x1fU)) : dstPointer[pixelNo];
             } else {
-                tileSetPointerDirection = 1;
-            }
-
-            // Adjust Y if vertically flipping (inverts which of the two tiles to use also)
-            if (spriteFlags & 0x40U) {
-                pixY = 7 - pixY;
-                if (largeSprites) {
-                    tileNo ^= 0x01U;
-                }
-            }
-
-            // Get priority flag
-            unsigned int spriteGivesBgPriority = spriteFlags & 0x80U;
-
-            // Set point to draw to
-            dstPointer = &frameBuffer[160 * lineNo + scrX];
-            pixelNo = scrX;
-
-            // Get pointer to tile data
-            tileSetPointer = &tileSet[tileNo * 64 + 8 * pixY + pixX];
-
-            // Draw up to 8 pixels of this tile (skipping over transparent pixels with palette index 0, or if obscured by the background)
-            pixX = 0;
-            while (pixX < max) {
-                getPix = *tileSetPointer;
-                tileSetPointer += tileSetPointerDirection;
-                if (getPix > 0) {
-                    // Draw sprites where BG wrote 0 or OBJ has priority
-                    if (spriteGivesBgPriority) {
-                        if (bgColorNumbers[pixelNo] == 0) {
-                            *dstPointer = translatedPaletteObj[getPix + paletteOffset];
-                        }
-                    } else {
-                        *dstPointer = translatedPaletteObj[getPix + paletteOffset];
-                    }
-                }
-                dstPointer++;
-                pixX++;
-                pixelNo++;
+                dstPointer[pixelNo] = visible ? translatedPaletteObj[sprite & 0x1fU] : dstPointer[pixelNo];
             }
         }
     }
 }
 
-void Gbc::readLineSgb(uint32_t * frameBuffer) {
+void Gbc::readLineSgb() {
     // Get relevant parameters from status registers and such:
     const uint8_t lcdCtrl = ioPorts[0x40];
     uint8_t scrY = ioPorts[0x42];
@@ -1985,55 +2345,26 @@ void Gbc::readLineSgb(uint32_t * frameBuffer) {
     unsigned int tileMapBase = lcdCtrl & 0x08U ? 0x1c00U : 0x1800U;
 
     // More variables
-    unsigned int offset, max;
+    unsigned int offset;
     unsigned int pixX, pixY, tileX, tileY;
     uint32_t* dstPointer;
-    const uint32_t* tileSetPointer;
-
-    // Sprite-specific stuff:
-    unsigned int paletteOffset;
-    unsigned int getPix;
 
     // Draw background if enabled
     if (lcdCtrl & 0x01U) {
-        // Set point to draw to
-        dstPointer = &sgb.monoData[160 * lineNo];
-
         // Set starting point of VRAM data to read, in terms of pixel coordinates within the tile, and tile coordinates within the tilemap
         pixX = scrX % 8;
         pixY = (lineNo + scrY) % 8;
         tileX = scrX / 8;
         tileY = ((lineNo + scrY) % 256) / 8;
 
-        // Draw first 20 tiles (including partial leftmost tile)
-        for (offset = 0; offset < 20; offset++) {
-            // Get tile no. and point to the tileset data to read
+        // Gather the 20 tiles across the line, plus the partial 21st if the first is partial too
+        const unsigned int tileCount = pixX > 0 ? 21 : 20;
+        for (offset = 0; offset < tileCount; offset++) {
             unsigned int tileNo = ((unsigned int)vram[tileMapBase + 32 * tileY + tileX] ^ tileSetIndexInverter) + tileSetIndexOffset;
-            tileSetPointer = &tileSet[tileNo * 64 + 8 * pixY + pixX];
-
-            // Draw up to 8 pixels of this tile
-            while (pixX < 8) {
-                *dstPointer++ = sgbPaletteTranslationBg[*tileSetPointer++];
-                pixX++;
-            }
-
-            // Reset pixel counter and get next tile coordinates
-            pixX = 0;
+            lineTiles[offset] = { tileCache.row(tileNo, pixY), sgbPaletteTranslationBg, 0, 0 };
             tileX = (tileX + 1) % 32;
         }
-
-        // Draw partial 21st tile. Find out how many pixels of it to draw.
-        max = scrX % 8;
-
-        // Get tile no
-        unsigned int tileNo = ((unsigned int)vram[tileMapBase + 32 * tileY + tileX] ^ tileSetIndexInverter) + tileSetIndexOffset;
-        tileSetPointer = &tileSet[tileNo * 64 + 8 * pixY + pixX];
-
-        // Draw up to 8 pixels of this tile
-        while (pixX < max) {
-            *dstPointer++ = sgbPaletteTranslationBg[*tileSetPointer++];
-            pixX++;
-        }
+        LineKernels::drawTiles(lineTiles, pixX, 160, &sgb.monoData[160 * lineNo], bgColorNumbers);
     }
 
     // Draw window if enabled and on-screen
@@ -2046,160 +2377,34 @@ void Gbc::readLineSgb(uint32_t * frameBuffer) {
             scrX -= 7;
         }
 
-        // Set point to draw to
-        dstPointer = &sgb.monoData[160 * lineNo + scrX];
-
         // Set starting point of VRAM data to read, in terms of pixel coordinates within the tile, and tile coordinates within the tilemap
-        pixX = 0;
         pixY = (lineNo - scrY) % 8;
-        tileX = 0;
         tileY = (lineNo - scrY) / 8;
 
-        // Check how many complete tiles to draw
-        max = (160 - scrX) / 8;
-
-        // Draw all the complete tiles until the end of the line
-        for (offset = 0; offset < max; offset++) {
-            // Get tile no
+        // Gather the tiles from the window's left edge to the end of the line, the last of which may be partial
+        const unsigned int pixelCount = 160 - scrX;
+        const unsigned int tileCount = (pixelCount + 7) / 8;
+        for (tileX = 0; tileX < tileCount; tileX++) {
             unsigned int tileNo = ((unsigned int)vram[tileMapBase + 32 * tileY + tileX] ^ tileSetIndexInverter) + tileSetIndexOffset;
-            tileSetPointer = &tileSet[tileNo * 64 + 8 * pixY + pixX];
-
-            // Draw the 8 pixels of this tile
-            while (pixX < 8) {
-                *dstPointer++ = sgbPaletteTranslationBg[*tileSetPointer++];
-                pixX++;
-            }
-
-            // Reset pixel counter and get next tile coordinates
-            pixX = 0;
-            tileX = (tileX + 1) % 32;
-
-        }
-
-        // Draw partial last tile. Find out how many pixels of it to draw.
-        max = (unsigned int)((168 - scrX) % 8);
-
-        // Get tile no
-        unsigned int tileNo = ((unsigned int)vram[tileMapBase + 32 * tileY + tileX] ^ tileSetIndexInverter) + tileSetIndexOffset;
-        tileSetPointer = &tileSet[tileNo * 64 + 8 * pixY + pixX];
-
-        // Draw up to 8 pixels of this tile
-        while (pixX < max) {
-            *dstPointer++ = sgbPaletteTranslationBg[*tileSetPointer++];
-            pixX++;
+            lineTiles[tileX] = { tileCache.row(tileNo, pixY), sgbPaletteTranslationBg, 0, 0 };
         }
+        LineKernels::drawTiles(lineTiles, 0, pixelCount, &sgb.monoData[160 * lineNo + scrX], &bgColorNumbers[scrX]);
     }
 
-    // Draw sprites if enabled
-    if (lcdCtrl & 0x02U) {
-        const uint8_t largeSprites = lcdCtrl & 0x04U;
-
-        // Draw each sprite that is visible
-        for (offset = 156; offset < 160; offset -= 4) {
-            // Get coords check if off-screen
-            scrY = oam[offset];
-            if (scrY == 0) {
-                continue;
-            } else if (scrY > 159) {
-                continue;
-            }
-            scrX = oam[offset + 1];
-            if (scrX == 0) {
-                continue;
-            } else if (scrX > 167) {
-                continue;
-            }
-
-            // Check if the current scan line would pass through an 8x16 sprite
-            if (lineNo + 16 < scrY) {
-                continue;
-            } else if (lineNo >= scrY) {
-                continue;
-            }
-            unsigned int tileNo = oam[offset + 2];
-            unsigned int spriteFlags = oam[offset + 3];
-
-            // Check sprite size, and accordingly re-assess visibility and adjust tilemap index
-            if (largeSprites) {
-                if (lineNo + 8 >= scrY) {
-                    tileNo |= 0x01U;
-                } else {
-                    tileNo &= 0xfeU;
-                }
-            } else if (lineNo + 8 >= scrY) {
-                continue;
-            }
-
-            // Get pixel row within tile that will be drawn
-            pixY = (lineNo + 16 - scrY) % 8;
-
-            // Set which palette to draw with
-            paletteOffset = spriteFlags & 0x10U ? 4 : 0;
-            uint32_t colourZero = translatedPaletteBg[0];
-
-            // Get first pixel in tile row to draw, plus how many pixels to draw, and adjust the starting point to write to in the image
-            if (scrX < 8) {
-                pixX = 8 - scrX;
-                max = scrX;
-                scrX = 0;
-            } else if (scrX > 160) {
-                pixX = 0;
-                max = 168 - scrX;
-                scrX -= 8;
-            } else {
-                pixX = 0;
-                max = 8;
-                scrX -= 8;
-            }
-
-            // Adjust X if horizontally flipping
-            int tileSetPointerDirection;
-            if (spriteFlags & 0x20U) {
-                pixX = 7 - pixX;
-                tileSetPointerDirection = -1;
-            } else {
-                tileSetPointerDirection = 1;
-            }
-
-            // Adjust Y if vertically flipping (inverts which of the two tiles to use also)
-            if (spriteFlags & 0x40U) {
-                pixY = 7 - pixY;
-                if (largeSprites) {
-                    tileNo ^= 0x01U;
-                }
-            }
-
-            // Get priority flag
-            unsigned int spriteGivesBgPriority = spriteFlags & 0x80U;
-
-            // Set point to draw to
-            dstPointer = &sgb.monoData[160 * lineNo + scrX];
-
-            // Get pointer to tile data
-            tileSetPointer = &tileSet[tileNo * 64 + 8 * pixY + pixX];
-
-            // Draw up to 8 pixels of this tile (skipping over transparent pixels with palette index 0, or if obscured by the background)
-            pixX = 0;
-            while (pixX < max) {
-                getPix = *tileSetPointer;
-                tileSetPointer += tileSetPointerDirection;
-                if (getPix > 0) {
-                    if (spriteGivesBgPriority) {
-                        if (*dstPointer == colourZero) {
-                            *dstPointer = sgbPaletteTranslationObj[getPix + paletteOffset];
-                        }
-                    } else {
-                        *dstPointer = sgbPaletteTranslationObj[getPix + paletteOffset];
-                    }
-                }
-                dstPointer++;
-                pixX++;
-            }
+    // Draw sprites if enabled, where BG wrote 0 or OBJ has priority
+    unsigned int spritesStart, spritesEnd;
+    if ((lcdCtrl & 0x02U) && composeSprites<HardwareModel::SGB>(lineNo, lcdCtrl & 0x04U, spritesStart, spritesEnd)) {
+        dstPointer = &sgb.monoData[160 * lineNo];
+        for (unsigned int pixelNo = spritesStart; pixelNo < spritesEnd; pixelNo++) {
+            const unsigned int sprite = spriteLine[pixelNo + 8];
+            const bool visible = sprite != 0 && ((sprite & 0x80U) == 0 || bgColorNumbers[pixelNo] == 0);
+            dstPointer[pixelNo] = visible ? sgbPaletteTranslationObj[sprite & 0x1fU] : dstPointer[pixelNo];
         }
     }
 }
 
-void Gbc::readLineCgb(uint32_t * frameBuffer) {
+template <bool Indexed>
+void Gbc::readLineCgb(Frame& frame) {
     // Get relevant parameters from status registers and such:
     const uint8_t lcdCtrl = ioPorts[0x40];
     uint8_t scrY = ioPorts[0x42];
@@ -2210,39 +2415,40 @@ void Gbc::readLineCgb(uint32_t * frameBuffer) {
     unsigned int tileMapBase = lcdCtrl & 0x08U ? 0x1c00U : 0x1800U;
 
     // More variables
-    unsigned int offset, max;
+    unsigned int offset;
     unsigned int pixX, pixY, tileX, tileY;
-    unsigned int pixelNo = 0;
-    uint32_t* dstPointer;
-    const uint32_t* tileSetPointer;
-
-    // Sprite-specific stuff:
-    unsigned int paletteOffset;
-    unsigned int getPix;
+    unsigned int pixelNo;
+    auto dstPointer = frameLine<Indexed>(frame, lineNo);
 
     // Check if LCD is disabled or all elements (BG, window, sprites) are disabled (write a black row if that's the case):
     if ((lcdCtrl & 0x80U) == 0x00U || (lcdCtrl & 0x23U) == 0x00U) {
-        dstPointer = &frameBuffer[lineNo * 160];
-        for (pixX = 0; pixX < 160; pixX++) {
-            *dstPointer++ = 0x000000ffU;
+        if constexpr (Indexed) {
+            memset(dstPointer, Frame::BLANK_INDEX, 160);
+        } else {
+            for (pixX = 0; pixX < 160; pixX++) {
+                dstPointer[pixX] = 0x000000ffU;
+            }
         }
         return;
     }
 
+    // Indices are into the palettes as they are for this line, OBJ colours following BG ones
+    if constexpr (Indexed) {
+        frame.recordPalettes(lineNo, cgbBgPalette, 32, cgbObjPalette, 32, palettesChanged);
+        palettesChanged = false;
+    }
+
     // Draw background if enabled
     if (lcdCtrl & 0x01U) {
-        // Set point to draw to
-        dstPointer = &frameBuffer[160 * lineNo];
-
         // Set starting point of VRAM data to read, in terms of pixel coordinates within the tile, and tile coordinates within the tilemap
         pixX = scrX % 8;
         pixY = (lineNo + scrY) % 8;
         tileX = scrX / 8;
         tileY = ((lineNo + scrY) % 256) / 8;
 
-        // Draw first 20 tiles (including partial leftmost tile)
-        for (offset = 0; offset < 20; offset++) {
-            // Get tile no. and point to the tileset data to read
+        // Gather the 20 tiles across the line, plus the partial 21st if the first is partial too
+        const unsigned int tileCount = pixX > 0 ? 21 : 20;
+        for (offset = 0; offset < tileCount; offset++) {
             unsigned int tileMapIndex = tileMapBase + 32 * tileY + tileX;
             unsigned int tileNo = ((unsigned int)vram[tileMapIndex] ^ tileSetIndexInverter) + tileSetIndexOffset;
             unsigned int tileParams = vram[0x2000U + tileMapIndex];
@@ -2252,110 +2458,36 @@ void Gbc::readLineCgb(uint32_t * frameBuffer) {
                 tileNo += 0x0180U;
             }
 
-            // Set a sprite-blocking bit as bit 2 if the BG priority bit is set in the tile map
-            uint32_t bgPriorityBit = (tileParams & 0x80U) >> 5U;
-
-            // Set which palette to draw with
-            paletteOffset = 4 * (tileParams & 0x07U);
-
-            // Draw up to 8 pixels of this tile
-            if (tileParams & 0x0020U) {
-                // Flipped horizontally
-                unsigned int drawnX = 7 - pixX;
-                tileSetPointer = &tileSet[tileNo * 64 + 8 * adjustedY + drawnX];
-                while (pixX < 8) {
-                    uint32_t colourIndex = *tileSetPointer--;
-                    *dstPointer++ = cgbBgPalette[paletteOffset + colourIndex];
-                    bgColorNumbers[pixelNo] = colourIndex;
-                    bgDisplayPriorities[pixelNo++] = bgPriorityBit;
-                    pixX++;
-                }
-            } else {
-                tileSetPointer = &tileSet[tileNo * 64 + 8 * adjustedY + pixX];
-                while (pixX < 8) {
-                    uint32_t colourIndex = *tileSetPointer++;
-                    *dstPointer++ = cgbBgPalette[paletteOffset + colourIndex];
-                    bgColorNumbers[pixelNo] = colourIndex;
-                    bgDisplayPriorities[pixelNo++] = bgPriorityBit;
-                    pixX++;
-                }
-            }
-
-            // Reset pixel counter and get next tile coordinates
-            pixX = 0;
+            // Flip horizontally if set, pick one of the 8 palettes, and set a sprite-blocking bit as bit 2 if the BG
+            // priority bit is set in the tile map
+            lineTiles[offset] = {
+                    tileParams & 0x0020U ? tileCache.flippedRow(tileNo, adjustedY) : tileCache.row(tileNo, adjustedY),
+                    &cgbBgPalette[4 * (tileParams & 0x07U)],
+                    (uint8_t)(4 * (tileParams & 0x07U)),
+                    (uint8_t)((tileParams & 0x80U) >> 5U) };
             tileX = (tileX + 1) % 32;
         }
-
-        // Draw partial 21st tile. Find out how many pixels of it to draw.
-        max = scrX % 8;
-
-        // Get tile no
-        unsigned int tileMapIndex = tileMapBase + 32 * tileY + tileX;
-        unsigned int tileNo = ((unsigned int)vram[tileMapIndex] ^ tileSetIndexInverter) + tileSetIndexOffset;
-        unsigned int tileParams = vram[0x2000U + tileMapIndex];
-        unsigned int adjustedY = tileParams & 0x0040U ? 7 - pixY : pixY;
-        if (tileParams & 0x0008U) {
-            // Using bank 1
-            tileNo += 0x0180U;
-        }
-        tileSetPointer = &tileSet[tileNo * 64 + 8 * adjustedY + pixX];
-
-        // Set a sprite-blocking bit as bit 2 if the BG priority bit is set in the tile map
-        uint32_t bgPriorityBit = (tileParams & 0x80U) >> 5U;
-
-        // Set which palette to draw with
-        paletteOffset = 4 * (tileParams & 0x07U);
-
-        // Draw up to 8 pixels of this tile
-        if (tileParams & 0x0020U) {
-            // Flipped horizontally
-            unsigned int drawnX = 7 - pixX;
-            tileSetPointer = &tileSet[tileNo * 64 + 8 * adjustedY + drawnX];
-            while (pixX < max) {
-                uint32_t colourIndex = *tileSetPointer--;
-                *dstPointer++ = cgbBgPalette[paletteOffset + colourIndex];
-                bgColorNumbers[pixelNo] = colourIndex;
-                bgDisplayPriorities[pixelNo++] = bgPriorityBit;
-                pixX++;
-            }
-        } else {
-            while (pixX < max) {
-                uint32_t colourIndex = *tileSetPointer++;
-                *dstPointer++ = cgbBgPalette[paletteOffset + colourIndex];
-                bgColorNumbers[pixelNo] = colourIndex;
-                bgDisplayPriorities[pixelNo++] = bgPriorityBit;
-                pixX++;
-            }
-        }
+        LineKernels::drawTiles(lineTiles, pixX, 160, dstPointer, bgColorNumbers);
     }
 
     // Draw window if enabled and on-screen
     scrX = ioPorts[0x4b];
     scrY = ioPorts[0x4a];
     tileMapBase = lcdCtrl & 0x40U ? 0x1c00U : 0x1800U;
-    pixelNo = 0;
     if (((lcdCtrl & 0x20U) != 0x00U) && (scrX < 167) && (scrY <= lineNo)) {
         // Subtract 7 from window X pos
         if (scrX > 6) {
             scrX -= 7;
         }
 
-        // Set point to draw to
-        dstPointer = &frameBuffer[160 * lineNo + scrX];
-        unsigned int rowPixel = scrX;
-
         // Set starting point of VRAM data to read, in terms of pixel coordinates within the tile, and tile coordinates within the tilemap
-        pixX = 0;
         pixY = (lineNo - scrY) % 8;
-        tileX = 0;
         tileY = (lineNo - scrY) / 8;
 
-        // Check how many complete tiles to draw
-        max = (160 - scrX) / 8;
-
-        // Draw all the complete tiles until the end of the line
-        for (offset = 0; offset < max; offset++) {
-            // Get tile no
+        // Gather the tiles from the window's left edge to the end of the line, the last of which may be partial
+        const unsigned int pixelCount = 160 - scrX;
+        const unsigned int tileCount = (pixelCount + 7) / 8;
+        for (tileX = 0; tileX < tileCount; tileX++) {
             unsigned int tileMapIndex = tileMapBase + 32 * tileY + tileX;
             unsigned int tileNo = ((unsigned int)vram[tileMapIndex] ^ tileSetIndexInverter) + tileSetIndexOffset;
             unsigned int tileParams = vram[0x2000U + tileMapIndex];
@@ -2365,199 +2497,38 @@ void Gbc::readLineCgb(uint32_t * frameBuffer) {
                 tileNo += 0x0180U;
             }
 
-            // Set a sprite-blocking bit as bit 2 if the BG priority bit is set in the tile map
-            uint32_t bgPriorityBit = (tileParams & 0x80U) >> 5U;
-
-            // Set which palette to draw with
-            paletteOffset = 4 * (tileParams & 0x07U);
-
-            // Draw the 8 pixels of this tile
-            if (tileParams & 0x0020U) {
-                // Flipped horizontally
-                unsigned int drawnX = 7 - pixX;
-                tileSetPointer = &tileSet[tileNo * 64 + 8 * adjustedY + drawnX];
-                while (pixX < 8) {
-                    uint32_t colourIndex = *tileSetPointer--;
-                    *dstPointer++ = cgbBgPalette[paletteOffset + colourIndex];
-                    bgColorNumbers[pixelNo++] = colourIndex;
-                    bgDisplayPriorities[rowPixel++] = bgPriorityBit;
-                    pixX++;
-                }
-            } else {
-                tileSetPointer = &tileSet[tileNo * 64 + 8 * adjustedY + pixX];
-                while (pixX < 8) {
-                    uint32_t colourIndex = *tileSetPointer++;
-                    *dstPointer++ = cgbBgPalette[paletteOffset + colourIndex];
-                    bgColorNumbers[pixelNo++] = colourIndex;
-                    bgDisplayPriorities[rowPixel++] = bgPriorityBit;
-                    pixX++;
-                }
-            }
-
-            // Reset pixel counter and get next tile coordinates
-            pixX = 0;
-            tileX = (tileX + 1) % 32;
-        }
-
-        // Draw partial last tile. Find out how many pixels of it to draw.
-        max = (unsigned int)((168 - scrX) % 8);
-
-        // Get tile no
-        unsigned int tileMapIndex = tileMapBase + 32 * tileY + tileX;
-        unsigned int tileNo = ((unsigned int)vram[tileMapIndex] ^ tileSetIndexInverter) + tileSetIndexOffset;
-        unsigned int tileParams = vram[0x2000U + tileMapIndex];
-        unsigned int adjustedY = tileParams & 0x0040U ? 7 - pixY : pixY;
-        if (tileParams & 0x0008U) {
-            // Using bank 1
-            tileNo += 0x0180U;
-        }
-        tileSetPointer = &tileSet[tileNo * 64 + 8 * adjustedY + pixX];
-
-        // Set a sprite-blocking bit as bit 2 if the BG priority bit is set in the tile map
-        uint32_t bgPriorityBit = (tileParams & 0x80U) >> 5U;
-
-        // Set which palette to draw with
-        paletteOffset = 4 * (tileParams & 0x07U);
-
-        // Draw up to 8 pixels of this tile
-        if (tileParams & 0x0020U) {
-            // Flipped horizontally
-            unsigned int drawnX = 7 - pixX;
-            tileSetPointer = &tileSet[tileNo * 64 + 8 * adjustedY + drawnX];
-            while (pixX < max) {
-                uint32_t colourIndex = *tileSetPointer--;
-                *dstPointer++ = cgbBgPalette[paletteOffset + colourIndex];
-                bgColorNumbers[pixelNo++] = colourIndex;
-                bgDisplayPriorities[rowPixel++] = bgPriorityBit;
-                pixX++;
-            }
-        } else {
-            while (pixX < max) {
-                uint32_t colourIndex = *tileSetPointer++;
-                *dstPointer++ = cgbBgPalette[paletteOffset + colourIndex];
-                bgColorNumbers[pixelNo++] = colourIndex;
-                bgDisplayPriorities[rowPixel++] = bgPriorityBit;
-                pixX++;
-            }
+            // Flip horizontally if set, pick one of the 8 palettes, and set a sprite-blocking bit as bit 2 if the BG
+            // priority bit is set in the tile map
+            lineTiles[tileX] = {
+                    tileParams & 0x0020U ? tileCache.flippedRow(tileNo, adjustedY) : tileCache.row(tileNo, adjustedY),
+                    &cgbBgPalette[4 * (tileParams & 0x07U)],
+                    (uint8_t)(4 * (tileParams & 0x07U)),
+                    (uint8_t)((tileParams & 0x80U) >> 5U) };
         }
+        LineKernels::drawTiles(lineTiles, 0, pixelCount, &dstPointer[scrX], &bgColorNumbers[scrX]);
     }
 
-    // Draw sprites if enabled
-    if (lcdCtrl & 0x02U) {
-        const uint8_t largeSprites = lcdCtrl & 0x04U;
-
-        // Draw each sprite that is visible
-        for (offset = 156; offset < 160; offset -= 4) {
-            // Get coords check if off-screen
-            scrY = oam[offset];
-            if (scrY == 0) {
-                continue;
-            } else if (scrY > 159) {
-                continue;
-            }
-            scrX = oam[offset + 1];
-            if (scrX == 0) {
-                continue;
-            } else if (scrX > 167) {
-                continue;
-            }
-
-            // Check if the current scan line would pass through an 8x16 sprite
-            if (lineNo + 16 < scrY) {
-                continue;
-            } else if (lineNo >= scrY) {
-                continue;
-            }
-            unsigned int tileNo = oam[offset + 2];
-            unsigned int spriteFlags = oam[offset + 3];
-
-            // Check sprite size, and accordingly re-assess visibility and adjust tilemap index
-            if (largeSprites) {
-                if (lineNo + 8 >= scrY) {
-                    tileNo |= 0x01U;
-                } else {
-                    tileNo &= 0xfeU;
-                }
-            } else if (lineNo + 8 >= scrY) {
-                continue;
-            }
-            if (spriteFlags & 0x08U) {
-                tileNo += 384;
-            }
-
-            // Get pixel row within tile that will be drawn
-            pixY = (lineNo + 16 - scrY) % 8;
-
-            // Set which palette to draw with
-            paletteOffset = 4 * (spriteFlags & 0x07U);
-
-            // Get first pixel in tile row to draw, plus how many pixels to draw, and adjust the starting point to write to in the image
-            if (scrX < 8) {
-                pixX = 8 - scrX;
-                max = scrX;
-                scrX = 0;
-            } else if (scrX > 160) {
-                pixX = 0;
-                max = 168 - scrX;
-                scrX -= 8;
+    // Draw sprites if enabled, where BG wrote zero or neither BG nor sprite flags gave the BG priority
+    unsigned int spritesStart, spritesEnd;
+    if ((lcdCtrl & 0x02U) && composeSprites<HardwareModel::CGB>(lineNo, lcdCtrl & 0x04U, spritesStart, spritesEnd)) {
+        for (pixelNo = spritesStart; pixelNo < spritesEnd; pixelNo++) {
+            const unsigned int sprite = spriteLine[pixelNo + 8];
+            const unsigned int bgColor = bgColorNumbers[pixelNo] & 0x03U;
+            const unsigned int bgTakesPriority = bgColorNumbers[pixelNo] & 0x04U;
+            const bool visible = sprite != 0 && (bgColor == 0 || (bgTakesPriority == 0 && (sprite & 0x80U) == 0));
+            if constexpr (Indexed) {
+                dstPointer[pixelNo] = visible ? (uint8_t)(32 + (sprite & 0x1fU)) : dstPointer[pixelNo];
             } else {
-                pixX = 0;
-                max = 8;
-                scrX -= 8;
-            }
-
-            // Adjust X if horizontally flipping
-            int tileSetPointerDirection;
-            if (spriteFlags & 0x20U) {
-                pixX = 7 - pixX;
-                tileSetPointerDirection = -1;
-            } else {
-                tileSetPointerDirection = 1;
-            }
-
-            // Adjust Y if vertically flipping (inverts which of the two tiles to use also)
-            if (spriteFlags & 0x40U) {
-                pixY = 7 - pixY;
-                if (largeSprites) {
-                    tileNo ^= 0x01U;
-                }
-            }
-
-            // Get priority flag
-            unsigned int spriteGivesBgPriority = spriteFlags & 0x80U;
-
-            // Set point to draw to
-            dstPointer = &frameBuffer[160 * lineNo + scrX];
-            pixelNo = scrX;
-
-            // Get pointer to tile data
-            tileSetPointer = &tileSet[tileNo * 64 + 8 * pixY + pixX];
-
-            // Draw up to 8 pixels of this tile (skipping over transparent pixels with palette index 0, or if obscured by the background)
-            pixX = 0;
-            while (pixX < max) {
-                getPix = *tileSetPointer;
-                tileSetPointer += tileSetPointerDirection;
-                if (getPix > 0) {
-                    uint32_t bgColor = bgColorNumbers[pixelNo];
-                    uint32_t bgTakesPriority = bgDisplayPriorities[pixelNo];
-                    // Draw sprites where BG wrote zero or neither BG nor sprite flags gave the BG priority
-                    if (bgTakesPriority || spriteGivesBgPriority) {
-                        if (bgColor == 0) {
-                            *dstPointer = cgbObjPalette[getPix + paletteOffset];
-                        }
-                    } else {
-                        *dstPointer = cgbObjPalette[getPix + paletteOffset];
-                    }
-                }
-                dstPointer++;
-                pixX++;
-                pixelNo++;
+                dstPointer[pixelNo] = visible ? cgbObjPalette[sprite & 0x1fU] : dstPointer[pixelNo];
             }
         }
     }
 }
 
+// Also drawn from outside this file by GbcBenchAccess, to compare the line kernels
+template void Gbc::readLineGb<false>(Frame& frame);
+template void Gbc::readLineCgb<false>(Frame& frame);
+
 
 
 
@@ -2572,15 +2543,15 @@ void Gbc::readLineCgb(uint32_t * frameBuffer) {
 
 
 inline unsigned int Gbc::HL() {
-    return ((unsigned int)cpuH << 8U) + (unsigned int)cpuL;
+    return cpuHL.word;
 }
 
 inline uint8_t Gbc::R8_HL() {
-    return read8(((unsigned int)cpuH << 8U) + (unsigned int)cpuL);
+    return read8(cpuHL.word);
 }
 
 inline void Gbc::W8_HL(uint8_t byte) {
-    write8(((unsigned int)cpuH << 8U) + (unsigned int)cpuL, byte);
+    write8(cpuHL.word, byte);
 }
 
 inline void Gbc::SETZ_ON_ZERO(uint8_t testValue) {
@@ -2620,38 +2591,35 @@ int Gbc::performOp() {
             cpuPc++;
             return 4;
         case 0x01: // ld BC, nn
-            cpuB = read8(cpuPc + 2);
-            cpuC = read8(cpuPc + 1);
+            cpuBC.high = read8(cpuPc + 2);
+            cpuBC.low = read8(cpuPc + 1);
             cpuPc += 3;
             return 12;
         case 0x02: // ld (BC), A
-            write8(((unsigned int)cpuB << 8U) + (unsigned int)cpuC, cpuA);
+            write8(cpuBC.word, cpuA);
             cpuPc++;
             return 8;
         case 0x03: // inc BC
-            cpuC++;
-            if (cpuC == 0x00) {
-                cpuB++;
-            }
+            cpuBC.word++;
             cpuPc++;
             return 8;
         case 0x04: // inc B
             cpuF &= 0x10U;
-            cpuB += 0x01U;
-            SETZ_ON_ZERO(cpuB);
-            SETH_ON_ZERO(cpuB & 0x0fU);
+            cpuBC.high += 0x01U;
+            SETZ_ON_ZERO(cpuBC.high);
+            SETH_ON_ZERO(cpuBC.high & 0x0fU);
             cpuPc++;
             return 4;
         case 0x05: // dec B
             cpuF &= 0x10U;
             cpuF |= 0x40U;
-            SETH_ON_ZERO(cpuB & 0x0fU);
-            cpuB -= 0x01U;
-            SETZ_ON_ZERO(cpuB);
+            SETH_ON_ZERO(cpuBC.high & 0x0fU);
+            cpuBC.high -= 0x01U;
+            SETZ_ON_ZERO(cpuBC.high);
             cpuPc++;
             return 4;
         case 0x06: // ld B, n
-            cpuB = read8(cpuPc + 1);
+            cpuBC.high = read8(cpuPc + 1);
             cpuPc += 2;
             return 8;
         case 0x07: // rlc A (rotate bit 7 to bit 0, and copy bit 7 to carry flag)
@@ -2676,47 +2644,36 @@ int Gbc::performOp() {
             return 20;
         case 0x09: // add HL, BC
             cpuF &= 0x80U;
-            cpuL += cpuC;
-            if (cpuL < cpuC)
-            {
-                cpuH++;
-                SETC_ON_COND(cpuH == 0x00);
-                SETH_ON_ZERO(cpuH & 0x0fU);
-            }
-            cpuH += cpuB;
-            SETC_ON_COND(cpuH < cpuB);
-            SETH_ON_COND((cpuH & 0x0fU) < (cpuB & 0x0fU));
+            SETH_ON_COND((cpuHL.word & 0x0fffU) + (cpuBC.word & 0x0fffU) > 0x0fffU);
+            SETC_ON_COND((unsigned int)cpuHL.word + cpuBC.word > 0xffffU);
+            cpuHL.word += cpuBC.word;
             cpuPc++;
             return 8;
         case 0x0a: // ld A, (BC)
-            cpuA = read8(((unsigned int)cpuB << 8U) + (unsigned int)cpuC);
+            cpuA = read8(cpuBC.word);
             cpuPc++;
             return 8;
         case 0x0b: // dec BC
-            if (cpuC == 0x00)
-            {
-                cpuB--;
-            }
-            cpuC--;
+            cpuBC.word--;
             cpuPc++;
             return 8;
         case 0x0c: // inc C
             cpuF &= 0x10U;
-            cpuC += 0x01U;
-            SETZ_ON_ZERO(cpuC);
-            SETH_ON_ZERO(cpuC & 0x0fU);
+            cpuBC.low += 0x01U;
+            SETZ_ON_ZERO(cpuBC.low);
+            SETH_ON_ZERO(cpuBC.low & 0x0fU);
             cpuPc++;
             return 4;
         case 0x0d: // dec C
             cpuF &= 0x10U;
             cpuF |= 0x40U;
-            SETH_ON_ZERO(cpuC & 0x0fU);
-            cpuC -= 0x01U;
-            SETZ_ON_ZERO(cpuC);
+            SETH_ON_ZERO(cpuBC.low & 0x0fU);
+            cpuBC.low -= 0x01U;
+            SETZ_ON_ZERO(cpuBC.low);
             cpuPc++;
             return 4;
         case 0x0e: // ld C, n
-            cpuC = read8(cpuPc + 1);
+            cpuBC.low = read8(cpuPc + 1);
             cpuPc += 2;
             return 8;
         case 0x0f: // rrc A (8-bit rotation right - bit 0 is moved to carry also)
@@ -2737,38 +2694,35 @@ int Gbc::performOp() {
             cpuPc++;
             return 4;
         case 0x11: // ld DE, nn
-            cpuD = read8(cpuPc + 2);
-            cpuE = read8(cpuPc + 1);
+            cpuDE.high = read8(cpuPc + 2);
+            cpuDE.low = read8(cpuPc + 1);
             cpuPc += 3;
             return 12;
         case 0x12: // ld (DE), A
-            write8(((unsigned int)cpuD << 8U) + (unsigned int)cpuE, cpuA);
+            write8(cpuDE.word, cpuA);
             cpuPc++;
             return 8;
         case 0x13: // inc DE
-            cpuE++;
-            if (cpuE == 0x00) {
-                cpuD++;
-            }
+            cpuDE.word++;
             cpuPc++;
             return 8;
         case 0x14: // inc D
             cpuF &= 0x10U;
-            cpuD += 0x01U;
-            SETZ_ON_ZERO(cpuD);
-            SETH_ON_ZERO(cpuD & 0x0fU);
+            cpuDE.high += 0x01U;
+            SETZ_ON_ZERO(cpuDE.high);
+            SETH_ON_ZERO(cpuDE.high & 0x0fU);
             cpuPc++;
             return 4;
         case 0x15: // dec D
             cpuF &= 0x10U;
             cpuF |= 0x40U;
-            SETH_ON_ZERO(cpuD & 0x0fU);
-            cpuD -= 0x01U;
-            SETZ_ON_ZERO(cpuD);
+            SETH_ON_ZERO(cpuDE.high & 0x0fU);
+            cpuDE.high -= 0x01U;
+            SETZ_ON_ZERO(cpuDE.high);
             cpuPc++;
             return 4;
         case 0x16: // ld D, n
-            cpuD = read8(cpuPc + 1);
+            cpuDE.high = read8(cpuPc + 1);
             cpuPc += 2;
             return 8;
         case 0x17: // rl A (rotate carry bit to bit 0 of A)
@@ -2800,47 +2754,36 @@ int Gbc::performOp() {
             return 12;
         case 0x19: // add HL, DE
             cpuF &= 0x80U;
-            cpuL += cpuE;
-            if (cpuL < cpuE)
-            {
-                cpuH++;
-                SETC_ON_COND(cpuH == 0x00);
-                SETH_ON_ZERO(cpuH & 0x0fU);
-            }
-            cpuH += cpuD;
-            SETC_ON_COND(cpuH < cpuD);
-            SETH_ON_COND((cpuH & 0x0fU) < (cpuD & 0x0fU));
+            SETH_ON_COND((cpuHL.word & 0x0fffU) + (cpuDE.word & 0x0fffU) > 0x0fffU);
+            SETC_ON_COND((unsigned int)cpuHL.word + cpuDE.word > 0xffffU);
+            cpuHL.word += cpuDE.word;
             cpuPc++;
             return 8;
         case 0x1a: // ld A, (DE)
-            cpuA = read8(((unsigned int)cpuD << 8U) + (unsigned int)cpuE);
+            cpuA = read8(cpuDE.word);
             cpuPc++;
             return 8;
         case 0x1b: // dec DE
-            if (cpuE == 0x00)
-            {
-                cpuD--;
-            }
-            cpuE--;
+            cpuDE.word--;
             cpuPc++;
             return 8;
         case 0x1c: // inc E
             cpuF &= 0x10U;
-            cpuE += 0x01U;
-            SETZ_ON_ZERO(cpuE);
-            SETH_ON_ZERO(cpuE & 0x0fU);
+            cpuDE.low += 0x01U;
+            SETZ_ON_ZERO(cpuDE.low);
+            SETH_ON_ZERO(cpuDE.low & 0x0fU);
             cpuPc++;
             return 4;
         case 0x1d: // dec E
             cpuF &= 0x10U;
             cpuF |= 0x40U;
-            SETH_ON_ZERO(cpuE & 0x0fU);
-            cpuE -= 0x01U;
-            SETZ_ON_ZERO(cpuE);
+            SETH_ON_ZERO(cpuDE.low & 0x0fU);
+            cpuDE.low -= 0x01U;
+            SETZ_ON_ZERO(cpuDE.low);
             cpuPc++;
             return 4;
         case 0x1e: // ld E, n
-            cpuE = read8(cpuPc + 1);
+            cpuDE.low = read8(cpuPc + 1);
             cpuPc += 2;
             return 8;
         case 0x1f: // rr A (9-bit rotation right of A through carry)
@@ -2878,44 +2821,36 @@ int Gbc::performOp() {
                 return 12;
             }
         case 0x21: // ld HL, nn
-            cpuH = read8(cpuPc + 2);
-            cpuL = read8(cpuPc + 1);
+            cpuHL.high = read8(cpuPc + 2);
+            cpuHL.low = read8(cpuPc + 1);
             cpuPc += 3;
             return 12;
         case 0x22: // ldi (HL), A
             W8_HL(cpuA);
-            cpuL++;
-            if (cpuL == 0x00)
-            {
-                cpuH++; // L overflowed into H
-            }
+            cpuHL.word++;
             cpuPc++;
             return 8;
         case 0x23: // inc HL
-            cpuL++;
-            if (cpuL == 0x00)
-            {
-                cpuH++;
-            }
+            cpuHL.word++;
             cpuPc++;
             return 8;
         case 0x24: // inc H
             cpuF &= 0x10U;
-            cpuH += 0x01U;
-            SETZ_ON_ZERO(cpuH);
-            SETH_ON_ZERO(cpuH & 0x0fU);
+            cpuHL.high += 0x01U;
+            SETZ_ON_ZERO(cpuHL.high);
+            SETH_ON_ZERO(cpuHL.high & 0x0fU);
             cpuPc++;
             return 4;
         case 0x25: // dec H
             cpuF &= 0x10U;
             cpuF |= 0x40U;
-            SETH_ON_ZERO(cpuH & 0x0fU);
-            cpuH -= 0x01U;
-            SETZ_ON_ZERO(cpuH);
+            SETH_ON_ZERO(cpuHL.high & 0x0fU);
+            cpuHL.high -= 0x01U;
+            SETZ_ON_ZERO(cpuHL.high);
             cpuPc++;
             return 4;
         case 0x26: // ld H, n
-            cpuH = read8(cpuPc + 1);
+            cpuHL.high = read8(cpuPc + 1);
             cpuPc += 2;
             return 8;
         case 0x27: // daa (Decimal Adjust Accumulator - do BCD correction)
@@ -2972,54 +2907,37 @@ int Gbc::performOp() {
             }
         case 0x29: // add HL, HL
             cpuF &= 0x80U;
-            SETC_ON_COND((cpuH & 0x80U) != 0x00);
-            SETH_ON_COND((cpuH & 0x08U) != 0x00);
-            if ((cpuL & 0x80U) != 0x00)
-            {
-                cpuH += cpuH + 1;
-                cpuL += cpuL;
-            }
-            else
-            {
-                cpuH *= 2;
-                cpuL *= 2;
-            }
+            SETH_ON_COND((cpuHL.word & 0x0fffU) + (cpuHL.word & 0x0fffU) > 0x0fffU);
+            SETC_ON_COND((unsigned int)cpuHL.word + cpuHL.word > 0xffffU);
+            cpuHL.word += cpuHL.word;
             cpuPc++;
             return 8;
         case 0x2a: // ldi A, (HL)
             cpuA = R8_HL();
-            cpuL++;
-            if (cpuL == 0x00)
-            {
-                cpuH++;
-            }
+            cpuHL.word++;
             cpuPc++;
             return 8;
         case 0x2b: // dec HL
-            if (cpuL == 0x00)
-            {
-                cpuH--;
-            }
-            cpuL--;
+            cpuHL.word--;
             cpuPc++;
             return 8;
         case 0x2c: // inc L
             cpuF &= 0x10U;
-            cpuL += 0x01U;
-            SETZ_ON_ZERO(cpuL);
-            SETH_ON_ZERO(cpuL & 0x0fU);
+            cpuHL.low += 0x01U;
+            SETZ_ON_ZERO(cpuHL.low);
+            SETH_ON_ZERO(cpuHL.low & 0x0fU);
             cpuPc++;
             return 4;
         case 0x2d: // dec L
             cpuF &= 0x10U;
             cpuF |= 0x40U;
-            SETH_ON_ZERO(cpuL & 0x0fU);
-            cpuL -= 0x01U;
-            SETZ_ON_ZERO(cpuL);
+            SETH_ON_ZERO(cpuHL.low & 0x0fU);
+            cpuHL.low -= 0x01U;
+            SETZ_ON_ZERO(cpuHL.low);
             cpuPc++;
             return 4;
         case 0x2e: // ld L, n
-            cpuL = read8(cpuPc + 1);
+            cpuHL.low = read8(cpuPc + 1);
             cpuPc += 2;
             return 8;
         case 0x2f: // cpl A (complement - bitwise NOT)
@@ -3053,11 +2971,7 @@ int Gbc::performOp() {
             return 12;
         case 0x32: // ldd (HL), A
             W8_HL(cpuA);
-            if (cpuL == 0x00)
-            {
-                cpuH--;
-            }
-            cpuL--;
+            cpuHL.word--;
             cpuPc++;
             return 8;
         case 0x33: // inc SP
@@ -3119,29 +3033,15 @@ int Gbc::performOp() {
                 return 8;
             }
         case 0x39: // add HL, SP
-        {
             cpuF &= 0x80U;
-            auto tempByte = (uint8_t)(cpuSp & 0xffU);
-            cpuL += tempByte;
-            if (cpuL < tempByte)
-            {
-                cpuH++;
-            }
-            tempByte = (uint8_t)(cpuSp >> 8U);
-            cpuH += tempByte;
-            SETC_ON_COND(cpuH < tempByte);
-            tempByte = tempByte & 0x0fU;
-            SETH_ON_COND((cpuH & 0x0fU) < tempByte);
-        }
+            cpuHL.word += (uint16_t)cpuSp;
+            SETC_ON_COND(cpuHL.high < (uint8_t)(cpuSp >> 8U));
+            SETH_ON_COND((cpuHL.high & 0x0fU) < ((cpuSp >> 8U) & 0x0fU));
             cpuPc++;
             return 8;
         case 0x3a: // ldd A, (HL)
             cpuA = R8_HL();
-            if (cpuL == 0x00)
-            {
-                cpuH--;
-            }
-            cpuL--;
+            cpuHL.word--;
             cpuPc++;
             return 8;
         case 0x3b: // dec SP
@@ -3182,210 +3082,210 @@ int Gbc::performOp() {
             cpuPc++;
             return 4;
         case 0x41: // ld B, C
-            cpuB = cpuC;
+            cpuBC.high = cpuBC.low;
             cpuPc++;
             return 4;
         case 0x42: // ld B, D
-            cpuB = cpuD;
+            cpuBC.high = cpuDE.high;
             cpuPc++;
             return 4;
         case 0x43: // ld B, E
-            cpuB = cpuE;
+            cpuBC.high = cpuDE.low;
             cpuPc++;
             return 4;
         case 0x44: // ld B, H
-            cpuB = cpuH;
+            cpuBC.high = cpuHL.high;
             cpuPc++;
             return 4;
         case 0x45: // ld B, L
-            cpuB = cpuL;
+            cpuBC.high = cpuHL.low;
             cpuPc++;
             return 4;
         case 0x46: // ld B, (HL)
-            cpuB = R8_HL();
+            cpuBC.high = R8_HL();
             cpuPc++;
             return 8;
         case 0x47: // ld B, A
-            cpuB = cpuA;
+            cpuBC.high = cpuA;
             cpuPc++;
             return 4;
         case 0x48: // ld C, B
-            cpuC = cpuB;
+            cpuBC.low = cpuBC.high;
             cpuPc++;
             return 4;
         case 0x49: // ld C, C
             cpuPc++;
             return 4;
         case 0x4a: // ld C, D
-            cpuC = cpuD;
+            cpuBC.low = cpuDE.high;
             cpuPc++;
             return 4;
         case 0x4b: // ld C, E
-            cpuC = cpuE;
+            cpuBC.low = cpuDE.low;
             cpuPc++;
             return 4;
         case 0x4c: // ld C, H
-            cpuC = cpuH;
+            cpuBC.low = cpuHL.high;
             cpuPc++;
             return 4;
         case 0x4d: // ld C, L
-            cpuC = cpuL;
+            cpuBC.low = cpuHL.low;
             cpuPc++;
             return 4;
         case 0x4e: // ld C, (HL)
-            cpuC = R8_HL();
+            cpuBC.low = R8_HL();
             cpuPc++;
             return 8;
         case 0x4f: // ld C, A
-            cpuC = cpuA;
+            cpuBC.low = cpuA;
             cpuPc++;
             return 4;
         case 0x50: // ld D, B
-            cpuD = cpuB;
+            cpuDE.high = cpuBC.high;
             cpuPc++;
             return 4;
         case 0x51: // ld D, C
-            cpuD = cpuC;
+            cpuDE.high = cpuBC.low;
             cpuPc++;
             return 4;
         case 0x52: // ld D, D
             cpuPc++;
             return 4;
         case 0x53: // ld D, E
-            cpuD = cpuE;
+            cpuDE.high = cpuDE.low;
             cpuPc++;
             return 4;
         case 0x54: // ld D, H
-            cpuD = cpuH;
+            cpuDE.high = cpuHL.high;
             cpuPc++;
             return 4;
         case 0x55: // ld D, L
-            cpuD = cpuL;
+            cpuDE.high = cpuHL.low;
             cpuPc++;
             return 4;
         case 0x56: // ld D, (HL)
-            cpuD = R8_HL();
+            cpuDE.high = R8_HL();
             cpuPc++;
             return 8;
         case 0x57: // ld D, A
-            cpuD = cpuA;
+            cpuDE.high = cpuA;
             cpuPc++;
             return 4;
         case 0x58: // ld E, B
-            cpuE = cpuB;
+            cpuDE.low = cpuBC.high;
             cpuPc++;
             return 4;
         case 0x59: // ld E, C
-            cpuE = cpuC;
+            cpuDE.low = cpuBC.low;
             cpuPc++;
             return 4;
         case 0x5a: // ld E, D
-            cpuE = cpuD;
+            cpuDE.low = cpuDE.high;
             cpuPc++;
             return 4;
         case 0x5b: // ld E, E
             cpuPc++;
             return 4;
         case 0x5c: // ld E, H
-            cpuE = cpuH;
+            cpuDE.low = cpuHL.high;
             cpuPc++;
             return 4;
         case 0x5d: // ld E, L
-            cpuE = cpuL;
+            cpuDE.low = cpuHL.low;
             cpuPc++;
             return 4;
         case 0x5e: // ld E, (HL)
-            cpuE = R8_HL();
+            cpuDE.low = R8_HL();
             cpuPc++;
             return 8;
         case 0x5f: // ld E, A
-            cpuE = cpuA;
+            cpuDE.low = cpuA;
             cpuPc++;
             return 4;
         case 0x60: // ld H, B
-            cpuH = cpuB;
+            cpuHL.high = cpuBC.high;
             cpuPc++;
             return 4;
         case 0x61: // ld H, C
-            cpuH = cpuC;
+            cpuHL.high = cpuBC.low;
             cpuPc++;
             return 4;
         case 0x62: // ld H, D
-            cpuH = cpuD;
+            cpuHL.high = cpuDE.high;
             cpuPc++;
             return 4;
         case 0x63: // ld H, E
-            cpuH = cpuE;
+            cpuHL.high = cpuDE.low;
             cpuPc++;
             return 4;
         case 0x64: // ld H, H
             cpuPc++;
             return 4;
         case 0x65: // ld H, L
-            cpuH = cpuL;
+            cpuHL.high = cpuHL.low;
             cpuPc++;
             return 4;
         case 0x66: // ld H, (HL)
-            cpuH = R8_HL();
+            cpuHL.high = R8_HL();
             cpuPc++;
             return 8;
         case 0x67: // ld H, A
-            cpuH = cpuA;
+            cpuHL.high = cpuA;
             cpuPc++;
             return 4;
         case 0x68: // ld L, B
-            cpuL = cpuB;
+            cpuHL.low = cpuBC.high;
             cpuPc++;
             return 4;
         case 0x69: // ld L, C
-            cpuL = cpuC;
+            cpuHL.low = cpuBC.low;
             cpuPc++;
             return 4;
         case 0x6a: // ld L, D
-            cpuL = cpuD;
+            cpuHL.low = cpuDE.high;
             cpuPc++;
             return 4;
         case 0x6b: // ld L, E
-            cpuL = cpuE;
+            cpuHL.low = cpuDE.low;
             cpuPc++;
             return 4;
         case 0x6c: // ld L, H
-            cpuL = cpuH;
+            cpuHL.low = cpuHL.high;
             cpuPc++;
             return 4;
         case 0x6d: // ld L, L
             cpuPc++;
             return 4;
         case 0x6e: // ld L, (HL)
-            cpuL = R8_HL();
+            cpuHL.low = R8_HL();
             cpuPc++;
             return 8;
         case 0x6f: // ld L, A
-            cpuL = cpuA;
+            cpuHL.low = cpuA;
             cpuPc++;
             return 4;
         case 0x70: // ld (HL), B
-            W8_HL(cpuB);
+            W8_HL(cpuBC.high);
             cpuPc++;
             return 8;
         case 0x71: // ld (HL), C
-            W8_HL(cpuC);
+            W8_HL(cpuBC.low);
             cpuPc++;
             return 8;
         case 0x72: // ld (HL), D
-            W8_HL(cpuD);
+            W8_HL(cpuDE.high);
             cpuPc++;
             return 8;
         case 0x73: // ld (HL), E
-            W8_HL(cpuE);
+            W8_HL(cpuDE.low);
             cpuPc++;
             return 8;
         case 0x74: // ld (HL), H
-            W8_HL(cpuH);
+            W8_HL(cpuHL.high);
             cpuPc++;
             return 8;
         case 0x75: // ld (HL), L
-            W8_HL(cpuL);
+            W8_HL(cpuHL.low);
             cpuPc++;
             return 8;
         case 0x76: // halt (NOTE THAT THIS GETS INTERRUPTED EVEN WHEN INTERRUPTS ARE DISABLED)
@@ -3397,27 +3297,27 @@ int Gbc::performOp() {
             cpuPc++;
             return 8;
         case 0x78: // ld A, B
-            cpuA = cpuB;
+            cpuA = cpuBC.high;
             cpuPc++;
             return 4;
         case 0x79: // ld A, C
-            cpuA = cpuC;
+            cpuA = cpuBC.low;
             cpuPc++;
             return 4;
         case 0x7a: // ld A, D
-            cpuA = cpuD;
+            cpuA = cpuDE.high;
             cpuPc++;
             return 4;
         case 0x7b: // ld A, E
-            cpuA = cpuE;
+            cpuA = cpuDE.low;
             cpuPc++;
             return 4;
         case 0x7c: // ld A, H
-            cpuA = cpuH;
+            cpuA = cpuHL.high;
             cpuPc++;
             return 4;
         case 0x7d: // ld A, L
-            cpuA = cpuL;
+            cpuA = cpuHL.low;
             cpuPc++;
             return 4;
         case 0x7e: // ld A, (HL)
@@ -3428,51 +3328,51 @@ int Gbc::performOp() {
             cpuPc++;
             return 4;
         case 0x80: // add B (add B to A)
-            cpuA += cpuB;
+            cpuA += cpuBC.high;
             cpuF = 0x00;
             SETZ_ON_ZERO(cpuA);
-            SETH_ON_COND((cpuB & 0x0fU) > (cpuA & 0x0fU));
-            SETC_ON_COND(cpuB > cpuA);
+            SETH_ON_COND((cpuBC.high & 0x0fU) > (cpuA & 0x0fU));
+            SETC_ON_COND(cpuBC.high > cpuA);
             cpuPc++;
             return 4;
         case 0x81: // add C
-            cpuA += cpuC;
+            cpuA += cpuBC.low;
             cpuF = 0x00;
             SETZ_ON_ZERO(cpuA);
-            SETH_ON_COND((cpuC & 0x0fU) > (cpuA & 0x0fU));
-            SETC_ON_COND(cpuC > cpuA);
+            SETH_ON_COND((cpuBC.low & 0x0fU) > (cpuA & 0x0fU));
+            SETC_ON_COND(cpuBC.low > cpuA);
             cpuPc++;
             return 4;
         case 0x82: // add D
-            cpuA += cpuD;
+            cpuA += cpuDE.high;
             cpuF = 0x00;
             SETZ_ON_ZERO(cpuA);
-            SETH_ON_COND((cpuD & 0x0fU) > (cpuA & 0x0fU));
-            SETC_ON_COND(cpuD > cpuA);
+            SETH_ON_COND((cpuDE.high & 0x0fU) > (cpuA & 0x0fU));
+            SETC_ON_COND(cpuDE.high > cpuA);
             cpuPc++;
             return 4;
         case 0x83: // add E
-            cpuA += cpuE;
+            cpuA += cpuDE.low;
             cpuF = 0x00;
             SETZ_ON_ZERO(cpuA);
-            SETH_ON_COND((cpuE & 0x0fU) > (cpuA & 0x0fU));
-            SETC_ON_COND(cpuE > cpuA);
+            SETH_ON_COND((cpuDE.low & 0x0fU) > (cpuA & 0x0fU));
+            SETC_ON_COND(cpuDE.low > cpuA);
             cpuPc++;
             return 4;
         case 0x84: // add H
-            cpuA += cpuH;
+            cpuA += cpuHL.high;
             cpuF = 0x00;
             SETZ_ON_ZERO(cpuA);
-            SETH_ON_COND((cpuH & 0x0fU) > (cpuA & 0x0fU));
-            SETC_ON_COND(cpuH > cpuA);
+            SETH_ON_COND((cpuHL.high & 0x0fU) > (cpuA & 0x0fU));
+            SETC_ON_COND(cpuHL.high > cpuA);
             cpuPc++;
             return 4;
         case 0x85: // add L
-            cpuA += cpuL;
+            cpuA += cpuHL.low;
             cpuF = 0x00;
             SETZ_ON_ZERO(cpuA);
-            SETH_ON_COND((cpuL & 0x0fU) > (cpuA & 0x0fU));
-            SETC_ON_COND(cpuL > cpuA);
+            SETH_ON_COND((cpuHL.low & 0x0fU) > (cpuA & 0x0fU));
+            SETC_ON_COND(cpuHL.low > cpuA);
             cpuPc++;
             return 4;
         case 0x86: // add (HL)
@@ -3496,7 +3396,7 @@ int Gbc::performOp() {
             return 4;
         case 0x88: // adc A, B (add B + carry to A)
         {
-            uint8_t tempByte = cpuB;
+            uint8_t tempByte = cpuBC.high;
             if ((cpuF & 0x10U) != 0x00)
             {
                 cpuF = 0x00;
@@ -3516,7 +3416,7 @@ int Gbc::performOp() {
             return 4;
         case 0x89: // adc A, C
         {
-            uint8_t tempByte = cpuC;
+            uint8_t tempByte = cpuBC.low;
             if ((cpuF & 0x10U) != 0x00)
             {
                 cpuF = 0x00;
@@ -3536,7 +3436,7 @@ int Gbc::performOp() {
             return 4;
         case 0x8a: // adc A, D
         {
-            uint8_t tempByte = cpuD;
+            uint8_t tempByte = cpuDE.high;
             if ((cpuF & 0x10U) != 0x00)
             {
                 cpuF = 0x00;
@@ -3556,7 +3456,7 @@ int Gbc::performOp() {
             return 4;
         case 0x8b: // adc A, E
         {
-            uint8_t tempByte = cpuE;
+            uint8_t tempByte = cpuDE.low;
             if ((cpuF & 0x10U) != 0x00)
             {
                 cpuF = 0x00;
@@ -3576,7 +3476,7 @@ int Gbc::performOp() {
             return 4;
         case 0x8c: // adc A, H
         {
-            uint8_t tempByte = cpuH;
+            uint8_t tempByte = cpuHL.high;
             if ((cpuF & 0x10U) != 0x00)
             {
                 cpuF = 0x00;
@@ -3596,7 +3496,7 @@ int Gbc::performOp() {
             return 4;
         case 0x8d: // adc A, L
         {
-            uint8_t tempByte = cpuL;
+            uint8_t tempByte = cpuHL.low;
             if ((cpuF & 0x10U) != 0x00)
             {
                 cpuF = 0x00;
@@ -3656,9 +3556,9 @@ int Gbc::performOp() {
             return 4;
         case 0x90: // sub B (sub B from A)
             cpuF = 0x40;
-            SETC_ON_COND(cpuB > cpuA);
-            SETH_ON_COND((cpuB & 0x0fU) > (cpuA & 0x0fU));
-            cpuA -= cpuB;
+            SETC_ON_COND(cpuBC.high > cpuA);
+            SETH_ON_COND((cpuBC.high & 0x0fU) > (cpuA & 0x0fU));
+            cpuA -= cpuBC.high;
             if (cpuA == 0x00)
             {
                 cpuF = 0xc0;
@@ -3667,9 +3567,9 @@ int Gbc::performOp() {
             return 4;
         case 0x91: // sub C
             cpuF = 0x40;
-            SETC_ON_COND(cpuC > cpuA);
-            SETH_ON_COND((cpuC & 0x0fU) > (cpuA & 0x0fU));
-            cpuA -= cpuC;
+            SETC_ON_COND(cpuBC.low > cpuA);
+            SETH_ON_COND((cpuBC.low & 0x0fU) > (cpuA & 0x0fU));
+            cpuA -= cpuBC.low;
             if (cpuA == 0x00)
             {
                 cpuF = 0xc0;
@@ -3678,9 +3578,9 @@ int Gbc::performOp() {
             return 4;
         case 0x92: // sub D
             cpuF = 0x40;
-            SETC_ON_COND(cpuD > cpuA);
-            SETH_ON_COND((cpuD & 0x0fU) > (cpuA & 0x0fU));
-            cpuA -= cpuD;
+            SETC_ON_COND(cpuDE.high > cpuA);
+            SETH_ON_COND((cpuDE.high & 0x0fU) > (cpuA & 0x0fU));
+            cpuA -= cpuDE.high;
             if (cpuA == 0x00)
             {
                 cpuF = 0xc0;
@@ -3689,9 +3589,9 @@ int Gbc::performOp() {
             return 4;
         case 0x93: // sub E
             cpuF = 0x40;
-            SETC_ON_COND(cpuE > cpuA);
-            SETH_ON_COND((cpuE & 0x0fU) > (cpuA & 0x0fU));
-            cpuA -= cpuE;
+            SETC_ON_COND(cpuDE.low > cpuA);
+            SETH_ON_COND((cpuDE.low & 0x0fU) > (cpuA & 0x0fU));
+            cpuA -= cpuDE.low;
             if (cpuA == 0x00)
             {
                 cpuF = 0xc0;
@@ -3700,9 +3600,9 @@ int Gbc::performOp() {
             return 4;
         case 0x94: // sub H
             cpuF = 0x40;
-            SETC_ON_COND(cpuH > cpuA);
-            SETH_ON_COND((cpuH & 0x0fU) > (cpuA & 0x0fU));
-            cpuA -= cpuH;
+            SETC_ON_COND(cpuHL.high > cpuA);
+            SETH_ON_COND((cpuHL.high & 0x0fU) > (cpuA & 0x0fU));
+            cpuA -= cpuHL.high;
             if (cpuA == 0x00)
             {
                 cpuF = 0xc0;
@@ -3711,9 +3611,9 @@ int Gbc::performOp() {
             return 4;
         case 0x95: // sub L
             cpuF = 0x40;
-            SETC_ON_COND(cpuL > cpuA);
-            SETH_ON_COND((cpuL & 0x0fU) > (cpuA & 0x0fU));
-            cpuA -= cpuL;
+            SETC_ON_COND(cpuHL.low > cpuA);
+            SETH_ON_COND((cpuHL.low & 0x0fU) > (cpuA & 0x0fU));
+            cpuA -= cpuHL.low;
             if (cpuA == 0x00)
             {
                 cpuF = 0xc0;
@@ -3743,9 +3643,9 @@ int Gbc::performOp() {
         {
             uint8_t tempByte = cpuF & 0x10U;
             cpuF = 0x40;
-            SETC_ON_COND(cpuB > cpuA);
-            SETH_ON_COND((cpuB & 0x0fU) > (cpuA & 0x0fU));
-            cpuA -= cpuB;
+            SETC_ON_COND(cpuBC.high > cpuA);
+            SETH_ON_COND((cpuBC.high & 0x0fU) > (cpuA & 0x0fU));
+            cpuA -= cpuBC.high;
             if (tempByte != 0x00)
             {
                 if (cpuA == 0)
@@ -3766,9 +3666,9 @@ int Gbc::performOp() {
         {
             uint8_t tempByte = cpuF & 0x10U;
             cpuF = 0x40;
-            SETC_ON_COND(cpuC > cpuA);
-            SETH_ON_COND((cpuC & 0x0fU) > (cpuA & 0x0fU));
-            cpuA -= cpuC;
+            SETC_ON_COND(cpuBC.low > cpuA);
+            SETH_ON_COND((cpuBC.low & 0x0fU) > (cpuA & 0x0fU));
+            cpuA -= cpuBC.low;
             if (tempByte != 0x00)
             {
                 if (cpuA == 0)
@@ -3789,9 +3689,9 @@ int Gbc::performOp() {
         {
             uint8_t tempByte = cpuF & 0x10U;
             cpuF = 0x40;
-            SETC_ON_COND(cpuD > cpuA);
-            SETH_ON_COND((cpuD & 0x0fU) > (cpuA & 0x0fU));
-            cpuA -= cpuD;
+            SETC_ON_COND(cpuDE.high > cpuA);
+            SETH_ON_COND((cpuDE.high & 0x0fU) > (cpuA & 0x0fU));
+            cpuA -= cpuDE.high;
             if (tempByte != 0x00)
             {
                 if (cpuA == 0)
@@ -3812,9 +3712,9 @@ int Gbc::performOp() {
         {
             uint8_t tempByte = cpuF & 0x10U;
             cpuF = 0x40;
-            SETC_ON_COND(cpuE > cpuA);
-            SETH_ON_COND((cpuE & 0x0fU) > (cpuA & 0x0fU));
-            cpuA -= cpuE;
+            SETC_ON_COND(cpuDE.low > cpuA);
+            SETH_ON_COND((cpuDE.low & 0x0fU) > (cpuA & 0x0fU));
+            cpuA -= cpuDE.low;
             if (tempByte != 0x00)
             {
                 if (cpuA == 0)
@@ -3835,9 +3735,9 @@ int Gbc::performOp() {
         {
             uint8_t tempByte = cpuF & 0x10U;
             cpuF = 0x40;
-            SETC_ON_COND(cpuH > cpuA);
-            SETH_ON_COND((cpuH & 0x0fU) > (cpuA & 0x0fU));
-            cpuA -= cpuH;
+            SETC_ON_COND(cpuHL.high > cpuA);
+            SETH_ON_COND((cpuHL.high & 0x0fU) > (cpuA & 0x0fU));
+            cpuA -= cpuHL.high;
             if (tempByte != 0x00)
             {
                 if (cpuA == 0)
@@ -3858,9 +3758,9 @@ int Gbc::performOp() {
         {
             uint8_t tempByte = cpuF & 0x10U;
             cpuF = 0x40;
-            SETC_ON_COND(cpuL > cpuA);
-            SETH_ON_COND((cpuL & 0x0fU) > (cpuA & 0x0fU));
-            cpuA -= cpuL;
+            SETC_ON_COND(cpuHL.low > cpuA);
+            SETH_ON_COND((cpuHL.low & 0x0fU) > (cpuA & 0x0fU));
+            cpuA -= cpuHL.low;
             if (tempByte != 0x00)
             {
                 if (cpuA == 0)
@@ -3923,37 +3823,37 @@ int Gbc::performOp() {
             cpuPc++;
             return 4;
         case 0xa0: // and B (and B against A)
-            cpuA = cpuA & cpuB;
+            cpuA = cpuA & cpuBC.high;
             cpuF = 0x20U;
             SETZ_ON_ZERO(cpuA);
             cpuPc++;
             return 4;
         case 0xa1: // and C
-            cpuA = cpuA & cpuC;
+            cpuA = cpuA & cpuBC.low;
             cpuF = 0x20U;
             SETZ_ON_ZERO(cpuA);
             cpuPc++;
             return 4;
         case 0xa2: // and D
-            cpuA = cpuA & cpuD;
+            cpuA = cpuA & cpuDE.high;
             cpuF = 0x20U;
             SETZ_ON_ZERO(cpuA);
             cpuPc++;
             return 4;
         case 0xa3: // and E
-            cpuA = cpuA & cpuE;
+            cpuA = cpuA & cpuDE.low;
             cpuF = 0x20U;
             SETZ_ON_ZERO(cpuA);
             cpuPc++;
             return 4;
         case 0xa4: // and H
-            cpuA = cpuA & cpuH;
+            cpuA = cpuA & cpuHL.high;
             cpuF = 0x20U;
             SETZ_ON_ZERO(cpuA);
             cpuPc++;
             return 4;
         case 0xa5: // and L
-            cpuA = cpuA & cpuL;
+            cpuA = cpuA & cpuHL.low;
             cpuF = 0x20U;
             SETZ_ON_ZERO(cpuA);
             cpuPc++;
@@ -3970,37 +3870,37 @@ int Gbc::performOp() {
             cpuPc++;
             return 4;
         case 0xa8: // xor B (A = A XOR B)
-            cpuA = cpuA ^ cpuB;
+            cpuA = cpuA ^ cpuBC.high;
             cpuF = 0x00;
             SETZ_ON_ZERO(cpuA);
             cpuPc++;
             return 4;
         case 0xa9: // xor C
-            cpuA = cpuA ^ cpuC;
+            cpuA = cpuA ^ cpuBC.low;
             cpuF = 0x00;
             SETZ_ON_ZERO(cpuA);
             cpuPc++;
             return 4;
         case 0xaa: // xor D
-            cpuA = cpuA ^ cpuD;
+            cpuA = cpuA ^ cpuDE.high;
             cpuF = 0x00;
             SETZ_ON_ZERO(cpuA);
             cpuPc++;
             return 4;
         case 0xab: // xor E
-            cpuA = cpuA ^ cpuE;
+            cpuA = cpuA ^ cpuDE.low;
             cpuF = 0x00;
             SETZ_ON_ZERO(cpuA);
             cpuPc++;
             return 4;
         case 0xac: // xor H
-            cpuA = cpuA ^ cpuH;
+            cpuA = cpuA ^ cpuHL.high;
             cpuF = 0x00;
             SETZ_ON_ZERO(cpuA);
             cpuPc++;
             return 4;
         case 0xad: // xor L
-            cpuA = cpuA ^ cpuL;
+            cpuA = cpuA ^ cpuHL.low;
             cpuF = 0x00;
             SETZ_ON_ZERO(cpuA);
             cpuPc++;
@@ -4017,37 +3917,37 @@ int Gbc::performOp() {
             cpuPc++;
             return 4;
         case 0xb0: // or B (or B against A)
-            cpuA = cpuA | cpuB;
+            cpuA = cpuA | cpuBC.high;
             cpuF = 0x00;
             SETZ_ON_ZERO(cpuA);
             cpuPc++;
             return 4;
         case 0xb1: // or C
-            cpuA = cpuA | cpuC;
+            cpuA = cpuA | cpuBC.low;
             cpuF = 0x00;
             SETZ_ON_ZERO(cpuA);
             cpuPc++;
             return 4;
         case 0xb2: // or D
-            cpuA = cpuA | cpuD;
+            cpuA = cpuA | cpuDE.high;
             cpuF = 0x00;
             SETZ_ON_ZERO(cpuA);
             cpuPc++;
             return 4;
         case 0xb3: // or E
-            cpuA = cpuA | cpuE;
+            cpuA = cpuA | cpuDE.low;
             cpuF = 0x00;
             SETZ_ON_ZERO(cpuA);
             cpuPc++;
             return 4;
         case 0xb4: // or H
-            cpuA = cpuA | cpuH;
+            cpuA = cpuA | cpuHL.high;
             cpuF = 0x00;
             SETZ_ON_ZERO(cpuA);
             cpuPc++;
             return 4;
         case 0xb5: // or L
-            cpuA = cpuA | cpuL;
+            cpuA = cpuA | cpuHL.low;
             cpuF = 0x00;
             SETZ_ON_ZERO(cpuA);
             cpuPc++;
@@ -4065,44 +3965,44 @@ int Gbc::performOp() {
             return 4;
         case 0xb8: // cp B
             cpuF = 0x40;
-            SETH_ON_COND((cpuB & 0x0fU) > (cpuA & 0x0fU));
-            SETC_ON_COND(cpuB > cpuA);
-            SETZ_ON_COND(cpuA == cpuB);
+            SETH_ON_COND((cpuBC.high & 0x0fU) > (cpuA & 0x0fU));
+            SETC_ON_COND(cpuBC.high > cpuA);
+            SETZ_ON_COND(cpuA == cpuBC.high);
             cpuPc++;
             return 4;
         case 0xb9: // cp C
             cpuF = 0x40;
-            SETH_ON_COND((cpuC & 0x0fU) > (cpuA & 0x0fU));
-            SETC_ON_COND(cpuC > cpuA);
-            SETZ_ON_COND(cpuA == cpuC);
+            SETH_ON_COND((cpuBC.low & 0x0fU) > (cpuA & 0x0fU));
+            SETC_ON_COND(cpuBC.low > cpuA);
+            SETZ_ON_COND(cpuA == cpuBC.low);
             cpuPc++;
             return 4;
         case 0xba: // cp D
             cpuF = 0x40;
-            SETH_ON_COND((cpuD & 0x0fU) > (cpuA & 0x0fU));
-            SETC_ON_COND(cpuD > cpuA);
-            SETZ_ON_COND(cpuA == cpuD);
+            SETH_ON_COND((cpuDE.high & 0x0fU) > (cpuA & 0x0fU));
+            SETC_ON_COND(cpuDE.high > cpuA);
+            SETZ_ON_COND(cpuA == cpuDE.high);
             cpuPc++;
             return 4;
         case 0xbb: // cp E
             cpuF = 0x40;
-            SETH_ON_COND((cpuE & 0x0fU) > (cpuA & 0x0fU));
-            SETC_ON_COND(cpuE > cpuA);
-            SETZ_ON_COND(cpuA == cpuE);
+            SETH_ON_COND((cpuDE.low & 0x0fU) > (cpuA & 0x0fU));
+            SETC_ON_COND(cpuDE.low > cpuA);
+            SETZ_ON_COND(cpuA == cpuDE.low);
             cpuPc++;
             return 4;
         case 0xbc: // cp H
             cpuF = 0x40;
-            SETH_ON_COND((cpuH & 0x0fU) > (cpuA & 0x0fU));
-            SETC_ON_COND(cpuH > cpuA);
-            SETZ_ON_COND(cpuA == cpuH);
+            SETH_ON_COND((cpuHL.high & 0x0fU) > (cpuA & 0x0fU));
+            SETC_ON_COND(cpuHL.high > cpuA);
+            SETZ_ON_COND(cpuA == cpuHL.high);
             cpuPc++;
             return 4;
         case 0xbd: // cp L
             cpuF = 0x40;
-            SETH_ON_COND((cpuL & 0x0fU) > (cpuA & 0x0fU));
-            SETC_ON_COND(cpuL > cpuA);
-            SETZ_ON_COND(cpuA == cpuL);
+            SETH_ON_COND((cpuHL.low & 0x0fU) > (cpuA & 0x0fU));
+            SETC_ON_COND(cpuHL.low > cpuA);
+            SETZ_ON_COND(cpuA == cpuHL.low);
             cpuPc++;
             return 4;
         case 0xbe: // cp (HL)
@@ -4136,7 +4036,7 @@ int Gbc::performOp() {
                 return 20;
             }
         case 0xc1: // pop BC
-            read16(cpuSp, &cpuC, &cpuB);
+            read16(cpuSp, &cpuBC.low, &cpuBC.high);
             cpuSp += 2;
             cpuPc++;
             return 12;
@@ -4179,7 +4079,7 @@ int Gbc::performOp() {
             }
         case 0xc5: // push BC
             cpuSp -= 2;
-            write16(cpuSp, cpuC, cpuB);
+            write16(cpuSp, cpuBC.low, cpuBC.high);
             cpuPc++;
             return 16;
         case 0xc6: // add A, n
@@ -4254,80 +4154,80 @@ int Gbc::performOp() {
             {
                 case 0x00: // rlc B
                 {
-                    uint8_t tempByte = cpuB & 0x80U; // True if bit 7 is set
+                    uint8_t tempByte = cpuBC.high & 0x80U; // True if bit 7 is set
                     cpuF = 0x00; // Reset all other flags
-                    cpuB = cpuB << 1U;
+                    cpuBC.high = cpuBC.high << 1U;
                     if (tempByte != 0)
                     {
-                        cpuB |= 0x01U;
+                        cpuBC.high |= 0x01U;
                         cpuF = 0x10U; // Set carry
                     }
-                    SETZ_ON_ZERO(cpuB);
+                    SETZ_ON_ZERO(cpuBC.high);
                 }
                     return 8;
                 case 0x01: // rlc C
                 {
-                    uint8_t tempByte = cpuC & 0x80U; // True if bit 7 is set
+                    uint8_t tempByte = cpuBC.low & 0x80U; // True if bit 7 is set
                     cpuF = 0x00; // Reset all other flags
-                    cpuC = cpuC << 1U;
+                    cpuBC.low = cpuBC.low << 1U;
                     if (tempByte != 0)
                     {
-                        cpuC |= 0x01U;
+                        cpuBC.low |= 0x01U;
                         cpuF = 0x10U; // Set carry
                     }
-                    SETZ_ON_ZERO(cpuC);
+                    SETZ_ON_ZERO(cpuBC.low);
                 }
                     return 8;
                 case 0x02: // rlc D
                 {
-                    uint8_t tempByte = cpuD & 0x80U; // True if bit 7 is set
+                    uint8_t tempByte = cpuDE.high & 0x80U; // True if bit 7 is set
                     cpuF = 0x00; // Reset all other flags
-                    cpuD = cpuD << 1U;
+                    cpuDE.high = cpuDE.high << 1U;
                     if (tempByte != 0)
                     {
-                        cpuD |= 0x01U;
+                        cpuDE.high |= 0x01U;
                         cpuF = 0x10U; // Set carry
                     }
-                    SETZ_ON_ZERO(cpuD);
+                    SETZ_ON_ZERO(cpuDE.high);
                 }
                     return 8;
                 case 0x03: // rlc E
                 {
-                    uint8_t tempByte = cpuE & 0x80U; // True if bit 7 is set
+                    uint8_t tempByte = cpuDE.low & 0x80U; // True if bit 7 is set
                     cpuF = 0x00; // Reset all other flags
-                    cpuE = cpuE << 1U;
+                    cpuDE.low = cpuDE.low << 1U;
                     if (tempByte != 0)
                     {
-                        cpuE |= 0x01U;
+                        cpuDE.low |= 0x01U;
                         cpuF = 0x10U; // Set carry
                     }
-                    SETZ_ON_ZERO(cpuE);
+                    SETZ_ON_ZERO(cpuDE.low);
                 }
                     return 8;
                 case 0x04: // rlc H
                 {
-                    uint8_t tempByte = cpuH & 0x80U; // True if bit 7 is set
+                    uint8_t tempByte = cpuHL.high & 0x80U; // True if bit 7 is set
                     cpuF = 0x00; // Reset all other flags
-                    cpuH = cpuH << 1U;
+                    cpuHL.high = cpuHL.high << 1U;
                     if (tempByte != 0)
                     {
-                        cpuH |= 0x01U;
+                        cpuHL.high |= 0x01U;
                         cpuF = 0x10U; // Set carry
                     }
-                    SETZ_ON_ZERO(cpuH);
+                    SETZ_ON_ZERO(cpuHL.high);
                 }
                     return 8;
                 case 0x05: // rlc L
                 {
-                    uint8_t tempByte = cpuL & 0x80U; // True if bit 7 is set
+                    uint8_t tempByte = cpuHL.low & 0x80U; // True if bit 7 is set
                     cpuF = 0x00; // Reset all other flags
-                    cpuL = cpuL << 1U;
+                    cpuHL.low = cpuHL.low << 1U;
                     if (tempByte != 0)
                     {
-                        cpuL |= 0x01U;
+                        cpuHL.low |= 0x01U;
                         cpuF = 0x10U; // Set carry
                     }
-                    SETZ_ON_ZERO(cpuL);
+                    SETZ_ON_ZERO(cpuHL.low);
                 }
                     return 8;
                 case 0x06: // rlc (HL)
@@ -4361,86 +4261,86 @@ int Gbc::performOp() {
                     return 8;
                 case 0x08: // rrc B
                 {
-                    uint8_t tempByte = cpuB & 0x01U;
+                    uint8_t tempByte = cpuBC.high & 0x01U;
                     cpuF = 0x00;
-                    cpuB = cpuB >> 1U;
-                    cpuB &= 0x7fU;
+                    cpuBC.high = cpuBC.high >> 1U;
+                    cpuBC.high &= 0x7fU;
                     if (tempByte != 0)
                     {
                         cpuF = 0x10U;
-                        cpuB |= 0x80U;
+                        cpuBC.high |= 0x80U;
                     }
-                    SETZ_ON_ZERO(cpuB);
+                    SETZ_ON_ZERO(cpuBC.high);
                 }
                     return 8;
                 case 0x09: // rrc C
                 {
-                    uint8_t tempByte = cpuC & 0x01U;
+                    uint8_t tempByte = cpuBC.low & 0x01U;
                     cpuF = 0x00;
-                    cpuC = cpuC >> 1U;
-                    cpuC &= 0x7fU;
+                    cpuBC.low = cpuBC.low >> 1U;
+                    cpuBC.low &= 0x7fU;
                     if (tempByte != 0)
                     {
                         cpuF = 0x10U;
-                        cpuC |= 0x80U;
+                        cpuBC.low |= 0x80U;
                     }
-                    SETZ_ON_ZERO(cpuC);
+                    SETZ_ON_ZERO(cpuBC.low);
                 }
                     return 8;
                 case 0x0a: // rrc D
                 {
-                    uint8_t tempByte = cpuD & 0x01U;
+                    uint8_t tempByte = cpuDE.high & 0x01U;
                     cpuF = 0x00;
-                    cpuD = cpuD >> 1U;
-                    cpuD &= 0x7fU;
+                    cpuDE.high = cpuDE.high >> 1U;
+                    cpuDE.high &= 0x7fU;
                     if (tempByte != 0)
                     {
                         cpuF = 0x10U;
-                        cpuD |= 0x80U;
+                        cpuDE.high |= 0x80U;
                     }
-                    SETZ_ON_ZERO(cpuD);
+                    SETZ_ON_ZERO(cpuDE.high);
                 }
                     return 8;
                 case 0x0b: // rrc E
                 {
-                    uint8_t tempByte = cpuE & 0x01U;
+                    uint8_t tempByte = cpuDE.low & 0x01U;
                     cpuF = 0x00;
-                    cpuE = cpuE >> 1U;
-                    cpuE &= 0x7fU;
+                    cpuDE.low = cpuDE.low >> 1U;
+                    cpuDE.low &= 0x7fU;
                     if (tempByte != 0)
                     {
                         cpuF = 0x10U;
-                        cpuE |= 0x80U;
+                        cpuDE.low |= 0x80U;
                     }
-                    SETZ_ON_ZERO(cpuE);
+                    SETZ_ON_ZERO(cpuDE.low);
                 }
                     return 8;
                 case 0x0c: // rrc H
                 {
-                    uint8_t tempByte = cpuH & 0x01U;
+                    uint8_t tempByte = cpuHL.high & 0x01U;
                     cpuF = 0x00;
-                    cpuH = cpuH >> 1U;
-                    cpuH &= 0x7fU;
+                    cpuHL.high = cpuHL.high >> 1U;
+                    cpuHL.high &= 0x7fU;
                     if (tempByte != 0)
                     {
                         cpuF = 0x10U;
-                        cpuH |= 0x80U;
+                        cpuHL.high |= 0x80U;
                     }
-                    SETZ_ON_ZERO(cpuH);
+                    SETZ_ON_ZERO(cpuHL.high);
                 }
                     return 8;
                 case 0x0d: // rrc L
                 {
-                    uint8_t tempByte = cpuL & 0x01U;
+                    uint8_t tempByte = cpuHL.low & 0x01U;
                     cpuF = 0x00;
-                    cpuL = cpuL >> 1U;
-                    cpuL &= 0x7fU;
+                    cpuHL.low = cpuHL.low >> 1U;
+                    cpuHL.low &= 0x7fU;
                     if (tempByte != 0)
                     {
                         cpuF = 0x10U;
-                        cpuL |= 0x80U;
+                        cpuHL.low |= 0x80U;
                     }
-                    SETZ_ON_ZERO(cpuL);
+                    SETZ_ON_ZERO(cpuHL.low);
                 }
                     return 8;
                 case 0x0e: // rrc (HL)
@@ -4478,78 +4378,78 @@ int Gbc::performOp() {
                 {
                     uint8_t tempByte = cpuF & 0x10U; // True if carry flag was set
                     cpuF = 0x00;
-                    SETC_ON_COND((cpuB & 0x80U) != 0); // Copy bit 7 to carry bit
-                    cpuB = cpuB << 1U;
+                    SETC_ON_COND((cpuBC.high & 0x80U) != 0); // Copy bit 7 to carry bit
+                    cpuBC.high = cpuBC.high << 1U;
                     if (tempByte != 0)
                     {
-                        cpuB |= 0x01U; // Copy carry flag to bit 0
+                        cpuBC.high |= 0x01U; // Copy carry flag to bit 0
                     }
-                    SETZ_ON_ZERO(cpuB);
+                    SETZ_ON_ZERO(cpuBC.high);
                 }
                     return 8;
                 case 0x11: // rl C
                 {
                     uint8_t tempByte = cpuF & 0x10U; // True if carry flag was set
                     cpuF = 0x00;
-                    SETC_ON_COND((cpuC & 0x80U) != 0); // Copy bit 7 to carry bit
-                    cpuC = cpuC << 1U;
+                    SETC_ON_COND((cpuBC.low & 0x80U) != 0); // Copy bit 7 to carry bit
+                    cpuBC.low = cpuBC.low << 1U;
                     if (tempByte != 0)
                     {
-                        cpuC |= 0x01U; // Copy carry flag to bit 0
+                        cpuBC.low |= 0x01U; // Copy carry flag to bit 0
                     }
-                    SETZ_ON_ZERO(cpuC);
+                    SETZ_ON_ZERO(cpuBC.low);
                 }
                     return 8;
                 case 0x12: // rl D
                 {
                     uint8_t tempByte = cpuF & 0x10U; // True if carry flag was set
                     cpuF = 0x00;
-                    SETC_ON_COND((cpuD & 0x80U) != 0); // Copy bit 7 to carry bit
-                    cpuD = cpuD << 1U;
+                    SETC_ON_COND((cpuDE.high & 0x80U) != 0); // Copy bit 7 to carry bit
+                    cpuDE.high = cpuDE.high << 1U;
                     if (tempByte != 0)
                     {
-                        cpuD |= 0x01U; // Copy carry flag to bit 0
+                        cpuDE.high |= 0x01U; // Copy carry flag to bit 0
                     }
-                    SETZ_ON_ZERO(cpuD);
+                    SETZ_ON_ZERO(cpuDE.high);
                 }
                     return 8;
                 case 0x13: // rl E
                 {
                     uint8_t tempByte = cpuF & 0x10U; // True if carry flag was set
                     cpuF = 0x00;
-                    SETC_ON_COND((cpuE & 0x80U) != 0); // Copy bit 7 to carry bit
-                    cpuE = cpuE << 1U;
+                    SETC_ON_COND((cpuDE.low & 0x80U) != 0); // Copy bit 7 to carry bit
+                    cpuDE.low = cpuDE.low << 1U;
                     if (tempByte != 0)
                     {
-                        cpuE |= 0x01U; // Copy carry flag to bit 0
+                        cpuDE.low |= 0x01U; // Copy carry flag to bit 0
                     }
-                    SETZ_ON_ZERO(cpuE);
+                    SETZ_ON_ZERO(cpuDE.low);
                 }
                     return 8;
                 case 0x14: // rl H
                 {
                     uint8_t tempByte = cpuF & 0x10U; // True if carry flag was set
                     cpuF = 0x00;
-                    SETC_ON_COND((cpuH & 0x80U) != 0); // Copy bit 7 to carry bit
-                    cpuH = cpuH << 1U;
+                    SETC_ON_COND((cpuHL.high & 0x80U) != 0); // Copy bit 7 to carry bit
+                    cpuHL.high = cpuHL.high << 1U;
                     if (tempByte != 0)
                     {
-                        cpuH |= 0x01U; // Copy carry flag to bit 0
+                        cpuHL.high |= 0x01U; // Copy carry flag to bit 0
                     }
-                    SETZ_ON_ZERO(cpuH);
+                    SETZ_ON_ZERO(cpuHL.high);
                 }
                     return 8;
                 case 0x15: // rl L
                 {
                     uint8_t tempByte = cpuF & 0x10U; // True if carry flag was set
                     cpuF = 0x00;
-                    SETC_ON_COND((cpuL & 0x80U) != 0); // Copy bit 7 to carry bit
-                    cpuL = cpuL << 1U;
+                    SETC_ON_COND((cpuHL.low & 0x80U) != 0); // Copy bit 7 to carry bit
+                    cpuHL.low = cpuHL.low << 1U;
                     if (tempByte != 0)
                     {
-                        cpuL |= 0x01U; // Copy carry flag to bit 0
+                        cpuHL.low |= 0x01U; // Copy carry flag to bit 0
                     }
-                    SETZ_ON_ZERO(cpuL);
+                    SETZ_ON_ZERO(cpuHL.low);
                 }
                     return 8;
                 case 0x16: // rl (HL)
@@ -4583,92 +4483,92 @@ int Gbc::performOp() {
                     return 8;
                 case 0x18: // rr B (9-bit rotation incl carry bit)
                 {
-                    uint8_t tempByte = cpuB & 0x01U;
+                    uint8_t tempByte = cpuBC.high & 0x01U;
                     uint8_t tempByte2 = cpuF & 0x10U;
-                    cpuB = cpuB >> 1U;
-                    cpuB = cpuB & 0x7fU;
+                    cpuBC.high = cpuBC.high >> 1U;
+                    cpuBC.high = cpuBC.high & 0x7fU;
                     cpuF = 0x00;
                     if (tempByte2 != 0x00)
                     {
-                        cpuB |= 0x80U;
+                        cpuBC.high |= 0x80U;
                     }
                     SETC_ON_COND(tempByte != 0x00);
-                    SETZ_ON_ZERO(cpuB);
+                    SETZ_ON_ZERO(cpuBC.high);
                 }
                     return 8;
                 case 0x19: // rr C
                 {
-                    uint8_t tempByte = cpuC & 0x01U;
+                    uint8_t tempByte = cpuBC.low & 0x01U;
                     uint8_t tempByte2 = cpuF & 0x10U;
-                    cpuC = cpuC >> 1U;
-                    cpuC = cpuC & 0x7fU;
+                    cpuBC.low = cpuBC.low >> 1U;
+                    cpuBC.low = cpuBC.low & 0x7fU;
                     cpuF = 0x00;
                     if (tempByte2 != 0x00)
                     {
-                        cpuC |= 0x80U;
+                        cpuBC.low |= 0x80U;
                     }
                     SETC_ON_COND(tempByte != 0x00);
-                    SETZ_ON_ZERO(cpuC);
+                    SETZ_ON_ZERO(cpuBC.low);
                 }
                     return 8;
                 case 0x1a: // rr D
                 {
-                    uint8_t tempByte = cpuD & 0x01U;
+                    uint8_t tempByte = cpuDE.high & 0x01U;
                     uint8_t tempByte2 = cpuF & 0x10U;
-                    cpuD = cpuD >> 1U;
-                    cpuD = cpuD & 0x7fU;
+                    cpuDE.high = cpuDE.high >> 1U;
+                    cpuDE.high = cpuDE.high & 0x7fU;
                     cpuF = 0x00;
                     if (tempByte2 != 0x00)
                     {
-                        cpuD |= 0x80U;
+                        cpuDE.high |= 0x80U;
                     }
                     SETC_ON_COND(tempByte != 0x00);
-                    SETZ_ON_ZERO(cpuD);
+                    SETZ_ON_ZERO(cpuDE.high);
                 }
                     return 8;
                 case 0x1b: // rr E
                 {
-                    uint8_t tempByte = cpuE & 0x01U;
+                    uint8_t tempByte = cpuDE.low & 0x01U;
                     uint8_t tempByte2 = cpuF & 0x10U;
-                    cpuE = cpuE >> 1U;
-                    cpuE = cpuE & 0x7fU;
+                    cpuDE.low = cpuDE.low >> 1U;
+                    cpuDE.low = cpuDE.low & 0x7fU;
                     cpuF = 0x00;
                     if (tempByte2 != 0x00)
                     {
-                        cpuE |= 0x80U;
+                        cpuDE.low |= 0x80U;
                     }
                     SETC_ON_COND(tempByte != 0x00);
-                    SETZ_ON_ZERO(cpuE);
+                    SETZ_ON_ZERO(cpuDE.low);
                 }
                     return 8;
                 case 0x1c: // rr H
                 {
-                    uint8_t tempByte = cpuH & 0x01U;
+                    uint8_t tempByte = cpuHL.high & 0x01U;
                     uint8_t tempByte2 = cpuF & 0x10U;
-                    cpuH = cpuH >> 1U;
-                    cpuH = cpuH & 0x7fU;
+                    cpuHL.high = cpuHL.high >> 1U;
+                    cpuHL.high = cpuHL.high & 0x7fU;
                     cpuF = 0x00;
                     if (tempByte2 != 0x00)
                     {
-                        cpuH |= 0x80U;
+                        cpuHL.high |= 0x80U;
                     }
                     SETC_ON_COND(tempByte != 0x00);
-                    SETZ_ON_ZERO(cpuH);
+                    SETZ_ON_ZERO(cpuHL.high);
                 }
                     return 8;
                 case 0x1d: // rr L
                 {
-                    uint8_t tempByte = cpuL & 0x01U;
+                    uint8_t tempByte = cpuHL.low & 0x01U;
                     uint8_t tempByte2 = cpuF & 0x10U;
-                    cpuL = cpuL >> 1U;
-                    cpuL = cpuL & 0x7fU;
+                    cpuHL.low = cpuHL.low >> 1U;
+                    cpuHL.low = cpuHL.low & 0x7fU;
                     cpuF = 0x00;
                     if (tempByte2 != 0x00)
                     {
-                        cpuL |= 0x80U;
+                        cpuHL.low |= 0x80U;
                     }
                     SETC_ON_COND(tempByte != 0x00);
-                    SETZ_ON_ZERO(cpuL);
+                    SETZ_ON_ZERO(cpuHL.low);
                 }
                     return 8;
                 case 0x1e: // rr (HL)
@@ -4706,39 +4606,39 @@ int Gbc::performOp() {
                     return 8;
                 case 0x20: // sla B (shift B left arithmetically)
                     cpuF = 0x00;
-                    SETC_ON_COND((cpuB & 0x80U) != 0x00);
-                    cpuB = cpuB << 1U;
-                    SETZ_ON_ZERO(cpuB);
+                    SETC_ON_COND((cpuBC.high & 0x80U) != 0x00);
+                    cpuBC.high = cpuBC.high << 1U;
+                    SETZ_ON_ZERO(cpuBC.high);
                     return 8;
                 case 0x21: // sla C
                     cpuF = 0x00;
-                    SETC_ON_COND((cpuC & 0x80U) != 0x00);
-                    cpuC = cpuC << 1U;
-                    SETZ_ON_ZERO(cpuC);
+                    SETC_ON_COND((cpuBC.low & 0x80U) != 0x00);
+                    cpuBC.low = cpuBC.low << 1U;
+                    SETZ_ON_ZERO(cpuBC.low);
                     return 8;
                 case 0x22: // sla D
                     cpuF = 0x00;
-                    SETC_ON_COND((cpuD & 0x80U) != 0x00);
-                    cpuD = cpuD << 1U;
-                    SETZ_ON_ZERO(cpuD);
+                    SETC_ON_COND((cpuDE.high & 0x80U) != 0x00);
+                    cpuDE.high = cpuDE.high << 1U;
+                    SETZ_ON_ZERO(cpuDE.high);
                     return 8;
                 case 0x23: // sla E
                     cpuF = 0x00;
-                    SETC_ON_COND((cpuE & 0x80U) != 0x00);
-                    cpuE = cpuE << 1U;
-                    SETZ_ON_ZERO(cpuE);
+                    SETC_ON_COND((cpuDE.low & 0x80U) != 0x00);
+                    cpuDE.low = cpuDE.low << 1U;
+                    SETZ_ON_ZERO(cpuDE.low);
                     return 8;
                 case 0x24: // sla H
                     cpuF = 0x00;
-                    SETC_ON_COND((cpuH & 0x80U) != 0x00);
-                    cpuH = cpuH << 1U;
-                    SETZ_ON_ZERO(cpuH);
+                    SETC_ON_COND((cpuHL.high & 0x80U) != 0x00);
+                    cpuHL.high = cpuHL.high << 1U;
+                    SETZ_ON_ZERO(cpuHL.high);
                     return 8;
                 case 0x25: // sla L
                     cpuF = 0x00;
-                    SETC_ON_COND((cpuL & 0x80U) != 0x00);
-                    cpuL = cpuL << 1U;
-                    SETZ_ON_ZERO(cpuL);
+                    SETC_ON_COND((cpuHL.low & 0x80U) != 0x00);
+                    cpuHL.low = cpuHL.low << 1U;
+                    SETZ_ON_ZERO(cpuHL.low);
                     return 8;
                 case 0x26: // sla (HL)
                 {
@@ -4760,61 +4660,61 @@ int Gbc::performOp() {
                 case 0x28: // sra B (shift B right arithmetically - preserve sign bit)
                 {
                     cpuF = 0x00;
-                    SETC_ON_COND((cpuB & 0x01U) != 0x00);
-                    uint8_t tempByte = cpuB & 0x80U;
-                    cpuB = cpuB >> 1U;
-                    cpuB |= tempByte;
-                    SETZ_ON_ZERO(cpuB);
+                    SETC_ON_COND((cpuBC.high & 0x01U) != 0x00);
+                    uint8_t tempByte = cpuBC.high & 0x80U;
+                    cpuBC.high = cpuBC.high >> 1U;
+                    cpuBC.high |= tempByte;
+                    SETZ_ON_ZERO(cpuBC.high);
                 }
                     return 8;
                 case 0x29: // sra C
                 {
                     cpuF = 0x00;
-                    SETC_ON_COND((cpuC & 0x01U) != 0x00);
-                    uint8_t tempByte = cpuC & 0x80U;
-                    cpuC = cpuC >> 1U;
-                    cpuC |= tempByte;
-                    SETZ_ON_ZERO(cpuC);
+                    SETC_ON_COND((cpuBC.low & 0x01U) != 0x00);
+                    uint8_t tempByte = cpuBC.low & 0x80U;
+                    cpuBC.low = cpuBC.low >> 1U;
+                    cpuBC.low |= tempByte;
+                    SETZ_ON_ZERO(cpuBC.low);
                 }
                     return 8;
                 case 0x2a: // sra D
                 {
                     cpuF = 0x00;
-                    SETC_ON_COND((cpuD & 0x01U) != 0x00);
-                    uint8_t tempByte = cpuD & 0x80U;
-                    cpuD = cpuD >> 1U;
-                    cpuD |= tempByte;
-                    SETZ_ON_ZERO(cpuD);
+                    SETC_ON_COND((cpuDE.high & 0x01U) != 0x00);
+                    uint8_t tempByte = cpuDE.high & 0x80U;
+                    cpuDE.high = cpuDE.high >> 1U;
+                    cpuDE.high |= tempByte;
+                    SETZ_ON_ZERO(cpuDE.high);
                 }
                     return 8;
                 case 0x2b: // sra E
                 {
                     cpuF = 0x00;
-                    SETC_ON_COND((cpuE & 0x01U) != 0x00);
-                    uint8_t tempByte = cpuE & 0x80U;
-                    cpuE = cpuE >> 1U;
-                    cpuE |= tempByte;
-                    SETZ_ON_ZERO(cpuE);
+                    SETC_ON_COND((cpuDE.low & 0x01U) != 0x00);
+                    uint8_t tempByte = cpuDE.low & 0x80U;
+                    cpuDE.low = cpuDE.low >> 1U;
+                    cpuDE.low |= tempByte;
+                    SETZ_ON_ZERO(cpuDE.low);
                 }
                     return 8;
                 case 0x2c: // sra H
                 {
                     cpuF = 0x00;
-                    SETC_ON_COND((cpuH & 0x01U) != 0x00);
-                    uint8_t tempByte = cpuH & 0x80U;
-                    cpuH = cpuH >> 1U;
-                    cpuH |= tempByte;
-                    SETZ_ON_ZERO(cpuH);
+                    SETC_ON_COND((cpuHL.high & 0x01U) != 0x00);
+                    uint8_t tempByte = cpuHL.high & 0x80U;
+                    cpuHL.high = cpuHL.high >> 1U;
+                    cpuHL.high |= tempByte;
+                    SETZ_ON_ZERO(cpuHL.high);
                 }
                     return 8;
                 case 0x2d: // sra L
                 {
                     cpuF = 0x00;
-                    SETC_ON_COND((cpuL & 0x01U) != 0x00);
-                    uint8_t tempByte = cpuL & 0x80U;
-                    cpuL = cpuL >> 1U;
-                    cpuL |= tempByte;
-                    SETZ_ON_ZERO(cpuL);
+                    SETC_ON_COND((cpuHL.low & 0x01U) != 0x00);
+                    uint8_t tempByte = cpuHL.low & 0x80U;
+                    cpuHL.low = cpuHL.low >> 1U;
+                    cpuHL.low |= tempByte;
+                    SETZ_ON_ZERO(cpuHL.low);
                 }
                     return 8;
                 case 0x2e: // sra (HL)
@@ -4842,62 +4742,62 @@ int Gbc::performOp() {
                     return 8;
                 case 0x30: // swap B
                 {
-                    uint8_t tempByte = (cpuB << 4U);
-                    cpuB = cpuB >> 4U;
-                    cpuB &= 0x0fU;
-                    cpuB |= tempByte;
+                    uint8_t tempByte = (cpuBC.high << 4U);
+                    cpuBC.high = cpuBC.high >> 4U;
+                    cpuBC.high &= 0x0fU;
+                    cpuBC.high |= tempByte;
                     cpuF = 0x00;
-                    SETZ_ON_ZERO(cpuB);
+                    SETZ_ON_ZERO(cpuBC.high);
                 }
                     return 8;
                 case 0x31: // swap C
                 {
-                    uint8_t tempByte = (cpuC << 4U);
-                    cpuC = cpuC >> 4U;
-                    cpuC &= 0x0fU;
-                    cpuC |= tempByte;
+                    uint8_t tempByte = (cpuBC.low << 4U);
+                    cpuBC.low = cpuBC.low >> 4U;
+                    cpuBC.low &= 0x0fU;
+                    cpuBC.low |= tempByte;
                     cpuF = 0x00;
-                    SETZ_ON_ZERO(cpuC);
+                    SETZ_ON_ZERO(cpuBC.low);
                 }
                     return 8;
                 case 0x32: // swap D
                 {
-                    uint8_t tempByte = (cpuD << 4U);
-                    cpuD = cpuD >> 4U;
-                    cpuD &= 0x0fU;
-                    cpuD |= tempByte;
+                    uint8_t tempByte = (cpuDE.high << 4U);
+                    cpuDE.high = cpuDE.high >> 4U;
+                    cpuDE.high &= 0x0fU;
+                    cpuDE.high |= tempByte;
                     cpuF = 0x00;
-                    SETZ_ON_ZERO(cpuD);
+                    SETZ_ON_ZERO(cpuDE.high);
                 }
                     return 8;
                 case 0x33: // swap E
                 {
-                    uint8_t tempByte = (cpuE << 4U);
-                    cpuE = cpuE >> 4U;
-                    cpuE &= 0x0fU;
-                    cpuE |= tempByte;
+                    uint8_t tempByte = (cpuDE.low << 4U);
+                    cpuDE.low = cpuDE.low >> 4U;
+                    cpuDE.low &= 0x0fU;
+                    cpuDE.low |= tempByte;
                     cpuF = 0x00;
-                    SETZ_ON_ZERO(cpuE);
+                    SETZ_ON_ZERO(cpuDE.low);
                 }
                     return 8;
                 case 0x34: // swap H
                 {
-                    uint8_t tempByte = (cpuH << 4U);
-                    cpuH = cpuH >> 4U;
-                    cpuH &= 0x0fU;
-                    cpuH |= tempByte;
+                    uint8_t tempByte = (cpuHL.high << 4U);
+                    cpuHL.high = cpuHL.high >> 4U;
+                    cpuHL.high &= 0x0fU;
+                    cpuHL.high |= tempByte;
                     cpuF = 0x00;
-                    SETZ_ON_ZERO(cpuH);
+                    SETZ_ON_ZERO(cpuHL.high);
                 }
                     return 8;
                 case 0x35: // swap L
                 {
-                    uint8_t tempByte = (cpuL << 4U);
-                    cpuL = cpuL >> 4U;
-                    cpuL &= 0x0fU;
-                    cpuL |= tempByte;
+                    uint8_t tempByte = (cpuHL.low << 4U);
+                    cpuHL.low = cpuHL.low >> 4U;
+                    cpuHL.low &= 0x0fU;
+                    cpuHL.low |= tempByte;
                     cpuF = 0x00;
-                    SETZ_ON_ZERO(cpuL);
+                    SETZ_ON_ZERO(cpuHL.low);
                 }
                     return 8;
                 case 0x36: // swap (HL)
@@ -4925,45 +4825,45 @@ int Gbc::performOp() {
                     return 8;
                 case 0x38: // srl B
                     cpuF = 0x00;
-                    SETC_ON_COND((cpuB & 0x01U) != 0x00);
-                    cpuB = cpuB >> 1U;
-                    cpuB &= 0x7fU;
-                    SETZ_ON_ZERO(cpuB);
+                    SETC_ON_COND((cpuBC.high & 0x01U) != 0x00);
+                    cpuBC.high = cpuBC.high >> 1U;
+                    cpuBC.high &= 0x7fU;
+                    SETZ_ON_ZERO(cpuBC.high);
                     return 8;
                 case 0x39: // srl C
                     cpuF = 0x00;
-                    SETC_ON_COND((cpuC & 0x01U) != 0x00);
-                    cpuC = cpuC >> 1U;
-                    cpuC &= 0x7fU;
-                    SETZ_ON_ZERO(cpuC);
+                    SETC_ON_COND((cpuBC.low & 0x01U) != 0x00);
+                    cpuBC.low = cpuBC.low >> 1U;
+                    cpuBC.low &= 0x7fU;
+                    SETZ_ON_ZERO(cpuBC.low);
                     return 8;
                 case 0x3a: // srl D
                     cpuF = 0x00;
-                    SETC_ON_COND((cpuD & 0x01U) != 0x00);
-                    cpuD = cpuD >> 1U;
-                    cpuD &= 0x7fU;
-                    SETZ_ON_ZERO(cpuD);
+                    SETC_ON_COND((cpuDE.high & 0x01U) != 0x00);
+                    cpuDE.high = cpuDE.high >> 1U;
+                    cpuDE.high &= 0x7fU;
+                    SETZ_ON_ZERO(cpuDE.high);
                     return 8;
                 case 0x3b: // srl E
                     cpuF = 0x00;
-                    SETC_ON_COND((cpuE & 0x01U) != 0x00);
-                    cpuE = cpuE >> 1U;
-                    cpuE &= 0x7fU;
-                    SETZ_ON_ZERO(cpuE);
+                    SETC_ON_COND((cpuDE.low & 0x01U) != 0x00);
+                    cpuDE.low = cpuDE.low >> 1U;
+                    cpuDE.low &= 0x7fU;
+                    SETZ_ON_ZERO(cpuDE.low);
                     return 8;
                 case 0x3c: // srl H
                     cpuF = 0x00;
-                    SETC_ON_COND((cpuH & 0x01U) != 0x00);
-                    cpuH = cpuH >> 1U;
-                    cpuH &= 0x7fU;
-                    SETZ_ON_ZERO(cpuH);
+                    SETC_ON_COND((cpuHL.high & 0x01U) != 0x00);
+                    cpuHL.high = cpuHL.high >> 1U;
+                    cpuHL.high &= 0x7fU;
+                    SETZ_ON_ZERO(cpuHL.high);
                     return 8;
                 case 0x3d: // srl L
                     cpuF = 0x00;
-                    SETC_ON_COND((cpuL & 0x01U) != 0x00);
-                    cpuL = cpuL >> 1U;
-                    cpuL &= 0x7fU;
-                    SETZ_ON_ZERO(cpuL);
+                    SETC_ON_COND((cpuHL.low & 0x01U) != 0x00);
+                    cpuHL.low = cpuHL.low >> 1U;
+                    cpuHL.low &= 0x7fU;
+                    SETZ_ON_ZERO(cpuHL.low);
                     return 8;
                 case 0x3e: // srl (HL)
                 {
@@ -4987,32 +4887,32 @@ int Gbc::performOp() {
                 case 0x40: // Test bit 0 of B
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuB & 0x01U);
+                    SETZ_ON_ZERO(cpuBC.high & 0x01U);
                     return 8;
                 case 0x41: // Test bit 0 of C
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuC & 0x01U);
+                    SETZ_ON_ZERO(cpuBC.low & 0x01U);
                     return 8;
                 case 0x42: // Test bit 0 of D
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuD & 0x01U);
+                    SETZ_ON_ZERO(cpuDE.high & 0x01U);
                     return 8;
                 case 0x43: // Test bit 0 of E
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuE & 0x01U);
+                    SETZ_ON_ZERO(cpuDE.low & 0x01U);
                     return 8;
                 case 0x44: // Test bit 0 of H
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuH & 0x01U);
+                    SETZ_ON_ZERO(cpuHL.high & 0x01U);
                     return 8;
                 case 0x45: // Test bit 0 of L
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuL & 0x01U);
+                    SETZ_ON_ZERO(cpuHL.low & 0x01U);
                     return 8;
                 case 0x46: // Test bit 0 of (HL)
                     cpuF &= 0x30U;
@@ -5027,32 +4927,32 @@ int Gbc::performOp() {
                 case 0x48: // bit 1, B
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuB & 0x02U);
+                    SETZ_ON_ZERO(cpuBC.high & 0x02U);
                     return 8;
                 case 0x49: // bit 1, C
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuC & 0x02U);
+                    SETZ_ON_ZERO(cpuBC.low & 0x02U);
                     return 8;
                 case 0x4a: // bit 1, D
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuD & 0x02U);
+                    SETZ_ON_ZERO(cpuDE.high & 0x02U);
                     return 8;
                 case 0x4b: // bit 1, E
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuE & 0x02U);
+                    SETZ_ON_ZERO(cpuDE.low & 0x02U);
                     return 8;
                 case 0x4c: // bit 1, H
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuH & 0x02U);
+                    SETZ_ON_ZERO(cpuHL.high & 0x02U);
                     return 8;
                 case 0x4d: // bit 1, L
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuL & 0x02U);
+                    SETZ_ON_ZERO(cpuHL.low & 0x02U);
                     return 8;
                 case 0x4e: // bit 1, (HL)
                     cpuF &= 0x30U;
@@ -5067,32 +4967,32 @@ int Gbc::performOp() {
                 case 0x50: // bit 2, B
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuB & 0x04U);
+                    SETZ_ON_ZERO(cpuBC.high & 0x04U);
                     return 8;
                 case 0x51: // bit 2, C
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuC & 0x04U);
+                    SETZ_ON_ZERO(cpuBC.low & 0x04U);
                     return 8;
                 case 0x52: // bit 2, D
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuD & 0x04U);
+                    SETZ_ON_ZERO(cpuDE.high & 0x04U);
                     return 8;
                 case 0x53: // bit 2, E
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuE & 0x04U);
+                    SETZ_ON_ZERO(cpuDE.low & 0x04U);
                     return 8;
                 case 0x54: // bit 2, H
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuH & 0x04U);
+                    SETZ_ON_ZERO(cpuHL.high & 0x04U);
                     return 8;
                 case 0x55: // bit 2, L
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuL & 0x04U);
+                    SETZ_ON_ZERO(cpuHL.low & 0x04U);
                     return 8;
                 case 0x56: // bit 2, (HL)
                     cpuF &= 0x30U;
@@ -5107,32 +5007,32 @@ int Gbc::performOp() {
                 case 0x58: // bit 3, B
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuB & 0x08U);
+                    SETZ_ON_ZERO(cpuBC.high & 0x08U);
                     return 8;
                 case 0x59: // bit 3, C
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuC & 0x08U);
+                    SETZ_ON_ZERO(cpuBC.low & 0x08U);
                     return 8;
                 case 0x5a: // bit 3, D
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuD & 0x08U);
+                    SETZ_ON_ZERO(cpuDE.high & 0x08U);
                     return 8;
                 case 0x5b: // bit 3, E
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuE & 0x08U);
+                    SETZ_ON_ZERO(cpuDE.low & 0x08U);
                     return 8;
                 case 0x5c: // bit 3, H
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuH & 0x08U);
+                    SETZ_ON_ZERO(cpuHL.high & 0x08U);
                     return 8;
                 case 0x5d: // bit 3, L
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuL & 0x08U);
+                    SETZ_ON_ZERO(cpuHL.low & 0x08U);
                     return 8;
                 case 0x5e: // bit 3, (HL)
                     cpuF &= 0x30U;
@@ -5147,32 +5047,32 @@ int Gbc::performOp() {
                 case 0x60: // bit 4, B
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuB & 0x10U);
+                    SETZ_ON_ZERO(cpuBC.high & 0x10U);
                     return 8;
                 case 0x61: // bit 4, C
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuC & 0x10U);
+                    SETZ_ON_ZERO(cpuBC.low & 0x10U);
                     return 8;
                 case 0x62: // bit 4, D
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuD & 0x10U);
+                    SETZ_ON_ZERO(cpuDE.high & 0x10U);
                     return 8;
                 case 0x63: // bit 4, E
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuE & 0x10U);
+                    SETZ_ON_ZERO(cpuDE.low & 0x10U);
                     return 8;
                 case 0x64: // bit 4, H
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuH & 0x10U);
+                    SETZ_ON_ZERO(cpuHL.high & 0x10U);
                     return 8;
                 case 0x65: // bit 4, L
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuL & 0x10U);
+                    SETZ_ON_ZERO(cpuHL.low & 0x10U);
                     return 8;
                 case 0x66: // bit 4, (HL)
                     cpuF &= 0x30U;
@@ -5187,32 +5087,32 @@ int Gbc::performOp() {
                 case 0x68: // bit 5, B
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuB & 0x20U);
+                    SETZ_ON_ZERO(cpuBC.high & 0x20U);
                     return 8;
                 case 0x69: // bit 5, C
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuC & 0x20U);
+                    SETZ_ON_ZERO(cpuBC.low & 0x20U);
                     return 8;
                 case 0x6a: // bit 5, D
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuD & 0x20U);
+                    SETZ_ON_ZERO(cpuDE.high & 0x20U);
                     return 8;
                 case 0x6b: // bit 5, E
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuE & 0x20U);
+                    SETZ_ON_ZERO(cpuDE.low & 0x20U);
                     return 8;
                 case 0x6c: // bit 5, H
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuH & 0x20U);
+                    SETZ_ON_ZERO(cpuHL.high & 0x20U);
                     return 8;
                 case 0x6d: // bit 5, L
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuL & 0x20U);
+                    SETZ_ON_ZERO(cpuHL.low & 0x20U);
                     return 8;
                 case 0x6e: // bit 5, (HL)
                     cpuF &= 0x30U;
@@ -5227,32 +5127,32 @@ int Gbc::performOp() {
                 case 0x70: // bit 6, B
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuB & 0x40U);
+                    SETZ_ON_ZERO(cpuBC.high & 0x40U);
                     return 8;
                 case 0x71: // bit 6, C
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuC & 0x40U);
+                    SETZ_ON_ZERO(cpuBC.low & 0x40U);
                     return 8;
                 case 0x72: // bit 6, D
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuD & 0x40U);
+                    SETZ_ON_ZERO(cpuDE.high & 0x40U);
                     return 8;
                 case 0x73: // bit 6, E
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuE & 0x40U);
+                    SETZ_ON_ZERO(cpuDE.low & 0x40U);
                     return 8;
                 case 0x74: // bit 6, H
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuH & 0x40U);
+                    SETZ_ON_ZERO(cpuHL.high & 0x40U);
                     return 8;
                 case 0x75: // bit 6, L
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuL & 0x40U);
+                    SETZ_ON_ZERO(cpuHL.low & 0x40U);
                     return 8;
                 case 0x76: // bit 6, (HL)
                     cpuF &= 0x30U;
@@ -5267,32 +5167,32 @@ int Gbc::performOp() {
                 case 0x78: // bit 7, B
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuB & 0x80U);
+                    SETZ_ON_ZERO(cpuBC.high & 0x80U);
                     return 8;
                 case 0x79: // bit 7, C
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuC & 0x80U);
+                    SETZ_ON_ZERO(cpuBC.low & 0x80U);
                     return 8;
                 case 0x7a: // bit 7, D
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuD & 0x80U);
+                    SETZ_ON_ZERO(cpuDE.high & 0x80U);
                     return 8;
                 case 0x7b: // bit 7, E
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuE & 0x80U);
+                    SETZ_ON_ZERO(cpuDE.low & 0x80U);
                     return 8;
                 case 0x7c: // bit 7, H
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuH & 0x80U);
+                    SETZ_ON_ZERO(cpuHL.high & 0x80U);
                     return 8;
                 case 0x7d: // bit 7, L
                     cpuF &= 0x30U;
                     cpuF |= 0x20U;
-                    SETZ_ON_ZERO(cpuL & 0x80U);
+                    SETZ_ON_ZERO(cpuHL.low & 0x80U);
                     return 8;
                 case 0x7e: // bit 7, (HL)
                     cpuF &= 0x30U;
@@ -5305,22 +5205,22 @@ int Gbc::performOp() {
                     SETZ_ON_ZERO(cpuA & 0x80U);
                     return 8;
                 case 0x80: // res 0, B
-                    cpuB &= 0xfeU;
+                    cpuBC.high &= 0xfeU;
                     return 8;
                 case 0x81: // res 0, C
-                    cpuC &= 0xfeU;
+                    cpuBC.low &= 0xfeU;
                     return 8;
                 case 0x82: // res 0, D
-                    cpuD &= 0xfeU;
+                    cpuDE.high &= 0xfeU;
                     return 8;
                 case 0x83: // res 0, E
-                    cpuE &= 0xfeU;
+                    cpuDE.low &= 0xfeU;
                     return 8;
                 case 0x84: // res 0, H
-                    cpuH &= 0xfeU;
+                    cpuHL.high &= 0xfeU;
                     return 8;
                 case 0x85: // res 0, L
-                    cpuL &= 0xfeU;
+                    cpuHL.low &= 0xfeU;
                     return 8;
                 case 0x86: // res 0, (HL)
                 {
@@ -5332,22 +5232,22 @@ int Gbc::performOp() {
                     cpuA &= 0xfeU;
                     return 8;
                 case 0x88: // res 1, B
-                    cpuB &= 0xfdU;
+                    cpuBC.high &= 0xfdU;
                     return 8;
                 case 0x89: // res 1, C
-                    cpuC &= 0xfdU;
+                    cpuBC.low &= 0xfdU;
                     return 8;
                 case 0x8a: // res 1, D
-                    cpuD &= 0xfdU;
+                    cpuDE.high &= 0xfdU;
                     return 8;
                 case 0x8b: // res 1, E
-                    cpuE &= 0xfdU;
+                    cpuDE.low &= 0xfdU;
                     return 8;
                 case 0x8c: // res 1, H
-                    cpuH &= 0xfdU;
+                    cpuHL.high &= 0xfdU;
                     return 8;
                 case 0x8d: // res 1, L
-                    cpuL &= 0xfdU;
+                    cpuHL.low &= 0xfdU;
                     return 8;
                 case 0x8e: // res 1, (HL)
                 {
@@ -5359,22 +5259,22 @@ int Gbc::performOp() {
                     cpuA &= 0xfdU;
                     return 8;
                 case 0x90: // res 2, B
-                    cpuB &= 0xfbU;
+                    cpuBC.high &= 0xfbU;
                     return 8;
                 case 0x91: // res 2, C
-                    cpuC &= 0xfbU;
+                    cpuBC.low &= 0xfbU;
                     return 8;
                 case 0x92: // res 2, D
-                    cpuD &= 0xfbU;
+                    cpuDE.high &= 0xfbU;
                     return 8;
                 case 0x93: // res 2, E
-                    cpuE &= 0xfbU;
+                    cpuDE.low &= 0xfbU;
                     return 8;
                 case 0x94: // res 2, H
-                    cpuH &= 0xfbU;
+                    cpuHL.high &= 0xfbU;
                     return 8;
                 case 0x95: // res 2, L
-                    cpuL &= 0xfbU;
+                    cpuHL.low &= 0xfbU;
                     return 8;
                 case 0x96: // res 2, (HL)
                 {
@@ -5386,22 +5286,22 @@ int Gbc::performOp() {
                     cpuA &= 0xfbU;
                     return 8;
                 case 0x98: // res 3, B
-                    cpuB &= 0xf7U;
+                    cpuBC.high &= 0xf7U;
                     return 8;
                 case 0x99: // res 3, C
-                    cpuC &= 0xf7U;
+                    cpuBC.low &= 0xf7U;
                     return 8;
                 case 0x9a: // res 3, D
-                    cpuD &= 0xf7U;
+                    cpuDE.high &= 0xf7U;
                     return 8;
                 case 0x9b: // res 3, E
-                    cpuE &= 0xf7U;
+                    cpuDE.low &= 0xf7U;
                     return 8;
                 case 0x9c: // res 3, H
-                    cpuH &= 0xf7U;
+                    cpuHL.high &= 0xf7U;
                     return 8;
                 case 0x9d: // res 3, L
-                    cpuL &= 0xf7U;
+                    cpuHL.low &= 0xf7U;
                     return 8;
                 case 0x9e: // res 3, (HL)
                 {
@@ -5413,22 +5313,22 @@ int Gbc::performOp() {
                     cpuA &= 0xf7U;
                     return 8;
                 case 0xa0: // res 4, B
-                    cpuB &= 0xefU;
+                    cpuBC.high &= 0xefU;
                     return 8;
                 case 0xa1: // res 4, C
-                    cpuC &= 0xefU;
+                    cpuBC.low &= 0xefU;
                     return 8;
                 case 0xa2: // res 4, D
-                    cpuD &= 0xefU;
+                    cpuDE.high &= 0xefU;
                     return 8;
                 case 0xa3: // res 4, E
-                    cpuE &= 0xefU;
+                    cpuDE.low &= 0xefU;
                     return 8;
                 case 0xa4: // res 4, H
-                    cpuH &= 0xefU;
+                    cpuHL.high &= 0xefU;
                     return 8;
                 case 0xa5: // res 4, L
-                    cpuL &= 0xefU;
+                    cpuHL.low &= 0xefU;
                     return 8;
                 case 0xa6: // res 4, (HL)
                 {
@@ -5440,22 +5340,22 @@ int Gbc::performOp() {
                     cpuA &= 0xefU;
                     return 8;
                 case 0xa8: // res 5, B
-                    cpuB &= 0xdfU;
+                    cpuBC.high &= 0xdfU;
                     return 8;
                 case 0xa9: // res 5, C
-                    cpuC &= 0xdfU;
+                    cpuBC.low &= 0xdfU;
                     return 8;
                 case 0xaa: // res 5, D
-                    cpuD &= 0xdfU;
+                    cpuDE.high &= 0xdfU;
                     return 8;
                 case 0xab: // res 5, E
-                    cpuE &= 0xdfU;
+                    cpuDE.low &= 0xdfU;
                     return 8;
                 case 0xac: // res 5, H
-                    cpuH &= 0xdfU;
+                    cpuHL.high &= 0xdfU;
                     return 8;
                 case 0xad: // res 5, L
-                    cpuL &= 0xdfU;
+                    cpuHL.low &= 0xdfU;
                     return 8;
                 case 0xae: // res 5, (HL)
                 {
@@ -5467,22 +5367,22 @@ int Gbc::performOp() {
                     cpuA &= 0xdfU;
                     return 8;
                 case 0xb0: // res 6, B
-                    cpuB &= 0xbfU;
+                    cpuBC.high &= 0xbfU;
                     return 8;
                 case 0xb1: // res 6, C
-                    cpuC &= 0xbfU;
+                    cpuBC.low &= 0xbfU;
                     return 8;
                 case 0xb2: // res 6, D
-                    cpuD &= 0xbfU;
+                    cpuDE.high &= 0xbfU;
                     return 8;
                 case 0xb3: // res 6, E
-                    cpuE &= 0xbfU;
+                    cpuDE.low &= 0xbfU;
                     return 8;
                 case 0xb4: // res 6, H
-                    cpuH &= 0xbfU;
+                    cpuHL.high &= 0xbfU;
                     return 8;
                 case 0xb5: // res 6, L
-                    cpuL &= 0xbfU;
+                    cpuHL.low &= 0xbfU;
                     return 8;
                 case 0xb6: // res 6, (HL)
                 {
@@ -5494,22 +5394,22 @@ int Gbc::performOp() {
                     cpuA &= 0xbfU;
                     return 8;
                 case 0xb8: // res 7, B
-                    cpuB &= 0x7fU;
+                    cpuBC.high &= 0x7fU;
                     return 8;
                 case 0xb9: // res 7, C
-                    cpuC &= 0x7fU;
+                    cpuBC.low &= 0x7fU;
                     return 8;
                 case 0xba: // res 7, D
-                    cpuD &= 0x7fU;
+                    cpuDE.high &= 0x7fU;
                     return 8;
                 case 0xbb: // res 7, E
-                    cpuE &= 0x7fU;
+                    cpuDE.low &= 0x7fU;
                     return 8;
                 case 0xbc: // res 7, H
-                    cpuH &= 0x7fU;
+                    cpuHL.high &= 0x7fU;
                     return 8;
                 case 0xbd: // res 7, L
-                    cpuL &= 0x7fU;
+                    cpuHL.low &= 0x7fU;
                     return 8;
                 case 0xbe: // res 7, (HL)
                 {
@@ -5521,22 +5421,22 @@ int Gbc::performOp() {
                     cpuA &= 0x7fU;
                     return 8;
                 case 0xc0: // set 0, B
-                    cpuB |= 0x01U;
+                    cpuBC.high |= 0x01U;
                     return 8;
                 case 0xc1: // set 0, C
-                    cpuC |= 0x01U;
+                    cpuBC.low |= 0x01U;
                     return 8;
                 case 0xc2: // set 0, D
-                    cpuD |= 0x01U;
+                    cpuDE.high |= 0x01U;
                     return 8;
                 case 0xc3: // set 0, E
-                    cpuE |= 0x01U;
+                    cpuDE.low |= 0x01U;
                     return 8;
                 case 0xc4: // set 0, H
-                    cpuH |= 0x01U;
+                    cpuHL.high |= 0x01U;
                     return 8;
                 case 0xc5: // set 0, L
-                    cpuL |= 0x01U;
+                    cpuHL.low |= 0x01U;
                     return 8;
                 case 0xc6: // set 0, (HL)
                 {
@@ -5548,22 +5448,22 @@ int Gbc::performOp() {
                     cpuA |= 0x01U;
                     return 8;
                 case 0xc8: // set 1, B
-                    cpuB |= 0x02U;
+                    cpuBC.high |= 0x02U;
                     return 8;
                 case 0xc9: // set 1, C
-                    cpuC |= 0x02U;
+                    cpuBC.low |= 0x02U;
                     return 8;
                 case 0xca: // set 1, D
-                    cpuD |= 0x02U;
+                    cpuDE.high |= 0x02U;
                     return 8;
                 case 0xcb: // set 1, E
-                    cpuE |= 0x02U;
+                    cpuDE.low |= 0x02U;
                     return 8;
                 case 0xcc: // set 1, H
-                    cpuH |= 0x02U;
+                    cpuHL.high |= 0x02U;
                     return 8;
                 case 0xcd: // set 1, L
-                    cpuL |= 0x02U;
+                    cpuHL.low |= 0x02U;
                     return 8;
                 case 0xce: // set 1, (HL)
                 {
@@ -5575,22 +5475,22 @@ int Gbc::performOp() {
                     cpuA |= 0x02U;
                     return 8;
                 case 0xd0: // set 2, B
-                    cpuB |= 0x04U;
+                    cpuBC.high |= 0x04U;
                     return 8;
                 case 0xd1: // set 2, C
-                    cpuC |= 0x04U;
+                    cpuBC.low |= 0x04U;
                     return 8;
                 case 0xd2: // set 2, D
-                    cpuD |= 0x04U;
+                    cpuDE.high |= 0x04U;
                     return 8;
                 case 0xd3: // set 2, E
-                    cpuE |= 0x04U;
+                    cpuDE.low |= 0x04U;
                     return 8;
                 case 0xd4: // set 2, H
-                    cpuH |= 0x04U;
+                    cpuHL.high |= 0x04U;
                     return 8;
                 case 0xd5: // set 2, L
-                    cpuL |= 0x04U;
+                    cpuHL.low |= 0x04U;
                     return 8;
                 case 0xd6: // set 2, (HL)
                 {
@@ -5602,22 +5502,22 @@ int Gbc::performOp() {
                     cpuA |= 0x04U;
                     return 8;
                 case 0xd8: // set 3, B
-                    cpuB |= 0x08U;
+                    cpuBC.high |= 0x08U;
                     return 8;
                 case 0xd9: // set 3, C
-                    cpuC |= 0x08U;
+                    cpuBC.low |= 0x08U;
                     return 8;
                 case 0xda: // set 3, D
-                    cpuD |= 0x08U;
+                    cpuDE.high |= 0x08U;
                     return 8;
                 case 0xdb: // set 3, E
-                    cpuE |= 0x08U;
+                    cpuDE.low |= 0x08U;
                     return 8;
                 case 0xdc: // set 3, H
-                    cpuH |= 0x08U;
+                    cpuHL.high |= 0x08U;
                     return 8;
                 case 0xdd: // set 3, L
-                    cpuL |= 0x08U;
+                    cpuHL.low |= 0x08U;
                     return 8;
                 case 0xde: // set 3, (HL)
                 {
@@ -5629,22 +5529,22 @@ int Gbc::performOp() {
                     cpuA |= 0x08U;
                     return 8;
                 case 0xe0: // set 4, B
-                    cpuB |= 0x10U;
+                    cpuBC.high |= 0x10U;
                     return 8;
                 case 0xe1: // set 4, C
-                    cpuC |= 0x10U;
+                    cpuBC.low |= 0x10U;
                     return 8;
                 case 0xe2: // set 4, D
-                    cpuD |= 0x10U;
+                    cpuDE.high |= 0x10U;
                     return 8;
                 case 0xe3: // set 4, E
-                    cpuE |= 0x10U;
+                    cpuDE.low |= 0x10U;
                     return 8;
                 case 0xe4: // set 4, H
-                    cpuH |= 0x10U;
+                    cpuHL.high |= 0x10U;
                     return 8;
                 case 0xe5: // set 4, L
-                    cpuL |= 0x10U;
+                    cpuHL.low |= 0x10U;
                     return 8;
                 case 0xe6: // set 4, (HL)
                 {
@@ -5656,22 +5556,22 @@ int Gbc::performOp() {
                     cpuA |= 0x10U;
                     return 8;
                 case 0xe8: // set 5, B
-                    cpuB |= 0x20U;
+                    cpuBC.high |= 0x20U;
                     return 8;
                 case 0xe9: // set 5, C
-                    cpuC |= 0x20U;
+                    cpuBC.low |= 0x20U;
                     return 8;
                 case 0xea: // set 5, D
-                    cpuD |= 0x20U;
+                    cpuDE.high |= 0x20U;
                     return 8;
                 case 0xeb: // set 5, E
-                    cpuE |= 0x20U;
+                    cpuDE.low |= 0x20U;
                     return 8;
                 case 0xec: // set 5, H
-                    cpuH |= 0x20U;
+                    cpuHL.high |= 0x20U;
                     return 8;
                 case 0xed: // set 5, L
-                    cpuL |= 0x20U;
+                    cpuHL.low |= 0x20U;
                     return 8;
                 case 0xee: // set 5, (HL)
                 {
@@ -5683,22 +5583,22 @@ int Gbc::performOp() {
                     cpuA |= 0x20U;
                     return 8;
                 case 0xf0: // set 6, B
-                    cpuB |= 0x40U;
+                    cpuBC.high |= 0x40U;
                     return 8;
                 case 0xf1: // set 6, C
-                    cpuC |= 0x40U;
+                    cpuBC.low |= 0x40U;
                     return 8;
                 case 0xf2: // set 6, D
-                    cpuD |= 0x40U;
+                    cpuDE.high |= 0x40U;
                     return 8;
                 case 0xf3: // set 6, E
-                    cpuE |= 0x40U;
+                    cpuDE.low |= 0x40U;
                     return 8;
                 case 0xf4: // set 6, H
-                    cpuH |= 0x40U;
+                    cpuHL.high |= 0x40U;
                     return 8;
                 case 0xf5: // set 6, L
-                    cpuL |= 0x40U;
+                    cpuHL.low |= 0x40U;
                     return 8;
                 case 0xf6: // set 6, (HL)
                 {
@@ -5710,22 +5610,22 @@ int Gbc::performOp() {
                     cpuA |= 0x40U;
                     return 8;
                 case 0xf8: // set 7, B
-                    cpuB |= 0x80U;
+                    cpuBC.high |= 0x80U;
                     return 8;
                 case 0xf9: // set 7, C
-                    cpuC |= 0x80U;
+                    cpuBC.low |= 0x80U;
                     return 8;
                 case 0xfa: // set 7, D
-                    cpuD |= 0x80U;
+                    cpuDE.high |= 0x80U;
                     return 8;
                 case 0xfb: // set 7, E
-                    cpuE |= 0x80U;
+                    cpuDE.low |= 0x80U;
                     return 8;
                 case 0xfc: // set 7, H
-                    cpuH |= 0x80U;
+                    cpuHL.high |= 0x80U;
                     return 8;
                 case 0xfd: // set 7, L
-                    cpuL |= 0x80U;
+                    cpuHL.low |= 0x80U;
                     return 8;
                 case 0xfe: // set 7, (HL)
                 {
@@ -5826,7 +5726,7 @@ int Gbc::performOp() {
                 return 20;
             }
         case 0xd1: // pop DE
-            read16(cpuSp, &cpuE, &cpuD);
+            read16(cpuSp, &cpuDE.low, &cpuDE.high);
             cpuSp += 2;
             cpuPc++;
             return 12;
@@ -5868,7 +5768,7 @@ int Gbc::performOp() {
             }
         case 0xd5: // push DE
             cpuSp -= 2;
-            write16(cpuSp, cpuE, cpuD);
+            write16(cpuSp, cpuDE.low, cpuDE.high);
             cpuPc++;
             return 16;
         case 0xd6: // sub A, n
@@ -6003,12 +5903,12 @@ int Gbc::performOp() {
             cpuPc += 2;
             return 12;
         case 0xe1: // pop HL
-            read16(cpuSp, &cpuL, &cpuH);
+            read16(cpuSp, &cpuHL.low, &cpuHL.high);
             cpuSp += 2;
             cpuPc++;
             return 12;
         case 0xe2: // ldh (C), A (load to IO port C - ff00 + C)
-            write8(0xff00 + (unsigned int)cpuC, cpuA);
+            write8(0xff00 + (unsigned int)cpuBC.low, cpuA);
             cpuPc++;
             return 8;
         case 0xe3: // REMOVED INSTRUCTION
@@ -6017,7 +5917,7 @@ int Gbc::performOp() {
             return runInvalidInstruction(instr);
         case 0xe5: // push HL
             cpuSp -= 2;
-            write16(cpuSp, cpuL, cpuH);
+            write16(cpuSp, cpuHL.low, cpuHL.high);
             cpuPc++;
             return 16;
         case 0xe6: // and n
@@ -6103,7 +6003,7 @@ int Gbc::performOp() {
             cpuPc++;
             return 12;
         case 0xf2: // ldh A, C
-            cpuA = read8(0xff00 + (unsigned int)cpuC);
+            cpuA = read8(0xff00 + (unsigned int)cpuBC.low);
             cpuPc++;
             return 8;
         case 0xf3: // di
@@ -6153,8 +6053,8 @@ int Gbc::performOp() {
                 SETC_ON_COND(cpuSp > tempAddr);
                 SETH_ON_COND((cpuSp & 0x00ffffffU) > (tempAddr & 0x00ffffffU));
             }
-            cpuH = (uint8_t)(tempAddr >> 8U);
-            cpuL = (uint8_t)(tempAddr & 0xffU);
+            cpuHL.high = (uint8_t)(tempAddr >> 8U);
+            cpuHL.low = (uint8_t)(tempAddr & 0xffU);
         }
             cpuPc += 2;
             return 12;
@@ -6202,11 +6102,24 @@ int Gbc::performOp() {
 }
 
 
+// Takes effect from the next frame begun
+void Gbc::setIndexedOutput(bool indexed) {
+    indexedOutput = indexed;
+    applyPixelFormat();
+}
+
+void Gbc::applyPixelFormat() {
+    const bool indexed = indexedOutput && hardwareModel != HardwareModel::SGB;
+    frameManager.setPixelFormat(indexed ? PixelFormat::INDEXED : PixelFormat::RGBA);
+    palettesChanged = true;
+}
+
 void Gbc::speedUp() {
     if (currentClockMultiplierCombo < 20) {
         currentClockMultiplierCombo++;
         clockMultiply = CLOCK_MULTIPLIERS[currentClockMultiplierCombo];
         clockDivide = CLOCK_DIVISORS[currentClockMultiplierCombo];
+        frameManager.setFastForwarding(currentClockMultiplierCombo > NORMAL_SPEED_COMBO);
     }
 }
 
@@ -6215,23 +6128,37 @@ void Gbc::slowDown() {
         currentClockMultiplierCombo--;
         clockMultiply = CLOCK_MULTIPLIERS[currentClockMultiplierCombo];
         clockDivide = CLOCK_DIVISORS[currentClockMultiplierCombo];
+        frameManager.setFastForwarding(currentClockMultiplierCombo > NORMAL_SPEED_COMBO);
     }
 }
 
+// Leads save states that no longer carry decoded tiles. Older states start with the program counter instead, which
+// can never have this value, and follow the OAM with 196,608 bytes of tiles that are now rebuilt from VRAM.
+constexpr uint32_t SAVE_STATE_TAG = 0x31535347U;
+constexpr std::streamsize LEGACY_TILE_SET_SIZE = 2 * 384 * 8 * 8 * sizeof(uint32_t);
+
 #define READ_STREAM(var, type) stream.read(reinterpret_cast<char*>(&var), sizeof(type))
 #define READ_STREAM_A(var, type, count) stream.read(reinterpret_cast<char*>(var), sizeof(type) * count)
 void Gbc::loadSaveState(std::istream& stream) {
-    READ_STREAM(cpuPc, uint32_t);
+    uint32_t leadingWord;
+    READ_STREAM(leadingWord, uint32_t);
+    const bool hasTileSet = leadingWord != SAVE_STATE_TAG;
+    if (hasTileSet) {
+        cpuPc = leadingWord;
+    } else {
+        READ_STREAM(cpuPc, uint32_t);
+    }
     READ_STREAM(cpuSp, uint32_t);
     READ_STREAM(cpuA, uint8_t);
-    READ_STREAM(cpuB, uint8_t);
-    READ_STREAM(cpuC, uint8_t);
-    READ_STREAM(cpuD, uint8_t);
-    READ_STREAM(cpuE, uint8_t);
+    READ_STREAM(cpuBC.high, uint8_t);
+    READ_STREAM(cpuBC.low, uint8_t);
+    READ_STREAM(cpuDE.high, uint8_t);
+    READ_STREAM(cpuDE.low, uint8_t);
     READ_STREAM(cpuF, uint8_t);
-    READ_STREAM(cpuH, uint8_t);
-    READ_STREAM(cpuL, uint8_t);
+    READ_STREAM(cpuHL.high, uint8_t);
+    READ_STREAM(cpuHL.low, uint8_t);
     READ_STREAM(cpuIme, bool);
+    lazyFlags.clear();
     READ_STREAM(clocksAcc, int32_t);
     READ_STREAM(cpuClockFreq, int64_t);
     READ_STREAM(cpuDividerCount, uint32_t);
@@ -6242,7 +6169,9 @@ void Gbc::loadSaveState(std::istream& stream) {
     READ_STREAM(serialIsTransferring, bool);
     READ_STREAM(serialClockIsExternal, bool);
     READ_STREAM(serialTimer, int32_t);
+    int32_t gpuClockFactor;
     READ_STREAM(gpuClockFactor, int32_t);
+    cpuClockShift = gpuClockFactor == 2 ? 0 : 1;
     READ_STREAM(gpuTimeInMode, int32_t);
     READ_STREAM(blankedScreen, bool);
     READ_STREAM(needClear, bool);
@@ -6256,14 +6185,20 @@ void Gbc::loadSaveState(std::istream& stream) {
     READ_STREAM(clockMultiply, int64_t);
     READ_STREAM(clockDivide, int64_t);
     READ_STREAM(currentClockMultiplierCombo, int32_t);
+    frameManager.setFastForwarding(currentClockMultiplierCombo > NORMAL_SPEED_COMBO);
     READ_STREAM(bankOffset, uint32_t);
     READ_STREAM(wramBankOffset, uint32_t);
     READ_STREAM(vramBankOffset, uint32_t);
+    mapMemory();
     READ_STREAM_A(wram.data(), uint8_t, 8 * 4096);
     READ_STREAM_A(vram.data(), uint8_t, 2 * 8192);
     READ_STREAM_A(ioPorts.data(), uint8_t, 256);
     READ_STREAM_A(oam, uint8_t, 160);
-    READ_STREAM_A(tileSet, uint32_t, 2 * 384 * 8 * 8);
+    if (hasTileSet) {
+        stream.ignore(LEGACY_TILE_SET_SIZE);
+    }
+    tileCache.invalidateAll();
+    palettesChanged = true;
     READ_STREAM(sgb.readingCommand, bool);
     READ_STREAM_A(sgb.commandBytes, uint32_t, 7 * 16);
     READ_STREAM_A(sgb.commandBits, uint8_t, 8);
@@ -6309,21 +6244,29 @@ void Gbc::loadSaveState(std::istream& stream) {
     READ_STREAM(keys, InputSet);
     READ_STREAM(keyStateChanged, bool);
     audioUnit.loadStateFromStream(stream);
+    blockCache.clear();
+    recompiler.clear();
+    idleLoops.disarm();
+    restartScheduler();
 }
 
 #define WRITE_STREAM(var, type) stream.write(reinterpret_cast<char*>(&var), sizeof(type))
 #define WRITE_STREAM_A(var, type, count) stream.write(reinterpret_cast<char*>(var), sizeof(type) * count)
 void Gbc::saveSaveState(std::ostream& stream) {
+    materialiseFlags();
+    syncSubsystems();
+    uint32_t tag = SAVE_STATE_TAG;
+    WRITE_STREAM(tag, uint32_t);
     WRITE_STREAM(cpuPc, uint32_t);
     WRITE_STREAM(cpuSp, uint32_t);
     WRITE_STREAM(cpuA, uint8_t);
-    WRITE_STREAM(cpuB, uint8_t);
-    WRITE_STREAM(cpuC, uint8_t);
-    WRITE_STREAM(cpuD, uint8_t);
-    WRITE_STREAM(cpuE, uint8_t);
+    WRITE_STREAM(cpuBC.high, uint8_t);
+    WRITE_STREAM(cpuBC.low, uint8_t);
+    WRITE_STREAM(cpuDE.high, uint8_t);
+    WRITE_STREAM(cpuDE.low, uint8_t);
     WRITE_STREAM(cpuF, uint8_t);
-    WRITE_STREAM(cpuH, uint8_t);
-    WRITE_STREAM(cpuL, uint8_t);
+    WRITE_STREAM(cpuHL.high, uint8_t);
+    WRITE_STREAM(cpuHL.low, uint8_t);
     WRITE_STREAM(cpuIme, bool);
     WRITE_STREAM(clocksAcc, int32_t);
     WRITE_STREAM(cpuClockFreq, int64_t);
@@ -6335,6 +6278,7 @@ void Gbc::saveSaveState(std::ostream& stream) {
     WRITE_STREAM(serialIsTransferring, bool);
     WRITE_STREAM(serialClockIsExternal, bool);
     WRITE_STREAM(serialTimer, int32_t);
+    int32_t gpuClockFactor = cpuClockShift == 0 ? 2 : 1;
     WRITE_STREAM(gpuClockFactor, int32_t);
     WRITE_STREAM(gpuTimeInMode, int32_t);
     WRITE_STREAM(blankedScreen, bool);
@@ -6356,7 +6300,6 @@ void Gbc::saveSaveState(std::ostream& stream) {
     WRITE_STREAM_A(vram.data(), uint8_t, 2 * 8192);
     WRITE_STREAM_A(ioPorts.data(), uint8_t, 256);
     WRITE_STREAM_A(oam, uint8_t, 160);
-    WRITE_STREAM_A(tileSet, uint32_t, 2 * 384 * 8 * 8);
     WRITE_STREAM(sgb.readingCommand, bool);
     WRITE_STREAM_A(sgb.commandBytes, uint32_t, 7 * 16);
     WRITE_STREAM_A(sgb.commandBits, uint8_t, 8);
@@ -2,18 +2,56 @@
 
 #include "inputset.h"
 #include "romdefs.h"
+#include "lazyflags.h"
+#include "eventscheduler.h"
 #include "framemanager.h"
 #include "sram.h"
 #include "sgbmodule.h"
 #include "audiounit.h"
+#include "blockcache.h"
+#include "recompiler.h"
+#include "idleloopdetector.h"
+#include "tilecache.h"
+#include "romimage.h"
+#include "linekernels.h"
 #include "debugwindowmodule.h"
 
 #include <cstdint>
 #include <iostream>
 #include <vector>
 
+#define CPU_RUNNING   0x00U
+#define CPU_HALTED    0x01U
+#define CPU_STOPPED   0x02U
+
+enum class HardwareModel : uint8_t {
+    DMG,
+    SGB,
+    CGB
+};
+
+// Two 8-bit registers that are also addressed as one 16-bit register, high byte first as the CPU names them. The
+// bytes are laid out in the host's order so that the word aliases them directly.
+union RegisterPair {
+    uint16_t word;
+    struct {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        uint8_t high;
+        uint8_t low;
+#else
+        uint8_t low;
+        uint8_t high;
+#endif
+    };
+};
+
 class Gbc {
     friend class DebugUtils;
+    friend class CpuOps;
+    friend class BlockCache;
+    friend class Recompiler;
+    friend class IdleLoopDetector;
+    friend class GbcBenchAccess;
 
     inline unsigned int HL();
     inline uint8_t R8_HL();
@@ -25,14 +63,41 @@ class Gbc {
     inline void SETC_ON_COND(bool test);
 
     void executeAccumulatedClocks();
+    template <bool Debugging> void runAccumulatedClocks();
+    void completeInstruction(int clocksPassedByInstruction);
+    int idleClocks();
+    template <HardwareModel Model> void runDueEventsFor();
+    void restartScheduler();
+    void syncSubsystems();
+    void compareLy();
+    void syncDivider();
+    void syncTimer();
+    void scheduleTimer();
+    void overflowTimer();
+    void syncAudio();
+    void syncSerial();
+    void scheduleSerial();
+    void completeSerialTransfer();
+    void syncVideo();
+    void scheduleVideo();
+    template <HardwareModel Model> void stepVideo();
     int performOp();
     int runInvalidInstruction(uint8_t instruction);
     bool switchRunningSpeed();
+    void stallCpu(uint64_t cycles);
+    bool transferHdma(unsigned int blocks);
 
     uint8_t read8(unsigned int address);
+    uint8_t readUnmapped(unsigned int address);
     void read16(unsigned int address, uint8_t* msb, uint8_t* lsb);
     void write8(unsigned int address, uint8_t byte);
     void write16(unsigned int address, uint8_t msb, uint8_t lsb);
+    void writeBankControl(unsigned int address, uint8_t byte);
+    void mapMemory();
+    void mapRomBank();
+    void mapWramBank();
+    void mapVram();
+    void unmapWatchedPages();
     uint8_t readIO(unsigned int ioIndex);
     void writeIO(unsigned int ioIndex, uint8_t byte);
     void translatePaletteBg(unsigned int paletteData);
@@ -49,7 +114,6 @@ class Gbc {
     // CPU stats
     int32_t clocksAcc;
     int64_t cpuClockFreq;
-    int32_t gpuClockFactor;
     int32_t gpuTimeInMode;
     uint32_t gpuMode{};
     uint32_t cpuMode;
@@ -62,6 +126,27 @@ class Gbc {
     bool serialClockIsExternal{};
     int32_t serialTimer{};
 
+    // Master clocks run since power-on, not counting stop mode. These tick at the double speed CPU rate, so a CPU
+    // clock is one of them in double speed mode and two otherwise, while a GPU dot is always two. The divider,
+    // timer, audio, serial port and GPU are each brought up to date lazily from the cycle they were last synced at,
+    // and the scheduler says when one of them next needs to act by itself. The audio unit never does, so it's only
+    // synced when its registers are accessed and at the end of each run.
+    static constexpr uint32_t DOT_SHIFT = 1;
+    static constexpr uint64_t AUDIO_SYNC_INTERVAL = 64; // In dots
+    static constexpr uint64_t HDMA_BLOCK_CYCLES = 32U << DOT_SHIFT; // Per 16 bytes, at either speed
+    static constexpr uint64_t FRAME_DOTS = 70224;
+    uint32_t cpuClockShift = 1;
+    uint64_t cycleCounter{};
+    uint64_t dividerSyncedAt{};
+    uint64_t timerSyncedAt{};
+    uint64_t audioSyncedAt{};
+    uint64_t serialSyncedAt{};
+    uint64_t videoSyncedAt{};
+    EventScheduler scheduler;
+
+    [[nodiscard]] inline uint64_t toCpuClocks(uint64_t masterClocks) const { return masterClocks >> cpuClockShift; }
+    [[nodiscard]] inline uint64_t fromCpuClocks(uint64_t cpuClocks) const { return cpuClocks << cpuClockShift; }
+
     // RAM stats
     bool accessOam{};
     uint32_t wramBankOffset{};
@@ -70,6 +155,32 @@ class Gbc {
     bool accessVram{};
     uint32_t vramBankOffset{};
 
+    // Host memory behind each 256-byte page of the address space, or null where accesses need the full read8 and
+    // write8 logic. Only WRAM is writable this way; ROM, WRAM, and VRAM while accessible are readable.
+    const uint8_t* readPages[256]{};
+    uint8_t* writePages[256]{};
+
+    inline void setVideoAccess(bool oam, bool vram) {
+        accessOam = oam;
+        if (accessVram != vram) {
+            accessVram = vram;
+            mapVram();
+        }
+    }
+
+    // Reads from the switchable ROM bank. The banks some header sizes allow for can run past the end of the image;
+    // these read as 0xff.
+    [[nodiscard]] inline uint8_t readRomBank(unsigned int address) const {
+        const unsigned int offset = bankOffset + (address & 0x3fffU);
+        return offset < rom.size() ? rom[offset] : 0xffU;
+    }
+
+    // Opcode and operand fetch, skipping read8 where the page is mapped
+    inline uint8_t fetch8(unsigned int address) {
+        const uint8_t* page = readPages[(address >> 8U) & 0xffU];
+        return page != nullptr ? page[address & 0xffU] : read8(address);
+    }
+
     // CGB stats
     uint8_t cgbBgPalData[64]{};
     uint32_t cgbBgPalIndex{};
@@ -78,29 +189,72 @@ class Gbc {
     uint32_t cgbObjPalIndex{};
     uint32_t cgbObjPalIncr{};
 
-    // Block memory
-    uint32_t* tileSet;
+    // Decoded tile patterns, kept in step with VRAM
+    TileCache tileCache;
 
     // Other variables
     uint32_t lastLYCompare{};
     bool blankedScreen;
     bool needClear;
 
+    // Model-specific parts of the core, picked by reset() so that nothing on the hot path checks the model
+    HardwareModel hardwareModel = HardwareModel::DMG;
+    void (Gbc::* dueEventsRunner)(){};
+    inline void runDueEvents() { (this->*dueEventsRunner)(); }
+
+    // Whether the last run checked for breakpoints, which unmaps the pages holding watched addresses
+    bool debuggingRun{};
+
+    // State of the current runCycles or runFrame call: whether VBlank has begun, whether that ends the run, and the
+    // clocks it had left when it did
+    bool frameCompleted{};
+    bool stopAtVBlank{};
+    int32_t clocksHeldBack{};
+
+    // Background or window tiles gathered for the line kernels: 20 across the line and one more if the first is partial
+    LineKernels::TileRow lineTiles[21]{};
+
+    // Colour numbers drawn across the current line by the background and window, with the CGB BG priority attribute as
+    // bit 2 - zero allows sprite to be drawn if OBJ priority is set, non-zero will possibly block sprites being drawn
+    uint8_t bgColorNumbers[160]{};
+
+    // OAM offsets of the sprites on the current line in priority order, and what they draw across it: zero where no
+    // sprite shows, otherwise the colour's index into the OBJ palettes with bit 7 set if the sprite is behind the BG.
+    // The line has 8 pixels spare at each end for sprites partly off-screen to draw into.
+    uint8_t lineSprites[10]{};
+    uint8_t spriteLine[176]{};
+
     // Line-processing functions
-    void (Gbc::* readLine)(uint32_t*){};
-    void readLineGb(uint32_t* frameBuffer);
-    void readLineSgb(uint32_t* frameBuffer);
-    void readLineCgb(uint32_t* frameBuffer);
+    template <HardwareModel Model> void readLine(Frame& frame);
+    template <HardwareModel Model> bool composeSprites(unsigned int lineNo, bool largeSprites, unsigned int& start,
+                                                       unsigned int& end);
+    template <bool Indexed> void readLineGb(Frame& frame);
+    void readLineSgb();
+    template <bool Indexed> void readLineCgb(Frame& frame);
+
+    // Whether frames are drawn as palette indices, and whether the palettes have changed since they were last recorded
+    // with a line drawn that way. The SGB always draws in RGBA as it colours whole frames at once.
+    bool indexedOutput{};
+    bool palettesChanged = true;
+    void applyPixelFormat();
 
     // Name of current loaded ROM file, in format that can be opened directly using AppPlatform
     std::string currentOpenedFile;
 
 public:
+    // CPU clocks a run took, at whichever speed the CPU was running, and whether VBlank began during it
+    struct RunResult {
+        int64_t clocks;
+        bool frameCompleted;
+    };
+
     void doWork(uint64_t timeDiffMillis, InputSet& inputs);
+    RunResult runCycles(int32_t clocks);
+    RunResult runFrame();
     FrameManager frameManager;
 
     // Block memory accessible by debug window
-    std::vector<uint8_t> rom;
+    RomImage rom;
     std::vector<uint8_t> wram;
     std::vector<uint8_t> vram;
     std::vector<uint8_t> ioPorts;
@@ -120,20 +274,36 @@ public:
     Sram sram;
     SgbModule sgb{};
     AudioUnit audioUnit;
+    BlockCache blockCache;
+    Recompiler recompiler;
+    IdleLoopDetector idleLoops;
 
     // CPU registers
     uint32_t cpuPc;
     uint32_t cpuSp;
     uint8_t cpuA;
     uint8_t cpuF;
-    uint8_t cpuB;
-    uint8_t cpuC;
-    uint8_t cpuD;
-    uint8_t cpuE;
-    uint8_t cpuH;
-    uint8_t cpuL;
+    RegisterPair cpuBC;
+    RegisterPair cpuDE;
+    RegisterPair cpuHL;
     bool cpuIme;
 
+    // Flags from the last ALU operation, pending evaluation; cpuF is out of date while one is pending
+    LazyFlags lazyFlags;
+
+    // Bring cpuF up to date before it is modified in place
+    inline void materialiseFlags() {
+        if (lazyFlags.isPending()) {
+            cpuF = lazyFlags.evaluate();
+            lazyFlags.clear();
+        }
+    }
+
+    // F as the program would see it, without modifying any state
+    [[nodiscard]] inline uint8_t peekFlags() const {
+        return lazyFlags.isPending() ? lazyFlags.evaluate() : cpuF;
+    }
+
     // Public members
     bool isRunning;
     bool isPaused;
@@ -142,6 +312,7 @@ public:
     int64_t clockMultiply;
     int64_t clockDivide;
     int32_t currentClockMultiplierCombo;
+    uint64_t executedInstructions{};
 
     // Constructor/deconstructor
     Gbc();
@@ -149,10 +320,12 @@ public:
 
     // Other public functions
     bool loadRom(std::string fileName, const uint8_t* data, int dataLength, AppPlatform& appPlatform);
+    bool loadRom(std::string fileName, const RomImage& image, AppPlatform& appPlatform);
     std::string getLoadedFileName();
     void reset();
     void speedUp();
     void slowDown();
     void loadSaveState(std::istream& stream);
     void saveSaveState(std::ostream& stream);
+    void setIndexedOutput(bool indexed);
 };
@@ -0,0 +1,217 @@
+#include "idleloopdetector.h"
+
+#include "gbc.h"
+#include "cpuops.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include "debugwindowmodule.h"
+extern DebugWindowModule debugger;
+#endif
+
+// Whether a location can only change when an event runs or an interrupt is taken, and reading it has no side effects
+static bool isStableAddress(uint32_t address) {
+    if (address < 0xa000U) {
+        return true; // ROM and VRAM
+    } else if (address < 0xc000U) {
+        return false; // Cartridge RAM, which may be a running clock
+    } else if (address < 0xff00U) {
+        return true; // WRAM and OAM
+    } else if (address >= 0xff80U) {
+        return true; // HRAM and IE
+    }
+    switch (address & 0xffU) {
+        case 0x00: // Keypad, which only changes between runs
+        case 0x01: // Serial data and control, changed when a transfer completes
+        case 0x02:
+        case 0x0f: // Interrupt flags
+        case 0x40: // LCD control, status, scroll, LY and LYC
+        case 0x41:
+        case 0x42:
+        case 0x43:
+        case 0x44:
+        case 0x45:
+        case 0x47: // Palettes and window position
+        case 0x48:
+        case 0x49:
+        case 0x4a:
+        case 0x4b:
+        case 0x55: // HDMA status, changed in HBlank
+            return true;
+        default:
+            return false;
+    }
+}
+
+void IdleLoopDetector::setEnabled(bool enable) {
+    enabled = enable;
+    disarm();
+}
+
+void IdleLoopDetector::clear() {
+    analysedStart = NO_LOOP;
+    disarm();
+    loopsDetected = 0;
+    skips = 0;
+    skippedCycles = 0;
+}
+
+int IdleLoopDetector::jumpedBack(Gbc& gbc, uint32_t branchEnd, int branchClocks) {
+#ifdef _WIN32
+    // Breakpoints must see every iteration
+    if (debugger.totalBreakEnables > 0) {
+        return branchClocks;
+    }
+#endif
+    const uint32_t start = gbc.cpuPc;
+    const uint32_t instructions = analyse(gbc, start, branchEnd);
+    if (instructions == 0) {
+        disarm();
+        return branchClocks;
+    }
+
+    // Skip only if the iteration just finished ran straight through from the top since the loop was armed, which
+    // leaves the registers in the state every later iteration would too. The skipped iterations must all end
+    // before the next event is due and before the run ends, so that both happen at the same point in the loop as
+    // they would have anyway.
+    int clocks = branchClocks;
+    if (armedStart == start && gbc.executedInstructions - armedAtInstruction == instructions) {
+        const uint64_t iterationCycles = gbc.cycleCounter - armedAtCycle;
+        const uint64_t iterationClocks = gbc.toCpuClocks(iterationCycles);
+        const uint64_t iterationEnd = gbc.cycleCounter + gbc.fromCpuClocks((uint64_t)branchClocks);
+        const uint64_t deadline = gbc.scheduler.getNextDeadline();
+        const int64_t clocksLeft = (int64_t)gbc.clocksAcc - branchClocks;
+        if (iterationClocks > 0 && deadline > iterationEnd && clocksLeft > 0) {
+            const uint64_t iterations = std::min((deadline - iterationEnd - 1) / iterationCycles,
+                    (uint64_t)(clocksLeft - 1) / iterationClocks);
+            if (iterations > 0) {
+                clocks += (int)(iterations * iterationClocks);
+                skips++;
+                skippedCycles += iterations * iterationClocks;
+            }
+        }
+    }
+
+    // Arm for the iteration starting now, which the clocks charged for the jump are counted before
+    armedStart = start;
+    armedAtCycle = gbc.cycleCounter + gbc.fromCpuClocks((uint64_t)(clocks - branchClocks));
+    armedAtInstruction = gbc.executedInstructions;
+    return clocks;
+}
+
+// Number of instructions in the loop if it's a polling loop, or 0. Only instructions that load A from stable
+// memory, combine it with constants or other registers by AND and OR, or compare or test it are accepted; every
+// sequence of those gives the same registers when repeated with the same memory contents.
+uint32_t IdleLoopDetector::analyse(Gbc& gbc, uint32_t start, uint32_t end) {
+    const uint32_t length = end - start;
+    uint8_t code[MAX_LOOP_BYTES];
+    for (uint32_t i = 0; i < length; i++) {
+        const uint32_t address = (start + i) & 0xffffU;
+        const uint8_t* page = gbc.readPages[address >> 8U];
+        if (page != nullptr) {
+            code[i] = page[address & 0xffU];
+        } else if (address >= 0xff80U && address < 0xffffU) {
+            code[i] = gbc.ioPorts[address & 0xffU];
+        } else {
+            return 0;
+        }
+    }
+
+    // Register pairs a load might address are part of what the result depends on
+    const uint64_t registers = ((uint64_t)gbc.cpuBC.word << 32U) | ((uint64_t)gbc.cpuDE.word << 16U) | gbc.cpuHL.word;
+    if (start == analysedStart && end == analysedEnd && registers == analysedRegisters &&
+            memcmp(code, analysedCode, length) == 0) {
+        return analysedInstructions;
+    }
+    analysedStart = start;
+    analysedEnd = end;
+    analysedRegisters = registers;
+    memcpy(analysedCode, code, length);
+    analysedInstructions = 0;
+
+    const uint32_t bc = gbc.cpuBC.word;
+    const uint32_t de = gbc.cpuDE.word;
+    const uint32_t hl = gbc.cpuHL.word;
+    uint32_t instructions = 0;
+    for (uint32_t i = 0; i < length;) {
+        const uint8_t opcode = code[i];
+        const uint32_t instructionLength = CpuOps::instructionLengths[opcode];
+        if (i + instructionLength > length) {
+            return 0;
+        }
+        uint32_t operand = 0;
+        if (instructionLength > 1) {
+            operand = code[i + 1];
+            if (instructionLength > 2) {
+                operand += (uint32_t)code[i + 2] << 8U;
+            }
+        }
+        i += instructionLength;
+        instructions++;
+
+        // The last instruction must be the jump back to the start, and the only one
+        if (i == length) {
+            switch (opcode) {
+                case 0x18: case 0x20: case 0x28: case 0x30: case 0x38: // jr d, jr cc, d
+                    if (((end + (uint32_t)(int8_t)operand) & 0xffffU) != start) {
+                        return 0;
+                    }
+                    break;
+                case 0xc2: case 0xc3: case 0xca: case 0xd2: case 0xda: // jp nn, jp cc, nn
+                    if (operand != start) {
+                        return 0;
+                    }
+                    break;
+                default:
+                    return 0;
+            }
+            break;
+        }
+
+        bool accepted;
+        switch (opcode) {
+            case 0x00: // nop
+            case 0xe6: // and n
+            case 0xf6: // or n
+            case 0xfe: // cp n
+                accepted = true;
+                break;
+            case 0x0a: // ld A, (BC)
+                accepted = isStableAddress(bc);
+                break;
+            case 0x1a: // ld A, (DE)
+                accepted = isStableAddress(de);
+                break;
+            case 0x7e: // ld A, (HL)
+                accepted = isStableAddress(hl);
+                break;
+            case 0xf0: // ldh A, (n)
+                accepted = isStableAddress(0xff00U + operand);
+                break;
+            case 0xf2: // ldh A, (C)
+                accepted = isStableAddress(0xff00U + gbc.cpuBC.low);
+                break;
+            case 0xfa: // ld A, (nn)
+                accepted = isStableAddress(operand);
+                break;
+            case 0xcb: // bit n, r
+                accepted = (operand & 0xc0U) == 0x40U && ((operand & 0x07U) != 6 || isStableAddress(hl));
+                break;
+            default: { // and r, or r, cp r
+                const uint32_t operation = (opcode >> 3U) & 0x07U;
+                accepted = (opcode & 0xc0U) == 0x80U && (operation == 4 || operation == 6 || operation == 7) &&
+                        ((opcode & 0x07U) != 6 || isStableAddress(hl));
+                break;
+            }
+        }
+        if (!accepted) {
+            return 0;
+        }
+    }
+
+    analysedInstructions = instructions;
+    loopsDetected++;
+    return instructions;
+}
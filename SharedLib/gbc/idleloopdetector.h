@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+
+class Gbc;
+
+// Spots short loops that only poll memory, like "ldh a,(LY); cp n; jr nz", and fast-forwards them. Such a loop can
+// only see a different value once a scheduled event runs or an interrupt is taken, so once one full iteration has
+// run undisturbed, every iteration up to the next event would leave the machine in the same state, and the
+// detector charges their clocks to the jump in one go.
+class IdleLoopDetector {
+    static constexpr uint32_t MAX_LOOP_BYTES = 16;
+    static constexpr uint32_t NO_LOOP = 0xffffffffU;
+
+    bool enabled = true;
+
+    // The last loop analysed, which is only decoded again if its code or the registers it might load through change
+    uint32_t analysedStart = NO_LOOP;
+    uint32_t analysedEnd = 0;
+    uint32_t analysedInstructions = 0;
+    uint64_t analysedRegisters = 0;
+    uint8_t analysedCode[MAX_LOOP_BYTES]{};
+
+    // Where the current iteration of a polling loop began, or NO_LOOP
+    uint32_t armedStart = NO_LOOP;
+    uint64_t armedAtCycle = 0;
+    uint64_t armedAtInstruction = 0;
+
+    int jumpedBack(Gbc& gbc, uint32_t branchEnd, int branchClocks);
+    [[nodiscard]] uint32_t analyse(Gbc& gbc, uint32_t start, uint32_t end);
+
+public:
+    // Per-ROM statistics, cleared on reset
+    uint64_t loopsDetected = 0;
+    uint64_t skips = 0;
+    uint64_t skippedCycles = 0;
+
+    void setEnabled(bool enable);
+    [[nodiscard]] bool isEnabled() const { return enabled; }
+    void clear();
+
+    // Called by jump instructions once taken, with the PC already at the target; returns the clocks to charge for
+    // the jump, including any iterations skipped
+    inline int jumped(Gbc& gbc, uint32_t target, uint32_t branchEnd, int branchClocks) {
+        if (!enabled || target >= branchEnd || branchEnd - target > MAX_LOOP_BYTES) {
+            return branchClocks;
+        }
+        return jumpedBack(gbc, branchEnd, branchClocks);
+    }
+
+    // Called whenever a polled value may have changed under a loop part-way through an iteration: events,
+    // interrupts, input between runs and state loads
+    inline void disarm() { armedStart = NO_LOOP; }
+};
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+
+// The last flag-setting ALU operation and its inputs, from which F can be computed only when something reads it.
+// The results match the eager calculations in Gbc::performOp, quirks included.
+struct LazyFlags {
+    enum Operation : uint8_t {
+        NONE = 0,
+        ADD,
+        ADC,
+        SUB,
+        SBC,
+        AND,
+        XOR,
+        OR,
+        CP,
+        INC,
+        DEC
+    };
+
+    uint8_t operation = NONE;
+    uint8_t a = 0;      // A before the operation, or the register being incremented or decremented
+    uint8_t value = 0;  // Second operand
+    uint8_t carry = 0;  // Carry flag (0x10) going into the operation
+
+    [[nodiscard]] inline bool isPending() const { return operation != NONE; }
+    inline void clear() { operation = NONE; }
+
+    inline void record(Operation op, uint8_t first, uint8_t second, uint8_t carryIn = 0) {
+        operation = op;
+        a = first;
+        value = second;
+        carry = carryIn;
+    }
+
+    [[nodiscard]] inline uint8_t evaluate() const {
+        uint8_t f = 0x00;
+        uint8_t result;
+        switch (operation) {
+            case ADD:
+                result = (uint8_t)(a + value);
+                if (result == 0x00) f |= 0x80U;
+                if ((value & 0x0fU) > (result & 0x0fU)) f |= 0x20U;
+                if (value > result) f |= 0x10U;
+                break;
+            case ADC: {
+                uint8_t addend = value;
+                if (carry != 0x00) {
+                    if (addend == 0xff) f |= 0x10U;
+                    addend++;
+                }
+                result = (uint8_t)(a + addend);
+                if (result == 0x00) f |= 0x80U;
+                if (result < addend) f |= 0x10U;
+                if ((addend & 0x0fU) > (result & 0x0fU)) f |= 0x20U;
+                break;
+            }
+            case SUB:
+            case CP:
+                f = 0x40;
+                if (value > a) f |= 0x10U;
+                if ((value & 0x0fU) > (a & 0x0fU)) f |= 0x20U;
+                if (a == value) f = 0xc0;
+                break;
+            case SBC:
+                f = 0x40;
+                if (value > a) f |= 0x10U;
+                if ((value & 0x0fU) > (a & 0x0fU)) f |= 0x20U;
+                result = (uint8_t)(a - value);
+                if (carry != 0x00) {
+                    if (result == 0x00) {
+                        result = 0xff;
+                        f = 0x70;
+                    } else {
+                        result--;
+                    }
+                }
+                if (result == 0x00) f |= 0x80U;
+                break;
+            case AND:
+                f = (a & value) == 0x00 ? 0xa0U : 0x20U;
+                break;
+            case XOR:
+                f = (a ^ value) == 0x00 ? 0x80U : 0x00U;
+                break;
+            case OR:
+                f = (a | value) == 0x00 ? 0x80U : 0x00U;
+                break;
+            case INC:
+                result = (uint8_t)(a + 1);
+                f = carry;
+                if (result == 0x00) f |= 0x80U;
+                if ((result & 0x0fU) == 0x00) f |= 0x20U;
+                break;
+            case DEC:
+                result = (uint8_t)(a - 1);
+                f = carry | 0x40U;
+                if ((a & 0x0fU) == 0x00) f |= 0x20U;
+                if (result == 0x00) f |= 0x80U;
+                break;
+            default:
+                break;
+        }
+        return f;
+    }
+};
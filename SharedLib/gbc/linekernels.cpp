@@ -0,0 +1,235 @@
+#include "linekernels.h"
+
+// Every kernel the compiler targets is built, so that each can be checked against the others: on x86, the best one it
+// targets and all those below it
+#if !defined(GBC_SCALAR_LINE_KERNELS)
+#if defined(__AVX2__)
+#define LINE_KERNELS_AVX2
+#include <immintrin.h>
+#endif
+#if defined(__SSSE3__)
+#define LINE_KERNELS_SSSE3
+#include <tmmintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#define LINE_KERNELS_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#define LINE_KERNELS_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+#include <cstring>
+#include <utility>
+
+namespace {
+    inline void drawPixels(const LineKernels::TileRow& tile, unsigned int start, unsigned int end, uint32_t* dst,
+                           uint8_t* numbers) {
+        for (unsigned int x = start; x < end; x++) {
+            const uint8_t colourNumber = tile.pixels[x];
+            *dst++ = tile.palette[colourNumber];
+            *numbers++ = colourNumber | tile.flags;
+        }
+    }
+
+    inline void drawPixels(const LineKernels::TileRow& tile, unsigned int start, unsigned int end, uint8_t* dst,
+                           uint8_t* numbers) {
+        for (unsigned int x = start; x < end; x++) {
+            const uint8_t colourNumber = tile.pixels[x];
+            *dst++ = colourNumber + tile.paletteIndex;
+            *numbers++ = colourNumber | tile.flags;
+        }
+    }
+
+    // Indices need no lookup, only adding the palette's place to every byte of the row at once; no byte carries into
+    // the next as none of the sums reach 256
+    inline void drawTile(const LineKernels::TileRow& tile, uint8_t* dst, uint8_t* numbers) {
+        uint64_t row;
+        memcpy(&row, tile.pixels, 8);
+        const uint64_t indices = row + tile.paletteIndex * 0x0101010101010101ULL;
+        const uint64_t flagged = row | tile.flags * 0x0101010101010101ULL;
+        memcpy(dst, &indices, 8);
+        memcpy(numbers, &flagged, 8);
+    }
+
+    // All 8 pixels of a tile. With a byte shuffle, the palette's 16 bytes are looked up a byte at a time, so each colour
+    // number is repeated over the four bytes of its pixel, multiplied by 4 and offset by the byte's place in the colour.
+#if defined(LINE_KERNELS_AVX2)
+    inline void drawTileAvx2(const LineKernels::TileRow& tile, uint32_t* dst, uint8_t* numbers) {
+        const __m256i palette = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tile.palette)));
+        const __m128i row = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(tile.pixels));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_permutevar8x32_epi32(palette, _mm256_cvtepu8_epi32(row)));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(numbers), _mm_or_si128(row, _mm_set1_epi8((char)tile.flags)));
+    }
+#endif
+
+#if defined(LINE_KERNELS_SSSE3)
+    inline void drawTileSsse3(const LineKernels::TileRow& tile, uint32_t* dst, uint8_t* numbers) {
+        const __m128i palette = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tile.palette));
+        const __m128i row = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(tile.pixels));
+        const __m128i byteOffsets = _mm_set1_epi32(0x03020100);
+        __m128i left = _mm_shuffle_epi8(row, _mm_setr_epi8(0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3));
+        __m128i right = _mm_shuffle_epi8(row, _mm_setr_epi8(4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7));
+        left = _mm_add_epi8(_mm_slli_epi16(left, 2), byteOffsets);
+        right = _mm_add_epi8(_mm_slli_epi16(right, 2), byteOffsets);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_shuffle_epi8(palette, left));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4), _mm_shuffle_epi8(palette, right));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(numbers), _mm_or_si128(row, _mm_set1_epi8((char)tile.flags)));
+    }
+#endif
+
+#if defined(LINE_KERNELS_SSE2)
+    // Without a byte shuffle, each pixel picks between the colours by the two bits of its number instead
+    inline void drawTileSse2(const LineKernels::TileRow& tile, uint32_t* dst, uint8_t* numbers) {
+        const __m128i palette = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tile.palette));
+        const __m128i colour0 = _mm_shuffle_epi32(palette, 0x00);
+        const __m128i colour2 = _mm_shuffle_epi32(palette, 0xaa);
+        const __m128i differ01 = _mm_xor_si128(colour0, _mm_shuffle_epi32(palette, 0x55));
+        const __m128i differ23 = _mm_xor_si128(colour2, _mm_shuffle_epi32(palette, 0xff));
+        const __m128i bit0 = _mm_set1_epi32(1);
+        const __m128i bit1 = _mm_set1_epi32(2);
+        const __m128i row = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(tile.pixels));
+        const __m128i row16 = _mm_unpacklo_epi8(row, _mm_setzero_si128());
+        const __m128i halves[2] = { _mm_unpacklo_epi16(row16, _mm_setzero_si128()),
+                                    _mm_unpackhi_epi16(row16, _mm_setzero_si128()) };
+        for (unsigned int half = 0; half < 2; half++) {
+            const __m128i odd = _mm_cmpeq_epi32(_mm_and_si128(halves[half], bit0), bit0);
+            const __m128i high = _mm_cmpeq_epi32(_mm_and_si128(halves[half], bit1), bit1);
+            const __m128i low01 = _mm_xor_si128(colour0, _mm_and_si128(differ01, odd));
+            const __m128i high23 = _mm_xor_si128(colour2, _mm_and_si128(differ23, odd));
+            const __m128i colours = _mm_xor_si128(low01, _mm_and_si128(_mm_xor_si128(low01, high23), high));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * half), colours);
+        }
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(numbers), _mm_or_si128(row, _mm_set1_epi8((char)tile.flags)));
+    }
+#endif
+
+#if defined(LINE_KERNELS_NEON)
+    inline void drawTileNeon(const LineKernels::TileRow& tile, uint32_t* dst, uint8_t* numbers) {
+        static const uint8_t spreadLeft[16] = { 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3 };
+        static const uint8_t spreadRight[16] = { 4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7 };
+        static const uint8_t offsets[16] = { 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3 };
+        const uint8x16_t palette = vld1q_u8(reinterpret_cast<const uint8_t*>(tile.palette));
+        const uint8x8_t row = vld1_u8(tile.pixels);
+        const uint8x16_t rows = vcombine_u8(row, row);
+        const uint8x16_t byteOffsets = vld1q_u8(offsets);
+        const uint8x16_t left = vaddq_u8(vshlq_n_u8(vqtbl1q_u8(rows, vld1q_u8(spreadLeft)), 2), byteOffsets);
+        const uint8x16_t right = vaddq_u8(vshlq_n_u8(vqtbl1q_u8(rows, vld1q_u8(spreadRight)), 2), byteOffsets);
+        vst1q_u8(reinterpret_cast<uint8_t*>(dst), vqtbl1q_u8(palette, left));
+        vst1q_u8(reinterpret_cast<uint8_t*>(dst + 4), vqtbl1q_u8(palette, right));
+        vst1_u8(numbers, vorr_u8(row, vdup_n_u8(tile.flags)));
+    }
+#endif
+
+    inline void drawTileScalar(const LineKernels::TileRow& tile, uint32_t* dst, uint8_t* numbers) {
+        // Copied out first so that the compiler needn't assume the stores change them
+        uint8_t row[8];
+        uint32_t palette[4];
+        memcpy(row, tile.pixels, sizeof(row));
+        memcpy(palette, tile.palette, sizeof(palette));
+        for (unsigned int x = 0; x < 8; x++) {
+            dst[x] = palette[row[x]];
+            numbers[x] = row[x] | tile.flags;
+        }
+    }
+
+    template <typename Pixel, void (*DrawTile)(const LineKernels::TileRow&, Pixel*, uint8_t*)>
+    void drawSpan(const LineKernels::TileRow* tiles, unsigned int firstPixel, unsigned int count, Pixel* dst,
+                  uint8_t* numbers) {
+        // Leading part of a tile
+        if (firstPixel > 0 && count > 0) {
+            const unsigned int end = firstPixel + count < 8 ? firstPixel + count : 8;
+            drawPixels(*tiles++, firstPixel, end, dst, numbers);
+            dst += end - firstPixel;
+            numbers += end - firstPixel;
+            count -= end - firstPixel;
+        }
+
+        // Whole tiles
+        while (count >= 8) {
+            DrawTile(*tiles++, dst, numbers);
+            dst += 8;
+            numbers += 8;
+            count -= 8;
+        }
+
+        // Trailing part of a tile
+        if (count > 0) {
+            drawPixels(*tiles, 0, count, dst, numbers);
+        }
+    }
+
+    using DrawRgba = void (*)(const LineKernels::TileRow*, unsigned int, unsigned int, uint32_t*, uint8_t*);
+
+    // The kernels built, best first
+    constexpr std::pair<LineKernels::Kernel, DrawRgba> KERNELS[] = {
+#if defined(LINE_KERNELS_AVX2)
+        { LineKernels::Kernel::AVX2, drawSpan<uint32_t, drawTileAvx2> },
+#endif
+#if defined(LINE_KERNELS_SSSE3)
+        { LineKernels::Kernel::SSSE3, drawSpan<uint32_t, drawTileSsse3> },
+#endif
+#if defined(LINE_KERNELS_SSE2)
+        { LineKernels::Kernel::SSE2, drawSpan<uint32_t, drawTileSse2> },
+#endif
+#if defined(LINE_KERNELS_NEON)
+        { LineKernels::Kernel::NEON, drawSpan<uint32_t, drawTileNeon> },
+#endif
+        { LineKernels::Kernel::SCALAR, drawSpan<uint32_t, drawTileScalar> }
+    };
+
+    LineKernels::Kernel currentKernel = KERNELS[0].first;
+    DrawRgba currentDrawRgba = KERNELS[0].second;
+}
+
+void LineKernels::drawTiles(const TileRow* tiles, unsigned int firstPixel, unsigned int count, uint32_t* dst,
+                            uint8_t* numbers) {
+    currentDrawRgba(tiles, firstPixel, count, dst, numbers);
+}
+
+void LineKernels::drawTiles(const TileRow* tiles, unsigned int firstPixel, unsigned int count, uint8_t* dst,
+                            uint8_t* numbers) {
+    drawSpan<uint8_t, drawTile>(tiles, firstPixel, count, dst, numbers);
+}
+
+bool LineKernels::isAvailable(Kernel kernel) {
+    for (auto& built : KERNELS) {
+        if (built.first == kernel) {
+            return true;
+        }
+    }
+    return false;
+}
+
+LineKernels::Kernel LineKernels::getKernel() {
+    return currentKernel;
+}
+
+bool LineKernels::setKernel(Kernel kernel) {
+    for (auto& [builtKernel, drawRgba] : KERNELS) {
+        if (builtKernel == kernel) {
+            currentKernel = builtKernel;
+            currentDrawRgba = drawRgba;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* LineKernels::getKernelName(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::AVX2:
+            return "AVX2";
+        case Kernel::SSSE3:
+            return "SSSE3";
+        case Kernel::SSE2:
+            return "SSE2";
+        case Kernel::NEON:
+            return "NEON";
+        case Kernel::SCALAR:
+        default:
+            return "scalar";
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+// Inner loop of the background and window renderers, turning rows of decoded tile pixels into a stretch of a
+// scanline. A whole tile is expanded at once with AVX2, SSSE3 or SSE2 on x86 and NEON on AArch64, by default the best
+// the compiler targets, doing the palette lookup with a shuffle where there is one; otherwise, or with
+// GBC_SCALAR_LINE_KERNELS defined, a pixel at a time.
+class LineKernels {
+public:
+    // The ways a whole tile can be drawn, of which a build has the scalar one and those the compiler targets
+    enum class Kernel {
+        SCALAR,
+        SSE2,
+        SSSE3,
+        AVX2,
+        NEON
+    };
+
+    // One tile as it appears on the line: its 8 colour numbers for this row from the tile cache, the 4 colours to
+    // draw them with and where the first of those is among the line's colours, and bits to set above the colour
+    // number in the line of numbers that sprites check against
+    struct TileRow {
+        const uint8_t* pixels;
+        const uint32_t* palette;
+        uint8_t paletteIndex;
+        uint8_t flags;
+    };
+
+    // Draws count pixels of the tiles, starting firstPixel pixels into the first of them, into dst and their colour
+    // numbers with each tile's flags into numbers
+    static void drawTiles(const TileRow* tiles, unsigned int firstPixel, unsigned int count, uint32_t* dst,
+                          uint8_t* numbers);
+
+    // The same, but drawing each pixel as its index among the line's colours rather than the colour itself
+    static void drawTiles(const TileRow* tiles, unsigned int firstPixel, unsigned int count, uint8_t* dst,
+                          uint8_t* numbers);
+
+    // Which kernel draws RGBA lines. Every kernel the compiler targets is built, along with the scalar one, so that
+    // they can be compared against each other; choosing one applies to every instance, and mustn't be done while any
+    // line is being drawn. Indexed lines are drawn the same way whichever is chosen.
+    [[nodiscard]] static bool isAvailable(Kernel kernel);
+    [[nodiscard]] static Kernel getKernel();
+    static bool setKernel(Kernel kernel);
+    [[nodiscard]] static const char* getKernelName(Kernel kernel);
+};
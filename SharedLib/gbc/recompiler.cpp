@@ -0,0 +1,728 @@
+#include "recompiler.h"
+
+#include "gbc.h"
+#include "cpuops.h"
+
+#include <cstring>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#ifdef GBC_RECOMPILER_SUPPORTED
+
+// Register numbers as used in ModRM bytes
+static constexpr uint8_t EAX = 0;
+static constexpr uint8_t ECX = 1;
+
+// Condition codes for Jcc
+static constexpr uint8_t CC_B = 0x2;
+static constexpr uint8_t CC_AE = 0x3;
+static constexpr uint8_t CC_E = 0x4;
+static constexpr uint8_t CC_NE = 0x5;
+
+// Minimal x86-64 assembler. RBX holds the Gbc pointer throughout, so members are addressed as [rbx + disp32];
+// EAX, ECX, EDX, R10 and R11 are scratch, being volatile under both the System V and Windows conventions.
+class CodeEmitter {
+public:
+    std::vector<uint8_t> code;
+
+    void bytes(std::initializer_list<uint8_t> list) {
+        code.insert(code.end(), list);
+    }
+
+    void imm32(uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            code.push_back((uint8_t)(value >> (8U * i)));
+        }
+    }
+
+    void imm64(uint64_t value) {
+        for (int i = 0; i < 8; i++) {
+            code.push_back((uint8_t)(value >> (8U * i)));
+        }
+    }
+
+    // Instructions with a [rbx + disp32] memory operand
+    void memberOp(std::initializer_list<uint8_t> opcode, uint8_t reg, int32_t disp) {
+        bytes(opcode);
+        code.push_back(0x83U | (uint8_t)(reg << 3U));
+        imm32((uint32_t)disp);
+    }
+
+    void loadByte(uint8_t reg, int32_t disp) { memberOp({ 0x0f, 0xb6 }, reg, disp); } // movzx r32, byte [member]
+    void storeByte(uint8_t reg, int32_t disp) { memberOp({ 0x88 }, reg, disp); } // mov byte [member], r8
+    void loadWord(uint8_t reg, int32_t disp) { memberOp({ 0x0f, 0xb7 }, reg, disp); } // movzx r32, word [member]
+    void loadDword(uint8_t reg, int32_t disp) { memberOp({ 0x8b }, reg, disp); } // mov r32, [member]
+    void storeDword(uint8_t reg, int32_t disp) { memberOp({ 0x89 }, reg, disp); } // mov [member], r32
+
+    void storeByteImm(int32_t disp, uint8_t value) {
+        memberOp({ 0xc6 }, 0, disp);
+        code.push_back(value);
+    }
+
+    void storeWordImm(int32_t disp, uint16_t value) {
+        memberOp({ 0x66, 0xc7 }, 0, disp);
+        code.push_back((uint8_t)value);
+        code.push_back((uint8_t)(value >> 8U));
+    }
+
+    void storeDwordImm(int32_t disp, uint32_t value) {
+        memberOp({ 0xc7 }, 0, disp);
+        imm32(value);
+    }
+
+    void addDwordImm(int32_t disp, uint32_t value) {
+        memberOp({ 0x81 }, 0, disp);
+        imm32(value);
+    }
+
+    void cmpDwordImm(int32_t disp, uint32_t value) {
+        memberOp({ 0x81 }, 7, disp);
+        imm32(value);
+    }
+
+    void stepWord(int32_t disp, bool increment) { memberOp({ 0x66, 0xff }, increment ? 0 : 1, disp); } // inc/dec word [member]
+
+    void testByteImm(int32_t disp, uint8_t value) {
+        memberOp({ 0xf6 }, 0, disp);
+        code.push_back(value);
+    }
+
+    void cmpByteImm(int32_t disp, uint8_t value) {
+        memberOp({ 0x80 }, 7, disp);
+        code.push_back(value);
+    }
+
+    void movImm(uint8_t reg, uint32_t value) {
+        code.push_back(0xb8U + reg);
+        imm32(value);
+    }
+
+    void movImm64Rdx(const void* pointer) {
+        bytes({ 0x48, 0xba });
+        imm64((uint64_t)(uintptr_t)pointer);
+    }
+
+    void cmpEcxImm(uint32_t value) {
+        bytes({ 0x81, 0xf9 });
+        imm32(value);
+    }
+
+    void andEcxImm(uint32_t value) {
+        bytes({ 0x81, 0xe1 });
+        imm32(value);
+    }
+
+    // Forward jumps return the position of their rel32 field, which bind() later points at the current position
+    size_t jump() {
+        code.push_back(0xe9);
+        imm32(0);
+        return code.size() - 4;
+    }
+
+    size_t jumpIf(uint8_t condition) {
+        bytes({ 0x0f, (uint8_t)(0x80U | condition) });
+        imm32(0);
+        return code.size() - 4;
+    }
+
+    void jumpIfBack(uint8_t condition, size_t target) {
+        bytes({ 0x0f, (uint8_t)(0x80U | condition) });
+        imm32((uint32_t)(int32_t)((int64_t)target - (int64_t)(code.size() + 4)));
+    }
+
+    void bind(size_t patch) {
+        const auto rel = (uint32_t)(int32_t)((int64_t)code.size() - (int64_t)(patch + 4));
+        for (int i = 0; i < 4; i++) {
+            code[patch + i] = (uint8_t)(rel >> (8U * i));
+        }
+    }
+
+    // Call a function taking (Gbc*, uint32_t, uint32_t), the integer arguments having been placed in R10D and R11D
+    void call(const void* function) {
+#ifdef _WIN32
+        bytes({ 0x48, 0x89, 0xd9 }); // mov rcx, rbx
+        bytes({ 0x44, 0x89, 0xd2 }); // mov edx, r10d
+        bytes({ 0x45, 0x89, 0xd8 }); // mov r8d, r11d
+#else
+        bytes({ 0x48, 0x89, 0xdf }); // mov rdi, rbx
+        bytes({ 0x44, 0x89, 0xd6 }); // mov esi, r10d
+        bytes({ 0x44, 0x89, 0xda }); // mov edx, r11d
+#endif
+        bytes({ 0x48, 0xb8 }); // mov rax, imm64
+        imm64((uint64_t)(uintptr_t)function);
+        bytes({ 0xff, 0xd0 }); // call rax
+    }
+
+    void argFromEax() { bytes({ 0x41, 0x89, 0xc2 }); } // mov r10d, eax
+    void argFromEcx() { bytes({ 0x41, 0x89, 0xca }); } // mov r10d, ecx
+    void secondArgFromEax() { bytes({ 0x41, 0x89, 0xc3 }); } // mov r11d, eax
+
+    void argImm(uint32_t value) {
+        bytes({ 0x41, 0xba }); // mov r10d, imm32
+        imm32(value);
+    }
+
+    void prologue() {
+        code.push_back(0x53); // push rbx
+#ifdef _WIN32
+        bytes({ 0x48, 0x83, 0xec, 0x20 }); // sub rsp, 32 (shadow space)
+        bytes({ 0x48, 0x89, 0xcb }); // mov rbx, rcx
+#else
+        bytes({ 0x48, 0x89, 0xfb }); // mov rbx, rdi
+#endif
+    }
+
+    void epilogue() {
+#ifdef _WIN32
+        bytes({ 0x48, 0x83, 0xc4, 0x20 }); // add rsp, 32
+#endif
+        code.push_back(0x5b); // pop rbx
+        code.push_back(0xc3); // ret
+    }
+};
+
+// Offsets of the Gbc members used by native code, relative to the Gbc pointer held in RBX
+struct MemberOffsets {
+    int32_t registers[8]; // Opcode encoding order: B, C, D, E, H, L, (HL) unused, A
+    int32_t pairs[3]; // BC, DE, HL
+    int32_t f;
+    int32_t sp;
+    int32_t pc;
+    int32_t ime;
+    int32_t bankOffset;
+    int32_t wramBankOffset;
+    int32_t readPages;
+    int32_t lazyOperation;
+    int32_t lazyA;
+    int32_t lazyValue;
+    int32_t lazyCarry;
+};
+
+// What is known at compile time about flags left pending by earlier instructions in the block
+enum class FlagState {
+    UNKNOWN,
+    PENDING,
+    MATERIALISED
+};
+
+#endif // GBC_RECOMPILER_SUPPORTED
+
+Recompiler::~Recompiler() {
+    if (codeBuffer != nullptr) {
+#ifdef _WIN32
+        VirtualFree(codeBuffer, 0, MEM_RELEASE);
+#else
+        munmap(codeBuffer, CODE_BUFFER_SIZE);
+#endif
+    }
+}
+
+bool Recompiler::isSupported() {
+#ifdef GBC_RECOMPILER_SUPPORTED
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Recompiler::setEnabled(bool enable) {
+    enabled = enable && isSupported();
+}
+
+void Recompiler::setDifferentialMode(bool enable) {
+    differentialMode = enable;
+    reference.reset();
+}
+
+void Recompiler::clear() {
+    // Bumping the generation orphans every translation without having to visit the blocks
+    generation++;
+    codeBufferUsed = 0;
+    reference.reset();
+    lastNativeBlock = nullptr;
+}
+
+void Recompiler::beginRun(Gbc& gbc) {
+    if (enabled && differentialMode) {
+        synchroniseReference(gbc);
+    }
+}
+
+void Recompiler::execute(Gbc& gbc) {
+    // Writes to code are only tracked by the block cache while it is enabled
+    if (!gbc.blockCache.isEnabled()) {
+        gbc.blockCache.setEnabled(true);
+    }
+
+    // The reference doesn't follow the Gbc through HALT or STOP, so picks up again from wherever it woke
+    if (differentialMode && reference && reference->executedInstructions != gbc.executedInstructions) {
+        synchroniseReference(gbc);
+    }
+
+    const uint64_t instructionsBefore = gbc.executedInstructions;
+    const uint64_t skipsBefore = gbc.idleLoops.skips;
+    const bool ranNative = runNativeBlock(gbc);
+    if (!ranNative) {
+        gbc.completeInstruction(gbc.blockCache.execute(gbc));
+    }
+
+    // A skipped idle loop is a single instruction here but many to the reference, which is brought back into line
+    if (differentialMode && gbc.idleLoops.skips != skipsBefore) {
+        synchroniseReference(gbc);
+    } else if (differentialMode) {
+        checkAgainstReference(gbc, gbc.executedInstructions - instructionsBefore, ranNative);
+    }
+}
+
+bool Recompiler::runNativeBlock(Gbc& gbc) {
+    if (gbc.blockCache.isMidBlock(gbc.cpuPc)) {
+        return false;
+    }
+    CachedBlock* block = gbc.blockCache.enterBlock(gbc);
+    if (block == nullptr || block->nativeDisabled) {
+        return false;
+    }
+
+    if (block->nativeGeneration != generation) {
+        if (block->hits < HOT_BLOCK_THRESHOLD) {
+            return false;
+        }
+        block->nativeCode = compile(gbc, *block);
+        if (block->nativeCode == nullptr) {
+            return false;
+        }
+        block->nativeGeneration = generation;
+        blocksCompiled++;
+    }
+
+    // The native block runs to completion, so the interpreter must start afresh wherever it stops
+    gbc.blockCache.leaveBlock();
+    entryGeneration = gbc.blockCache.getCodeGeneration();
+    lastNativeBlock = block;
+    nativeBlocksRun++;
+    ((NativeBlock)block->nativeCode)(&gbc);
+    return true;
+}
+
+uint32_t Recompiler::readMemory(Gbc* gbc, uint32_t address) {
+    return gbc->read8(address);
+}
+
+void Recompiler::writeMemory(Gbc* gbc, uint32_t address, uint32_t value) {
+    gbc->write8(address, (uint8_t)value);
+}
+
+void Recompiler::materialiseFlags(Gbc* gbc) {
+    gbc->materialiseFlags();
+}
+
+bool Recompiler::afterInstruction(Gbc* gbc, uint32_t clocks) {
+    const uint32_t nextPc = gbc->cpuPc;
+    gbc->completeInstruction((int)clocks);
+
+    // Keep going within the block unless an interrupt was taken, the CPU stopped, time ran out, or code changed
+    return gbc->clocksAcc > 0 && gbc->cpuPc == nextPc && gbc->cpuMode == CPU_RUNNING && gbc->isRunning &&
+            gbc->blockCache.getCodeGeneration() == gbc->recompiler.entryGeneration;
+}
+
+#ifdef GBC_RECOMPILER_SUPPORTED
+
+// Load a byte from the address in ECX into EAX, reading mapped pages and HRAM directly
+static void emitRead(CodeEmitter& e, Gbc& gbc, const MemberOffsets& members, const void* readFunction) {
+    std::vector<size_t> toDone;
+
+    e.bytes({ 0x89, 0xca }); // mov edx, ecx
+    e.bytes({ 0xc1, 0xea, 0x08 }); // shr edx, 8
+    e.bytes({ 0x48, 0x8b, 0x94, 0xd3 }); // mov rdx, [rbx + rdx * 8 + readPages]
+    e.imm32((uint32_t)members.readPages);
+    e.bytes({ 0x48, 0x85, 0xd2 }); // test rdx, rdx
+    const size_t unmapped = e.jumpIf(CC_E);
+    e.bytes({ 0x0f, 0xb6, 0xc9 }); // movzx ecx, cl
+    e.bytes({ 0x0f, 0xb6, 0x04, 0x0a }); // movzx eax, byte [rdx + rcx]
+    toDone.push_back(e.jump());
+
+    // 0xff80 - 0xffff: HRAM and the interrupt enable register, which share a page with the IO registers
+    e.bind(unmapped);
+    e.cmpEcxImm(0xff80U);
+    const size_t notHram = e.jumpIf(CC_B);
+    e.andEcxImm(0x00ffU);
+    e.movImm64Rdx(gbc.ioPorts.data());
+    e.bytes({ 0x0f, 0xb6, 0x04, 0x0a });
+    toDone.push_back(e.jump());
+
+    // Everything else goes through read8
+    e.bind(notHram);
+    e.argFromEcx();
+    e.call(readFunction);
+
+    for (size_t patch : toDone) {
+        e.bind(patch);
+    }
+}
+
+// Store AL to the address in ECX, writing WRAM and HRAM directly unless the byte holds cached code
+static void emitWrite(CodeEmitter& e, Gbc& gbc, const MemberOffsets& members, const void* writeFunction,
+        const uint16_t* codeMap, uint32_t hramCodeMapOffset) {
+    std::vector<size_t> toDone;
+    std::vector<size_t> toSlowPath;
+    e.argFromEcx();
+    e.secondArgFromEax();
+
+    e.cmpEcxImm(0xc000U);
+    toSlowPath.push_back(e.jumpIf(CC_B));
+    e.cmpEcxImm(0xd000U);
+    const size_t notWram0 = e.jumpIf(CC_AE);
+    e.andEcxImm(0x0fffU);
+
+    // ECX holds an index into the WRAM vector
+    const size_t wramStore = e.code.size();
+    e.movImm64Rdx(codeMap);
+    e.bytes({ 0x66, 0x83, 0x3c, 0x4a, 0x00 }); // cmp word [rdx + rcx * 2], 0
+    toSlowPath.push_back(e.jumpIf(CC_NE));
+    e.movImm64Rdx(gbc.wram.data());
+    e.bytes({ 0x88, 0x04, 0x0a }); // mov [rdx + rcx], al
+    toDone.push_back(e.jump());
+
+    e.bind(notWram0);
+    e.cmpEcxImm(0xe000U);
+    const size_t notWramX = e.jumpIf(CC_AE);
+    e.andEcxImm(0x0fffU);
+    e.memberOp({ 0x03 }, ECX, members.wramBankOffset);
+    e.bytes({ 0xe9 }); // jmp wramStore
+    e.imm32((uint32_t)(int32_t)((int64_t)wramStore - (int64_t)(e.code.size() + 4)));
+
+    e.bind(notWramX);
+    e.cmpEcxImm(0xff80U);
+    toSlowPath.push_back(e.jumpIf(CC_B));
+    e.andEcxImm(0x007fU);
+    e.movImm64Rdx(codeMap + hramCodeMapOffset);
+    e.bytes({ 0x66, 0x83, 0x3c, 0x4a, 0x00 });
+    toSlowPath.push_back(e.jumpIf(CC_NE));
+    e.movImm64Rdx(gbc.ioPorts.data() + 0x80);
+    e.bytes({ 0x88, 0x04, 0x0a });
+    toDone.push_back(e.jump());
+
+    for (size_t patch : toSlowPath) {
+        e.bind(patch);
+    }
+    e.call(writeFunction);
+
+    for (size_t patch : toDone) {
+        e.bind(patch);
+    }
+}
+
+// ECX = BC, DE or HL, given by its high register's opcode index
+static void emitLoadPair(CodeEmitter& e, const MemberOffsets& members, int highIndex) {
+    e.loadWord(ECX, members.pairs[highIndex >> 1]);
+}
+
+// Increment or decrement BC, DE or HL, wrapping at 16 bits
+static void emitStepPair(CodeEmitter& e, const MemberOffsets& members, int highIndex, bool increment) {
+    e.stepWord(members.pairs[highIndex >> 1], increment);
+}
+
+// Make cpuF valid before native code reads it, skipping the call when no flags can be pending
+static void emitMaterialiseFlags(CodeEmitter& e, const MemberOffsets& members, const void* materialiseFunction,
+        FlagState& flagState) {
+    if (flagState == FlagState::MATERIALISED) {
+        return;
+    }
+    size_t skip = 0;
+    if (flagState == FlagState::UNKNOWN) {
+        e.cmpByteImm(members.lazyOperation, LazyFlags::NONE);
+        skip = e.jumpIf(CC_E);
+    }
+    e.call(materialiseFunction);
+    if (flagState == FlagState::UNKNOWN) {
+        e.bind(skip);
+    }
+    flagState = FlagState::MATERIALISED;
+}
+
+// Record an ALU operation for LazyFlags with A in AL and the second operand in CL
+static void emitRecordFlags(CodeEmitter& e, const MemberOffsets& members, LazyFlags::Operation operation,
+        FlagState& flagState) {
+    e.storeByteImm(members.lazyOperation, operation);
+    e.storeByte(EAX, members.lazyA);
+    e.storeByte(ECX, members.lazyValue);
+    flagState = FlagState::PENDING;
+}
+
+// Emit an instruction natively if it is simple enough, leaving its clock count in R10D. Returns false if the
+// instruction should go through its CpuOps handler instead.
+static bool emitInline(CodeEmitter& e, Gbc& gbc, const MemberOffsets& members, const DecodedInstruction& instruction,
+        const void* readFunction, const void* writeFunction, const void* materialiseFunction, const uint16_t* codeMap,
+        uint32_t hramCodeMapOffset, FlagState& flagState) {
+    const uint8_t op = instruction.opcode;
+    const uint32_t operand = instruction.operand;
+    const int x = op >> 6U;
+    const int y = (op >> 3U) & 0x07U;
+    const int z = op & 0x07U;
+    uint32_t clocks;
+
+    if (op == 0x00) { // nop
+        clocks = 4;
+    } else if (x == 0 && z == 1 && (y & 1) == 0) { // ld rr, nn
+        if (y == 6) {
+            e.storeDwordImm(members.sp, operand);
+        } else {
+            e.storeWordImm(members.pairs[y >> 1], (uint16_t)operand);
+        }
+        clocks = 12;
+    } else if (x == 0 && z == 3) { // inc rr, dec rr
+        if ((y >> 1) == 3) {
+            e.loadDword(EAX, members.sp);
+            e.bytes({ 0xff, (uint8_t)((y & 1) == 0 ? 0xc0 : 0xc8) });
+            e.bytes({ 0x25, 0xff, 0xff, 0x00, 0x00 }); // and eax, 0xffff
+            e.storeDword(EAX, members.sp);
+        } else {
+            emitStepPair(e, members, y & 6, (y & 1) == 0);
+        }
+        clocks = 8;
+    } else if (x == 0 && z == 2) { // ld (rr), A and ld A, (rr), with HL incremented or decremented
+        emitLoadPair(e, members, y < 4 ? y & 6 : 4);
+        if ((y & 1) == 0) {
+            e.loadByte(EAX, members.registers[7]);
+            emitWrite(e, gbc, members, writeFunction, codeMap, hramCodeMapOffset);
+        } else {
+            emitRead(e, gbc, members, readFunction);
+            e.storeByte(EAX, members.registers[7]);
+        }
+        if (y >= 4) {
+            emitStepPair(e, members, 4, y < 6);
+        }
+        clocks = 8;
+    } else if (x == 0 && (z == 4 || z == 5) && y != 6) { // inc r, dec r
+        // These keep the carry flag, so it has to be known before recording the operation
+        emitMaterialiseFlags(e, members, materialiseFunction, flagState);
+        const int32_t reg = members.registers[y];
+        e.loadByte(EAX, reg);
+        e.loadByte(ECX, members.f);
+        e.bytes({ 0x80, 0xe1, 0x10 }); // and cl, 0x10
+        e.storeByte(ECX, members.lazyCarry);
+        emitRecordFlags(e, members, z == 4 ? LazyFlags::INC : LazyFlags::DEC, flagState);
+        e.bytes({ 0xfe, (uint8_t)(z == 4 ? 0xc0 : 0xc8) }); // inc al / dec al
+        e.storeByte(EAX, reg);
+        clocks = 4;
+    } else if (x == 0 && z == 6 && y != 6) { // ld r, n
+        e.storeByteImm(members.registers[y], (uint8_t)operand);
+        clocks = 8;
+    } else if (op == 0x18) { // jr d
+        e.addDwordImm(members.pc, (uint32_t)(int8_t)operand);
+        clocks = 12;
+    } else if (x == 0 && z == 0 && y >= 4) { // jr cc, d
+        emitMaterialiseFlags(e, members, materialiseFunction, flagState);
+        e.testByteImm(members.f, y < 6 ? 0x80U : 0x10U);
+        const size_t notTaken = e.jumpIf((y & 1) == 0 ? CC_NE : CC_E);
+        e.addDwordImm(members.pc, (uint32_t)(int8_t)operand);
+        e.argImm(12);
+        const size_t done = e.jump();
+        e.bind(notTaken);
+        e.argImm(8);
+        e.bind(done);
+        return true;
+    } else if (x == 1 && op != 0x76) { // ld r, r
+        if (z == 6) {
+            emitLoadPair(e, members, 4);
+            emitRead(e, gbc, members, readFunction);
+            e.storeByte(EAX, members.registers[y]);
+            clocks = 8;
+        } else if (y == 6) {
+            emitLoadPair(e, members, 4);
+            e.loadByte(EAX, members.registers[z]);
+            emitWrite(e, gbc, members, writeFunction, codeMap, hramCodeMapOffset);
+            clocks = 8;
+        } else {
+            if (y != z) {
+                e.loadByte(EAX, members.registers[z]);
+                e.storeByte(EAX, members.registers[y]);
+            }
+            clocks = 4;
+        }
+    } else if ((x == 2 && z != 6) || (x == 3 && z == 6)) { // alu A, r and alu A, n, except adc and sbc
+        if (y == 1 || y == 3) {
+            return false;
+        }
+        if (x == 2) {
+            e.loadByte(ECX, members.registers[z]);
+            clocks = 4;
+        } else {
+            e.movImm(ECX, operand);
+            clocks = 8;
+        }
+        e.loadByte(EAX, members.registers[7]);
+        static constexpr LazyFlags::Operation operations[8] = {
+                LazyFlags::ADD, LazyFlags::ADC, LazyFlags::SUB, LazyFlags::SBC,
+                LazyFlags::AND, LazyFlags::XOR, LazyFlags::OR, LazyFlags::CP };
+        emitRecordFlags(e, members, operations[y], flagState);
+        if (y != 7) {
+            static constexpr uint8_t aluOpcodes[8] = { 0x00, 0x10, 0x28, 0x18, 0x20, 0x30, 0x08, 0x38 };
+            e.bytes({ aluOpcodes[y], 0xc8 }); // op al, cl
+            e.storeByte(EAX, members.registers[7]);
+        }
+    } else if (op == 0xe0 || op == 0xea) { // ldh (n), A and ld (nn), A
+        e.movImm(ECX, op == 0xe0 ? 0xff00U + operand : operand);
+        e.loadByte(EAX, members.registers[7]);
+        emitWrite(e, gbc, members, writeFunction, codeMap, hramCodeMapOffset);
+        clocks = op == 0xe0 ? 12 : 16;
+    } else if (op == 0xf0 || op == 0xfa) { // ldh A, (n) and ld A, (nn)
+        e.movImm(ECX, op == 0xf0 ? 0xff00U + operand : operand);
+        emitRead(e, gbc, members, readFunction);
+        e.storeByte(EAX, members.registers[7]);
+        clocks = op == 0xf0 ? 12 : 16;
+    } else if (op == 0xc3) { // jp nn
+        e.storeDwordImm(members.pc, operand);
+        clocks = 16;
+    } else if (op == 0xf3 || op == 0xfb) { // di, ei
+        e.storeByteImm(members.ime, op == 0xfb ? 1 : 0);
+        clocks = 4;
+    } else {
+        return false;
+    }
+
+    e.argImm(clocks);
+    return true;
+}
+
+#endif // GBC_RECOMPILER_SUPPORTED
+
+const uint8_t* Recompiler::compile(Gbc& gbc, const CachedBlock& block) {
+#ifdef GBC_RECOMPILER_SUPPORTED
+    if (codeBuffer == nullptr) {
+#ifdef _WIN32
+        codeBuffer = (uint8_t*)VirtualAlloc(nullptr, CODE_BUFFER_SIZE, MEM_COMMIT | MEM_RESERVE,
+                PAGE_EXECUTE_READWRITE);
+#else
+        void* memory = mmap(nullptr, CODE_BUFFER_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS,
+                -1, 0);
+        codeBuffer = memory == MAP_FAILED ? nullptr : (uint8_t*)memory;
+#endif
+        if (codeBuffer == nullptr) {
+            enabled = false;
+            return nullptr;
+        }
+    }
+
+    auto offset = [&gbc](const void* member) {
+        return (int32_t)((const uint8_t*)member - (const uint8_t*)&gbc);
+    };
+    MemberOffsets members{};
+    members.registers[0] = offset(&gbc.cpuBC.high);
+    members.registers[1] = offset(&gbc.cpuBC.low);
+    members.registers[2] = offset(&gbc.cpuDE.high);
+    members.registers[3] = offset(&gbc.cpuDE.low);
+    members.registers[4] = offset(&gbc.cpuHL.high);
+    members.registers[5] = offset(&gbc.cpuHL.low);
+    members.registers[7] = offset(&gbc.cpuA);
+    members.pairs[0] = offset(&gbc.cpuBC.word);
+    members.pairs[1] = offset(&gbc.cpuDE.word);
+    members.pairs[2] = offset(&gbc.cpuHL.word);
+    members.f = offset(&gbc.cpuF);
+    members.sp = offset(&gbc.cpuSp);
+    members.pc = offset(&gbc.cpuPc);
+    members.ime = offset(&gbc.cpuIme);
+    members.bankOffset = offset(&gbc.bankOffset);
+    members.wramBankOffset = offset(&gbc.wramBankOffset);
+    members.readPages = offset(&gbc.readPages);
+    members.lazyOperation = offset(&gbc.lazyFlags.operation);
+    members.lazyA = offset(&gbc.lazyFlags.a);
+    members.lazyValue = offset(&gbc.lazyFlags.value);
+    members.lazyCarry = offset(&gbc.lazyFlags.carry);
+    const auto readFunction = (const void*)&Recompiler::readMemory;
+    const auto writeFunction = (const void*)&Recompiler::writeMemory;
+    const auto completeFunction = (const void*)&Recompiler::afterInstruction;
+    const auto materialiseFunction = (const void*)&Recompiler::materialiseFlags;
+    const uint16_t* codeMap = gbc.blockCache.ramCodeMap.data();
+
+    CodeEmitter e;
+    e.prologue();
+    const size_t blockStart = e.code.size();
+    std::vector<size_t> toExit;
+    FlagState flagState = FlagState::UNKNOWN;
+    for (const DecodedInstruction& instruction : block.instructions) {
+        // Same order as the dispatcher: advance the PC, run the instruction, then everything that follows it
+        e.addDwordImm(members.pc, instruction.length);
+        if (!emitInline(e, gbc, members, instruction, readFunction, writeFunction, materialiseFunction, codeMap,
+                BlockCache::HRAM_CODE_MAP_OFFSET, flagState)) {
+            e.argImm(instruction.operand);
+            e.call((const void*)instruction.handler);
+            e.argFromEax();
+            flagState = FlagState::UNKNOWN;
+        }
+        e.call(completeFunction);
+        e.bytes({ 0x84, 0xc0 }); // test al, al
+        toExit.push_back(e.jumpIf(CC_E));
+    }
+
+    // Blocks that branch back to their own start, i.e. tight loops, go round again without leaving native code
+    e.cmpDwordImm(members.pc, block.startPc);
+    e.jumpIfBack(CC_E, blockStart);
+    for (size_t patch : toExit) {
+        e.bind(patch);
+    }
+    e.epilogue();
+
+    if (e.code.size() > CODE_BUFFER_SIZE - codeBufferUsed) {
+        // Out of space: start again, which invalidates every translation made so far
+        generation++;
+        codeBufferUsed = 0;
+    }
+    uint8_t* destination = codeBuffer + codeBufferUsed;
+    std::memcpy(destination, e.code.data(), e.code.size());
+    codeBufferUsed += (e.code.size() + 15U) & ~(size_t)15U;
+    return destination;
+#else
+    return nullptr;
+#endif
+}
+
+void Recompiler::synchroniseReference(Gbc& gbc) {
+    if (!reference) {
+        reference = std::make_unique<Gbc>();
+        reference->rom = gbc.rom;
+        reference->romProperties = gbc.romProperties;
+        reference->reset();
+        reference->idleLoops.setEnabled(false);
+    }
+    std::stringstream state;
+    gbc.saveSaveState(state);
+    reference->loadSaveState(state);
+    reference->executedInstructions = gbc.executedInstructions;
+}
+
+void Recompiler::checkAgainstReference(Gbc& gbc, uint64_t instructionCount, bool ranNative) {
+    if (!reference) {
+        synchroniseReference(gbc);
+        return;
+    }
+
+    // Step the reference through the same instructions with the plain interpreter
+    for (uint64_t i = 0; i < instructionCount; i++) {
+        reference->completeInstruction(CpuOps::dispatch(*reference));
+    }
+    if (!ranNative) {
+        return;
+    }
+
+    // Compare registers as the program would see them, whichever of the two last caught up
+    gbc.syncSubsystems();
+    reference->syncSubsystems();
+    const Gbc& ref = *reference;
+    const bool matches = gbc.cpuPc == ref.cpuPc && gbc.cpuSp == ref.cpuSp && gbc.cpuA == ref.cpuA &&
+            gbc.peekFlags() == ref.peekFlags() && gbc.cpuBC.word == ref.cpuBC.word &&
+            gbc.cpuDE.word == ref.cpuDE.word && gbc.cpuHL.word == ref.cpuHL.word && gbc.cpuIme == ref.cpuIme &&
+            gbc.cpuMode == ref.cpuMode && gbc.wram == ref.wram && gbc.ioPorts == ref.ioPorts;
+    if (!matches) {
+        // Stop running this block natively, and carry on from the state the native code left behind
+        differentialMismatches++;
+        lastMismatchPc = lastNativeBlock->startPc;
+        lastNativeBlock->nativeDisabled = true;
+        synchroniseReference(gbc);
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define GBC_RECOMPILER_SUPPORTED
+#endif
+
+class Gbc;
+struct CachedBlock;
+
+// Translates hot blocks from the BlockCache into x86-64 code. Registers stay in the Gbc object; the native code
+// performs simple instructions and ROM/WRAM/HRAM accesses itself, calls the CpuOps handlers for everything else,
+// and runs Gbc::completeInstruction after every instruction so timing matches the interpreter exactly.
+class Recompiler {
+    static constexpr size_t CODE_BUFFER_SIZE = 4 * 1024 * 1024;
+    static constexpr uint64_t HOT_BLOCK_THRESHOLD = 8;
+
+    typedef void (*NativeBlock)(Gbc* gbc);
+
+    bool enabled = false;
+    bool differentialMode = false;
+    uint8_t* codeBuffer = nullptr;
+    size_t codeBufferUsed = 0;
+    uint32_t generation = 1;
+    uint32_t entryGeneration = 0;
+
+    // Interpreter-only copy of the machine that native blocks are checked against in differential mode
+    std::unique_ptr<Gbc> reference;
+    CachedBlock* lastNativeBlock = nullptr;
+
+    bool runNativeBlock(Gbc& gbc);
+    const uint8_t* compile(Gbc& gbc, const CachedBlock& block);
+    void synchroniseReference(Gbc& gbc);
+    void checkAgainstReference(Gbc& gbc, uint64_t instructionCount, bool ranNative);
+
+    // Entry points for native code
+    static uint32_t readMemory(Gbc* gbc, uint32_t address);
+    static void writeMemory(Gbc* gbc, uint32_t address, uint32_t value);
+    static bool afterInstruction(Gbc* gbc, uint32_t clocks);
+    static void materialiseFlags(Gbc* gbc);
+
+public:
+    uint64_t blocksCompiled = 0;
+    uint64_t nativeBlocksRun = 0;
+    uint64_t differentialMismatches = 0;
+    uint32_t lastMismatchPc = 0;
+
+    Recompiler() = default;
+    ~Recompiler();
+    Recompiler(const Recompiler&) = delete;
+    Recompiler& operator=(const Recompiler&) = delete;
+
+    [[nodiscard]] static bool isSupported();
+    void setEnabled(bool enable);
+    [[nodiscard]] bool isEnabled() const { return enabled; }
+
+    // Check each native block against the interpreter running in lockstep; blocks that disagree are reported in
+    // the mismatch counters and not run natively again
+    void setDifferentialMode(bool enable);
+    [[nodiscard]] bool isDifferentialMode() const { return differentialMode; }
+
+    // Drop all translations, e.g. after a reset or loading a state
+    void clear();
+
+    // Called at the start of each Gbc::executeAccumulatedClocks
+    void beginRun(Gbc& gbc);
+
+    // Run a native block if one is ready at the PC, otherwise interpret one instruction
+    void execute(Gbc& gbc);
+};
@@ -0,0 +1,99 @@
+#include "romimage.h"
+
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Owns the bytes an image points at: either a copy, or a read-only view of a mapped file
+struct RomImage::Storage {
+    std::vector<uint8_t> copy;
+    void* view = nullptr;
+    size_t viewLength = 0;
+
+    Storage() = default;
+    Storage(const Storage&) = delete;
+    Storage& operator=(const Storage&) = delete;
+
+    ~Storage() {
+        if (view != nullptr) {
+#ifdef _WIN32
+            UnmapViewOfFile(view);
+#else
+            munmap(view, viewLength);
+#endif
+        }
+    }
+};
+
+// Unused space in the last bank reads as 0xff, as it would from a ROM chip with nothing there
+RomImage RomImage::copyOf(const uint8_t* data, size_t dataLength) {
+    RomImage image;
+    if (data == nullptr || dataLength == 0) {
+        return image;
+    }
+    auto storage = std::make_shared<Storage>();
+    const size_t paddedLength = (dataLength + BANK_SIZE - 1) / BANK_SIZE * BANK_SIZE;
+    storage->copy.assign(data, data + dataLength);
+    storage->copy.resize(paddedLength, 0xffU);
+    image.bytes = storage->copy.data();
+    image.length = storage->copy.size();
+    image.storage = std::move(storage);
+    return image;
+}
+
+RomImage RomImage::mapFile(const std::string& fileName) {
+    RomImage image;
+    auto storage = std::make_shared<Storage>();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file != INVALID_HANDLE_VALUE) {
+        LARGE_INTEGER fileSize;
+        if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0 && fileSize.QuadPart % BANK_SIZE == 0) {
+            // The view keeps the mapping alive once both handles are closed
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping != nullptr) {
+                storage->view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                storage->viewLength = (size_t)fileSize.QuadPart;
+                CloseHandle(mapping);
+            }
+        }
+        CloseHandle(file);
+    }
+#else
+    const int file = open(fileName.c_str(), O_RDONLY);
+    if (file >= 0) {
+        struct stat fileStat{};
+        if (fstat(file, &fileStat) == 0 && fileStat.st_size > 0 && fileStat.st_size % BANK_SIZE == 0) {
+            void* view = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+            if (view != MAP_FAILED) {
+                storage->view = view;
+                storage->viewLength = (size_t)fileStat.st_size;
+            }
+        }
+        close(file);
+    }
+#endif
+    if (storage->view != nullptr) {
+        image.bytes = static_cast<const uint8_t*>(storage->view);
+        image.length = storage->viewLength;
+        image.storage = std::move(storage);
+        return image;
+    }
+
+    std::ifstream stream(fileName, std::ios::in | std::ios::binary);
+    if (!stream.is_open()) {
+        return image;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    return copyOf(data.data(), data.size());
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// A ROM's contents, never modified once loaded and sized to the ROM itself, rounded up to a whole 16 KB bank. Copies
+// of an image share the same bytes, which are freed or unmapped once the last copy is gone, so any number of Gbc
+// instances running the same ROM can hold just one of it.
+class RomImage {
+    struct Storage;
+    std::shared_ptr<const Storage> storage;
+    const uint8_t* bytes = nullptr;
+    size_t length = 0;
+
+public:
+    static constexpr size_t BANK_SIZE = 0x4000;
+
+    // Copies the data given, or maps the file into memory without copying it, falling back to reading it in if
+    // mapping isn't possible or the file isn't a whole number of banks. Either gives an empty image on failure.
+    [[nodiscard]] static RomImage copyOf(const uint8_t* data, size_t dataLength);
+    [[nodiscard]] static RomImage mapFile(const std::string& fileName);
+
+    [[nodiscard]] inline const uint8_t* data() const { return bytes; }
+    [[nodiscard]] inline size_t size() const { return length; }
+    [[nodiscard]] inline bool empty() const { return length == 0; }
+    inline uint8_t operator[](size_t offset) const { return bytes[offset]; }
+};
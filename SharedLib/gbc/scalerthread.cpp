@@ -0,0 +1,76 @@
+#include "scalerthread.h"
+
+#include <utility>
+
+ScalerThread::ScalerThread(Work work) :
+    work(std::move(work)),
+    working(false),
+    stopping(false),
+    framesScaled(0),
+    lastLatencyMicros(0),
+    maxLatencyMicros(0),
+    totalLatencyMicros(0) {}
+
+// Frames still queued are left unscaled
+ScalerThread::~ScalerThread() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    jobQueued.notify_one();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+void ScalerThread::queue(Frame& frame) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        jobs.push_back({ &frame, std::chrono::steady_clock::now() });
+        if (!thread.joinable()) {
+            thread = std::thread(&ScalerThread::run, this);
+        }
+    }
+    jobQueued.notify_one();
+}
+
+// Blocks until every frame queued so far has been scaled, for callers that want each frame as soon as it's finished
+void ScalerThread::waitUntilIdle() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    queueEmptied.wait(lock, [&]() { return jobs.empty() && !working; });
+}
+
+uint64_t ScalerThread::getAverageLatencyMicros() const {
+    const uint64_t frames = framesScaled;
+    return frames == 0 ? 0 : totalLatencyMicros / frames;
+}
+
+void ScalerThread::run() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    while (true) {
+        jobQueued.wait(lock, [&]() { return stopping || !jobs.empty(); });
+        if (stopping) {
+            return;
+        }
+        const Job job = jobs.front();
+        jobs.pop_front();
+        working = true;
+        lock.unlock();
+
+        work(*job.frame);
+        const auto latency = std::chrono::steady_clock::now() - job.queuedAt;
+        const auto micros = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+        lastLatencyMicros = micros;
+        if (micros > maxLatencyMicros) {
+            maxLatencyMicros = micros;
+        }
+        totalLatencyMicros += micros;
+        framesScaled++;
+
+        lock.lock();
+        working = false;
+        if (jobs.empty()) {
+            queueEmptied.notify_all();
+        }
+    }
+}
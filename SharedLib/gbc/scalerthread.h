@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+class Frame;
+
+// A thread of its own that finished frames are handed to for scaling, so that emulation never waits for it. Frames
+// are scaled one at a time in the order they were queued, and the time each takes from being queued to being scaled
+// is recorded. The thread is started with the first frame queued and stopped when this is destroyed.
+class ScalerThread {
+public:
+    using Work = std::function<void(Frame&)>;
+
+private:
+    struct Job {
+        Frame* frame;
+        std::chrono::steady_clock::time_point queuedAt;
+    };
+
+    Work work;
+    std::thread thread;
+    std::mutex queueMutex;
+    std::condition_variable jobQueued;
+    std::condition_variable queueEmptied;
+    std::deque<Job> jobs;
+    bool working;
+    bool stopping;
+
+    std::atomic<uint64_t> framesScaled;
+    std::atomic<uint64_t> lastLatencyMicros;
+    std::atomic<uint64_t> maxLatencyMicros;
+    std::atomic<uint64_t> totalLatencyMicros;
+
+    void run();
+
+public:
+    explicit ScalerThread(Work work);
+    ~ScalerThread();
+    ScalerThread(const ScalerThread&) = delete;
+    ScalerThread& operator=(const ScalerThread&) = delete;
+
+    void queue(Frame& frame);
+    void waitUntilIdle();
+
+    [[nodiscard]] inline uint64_t getScaledFrameCount() const { return framesScaled; }
+    [[nodiscard]] inline uint64_t getLastLatencyMicros() const { return lastLatencyMicros; }
+    [[nodiscard]] inline uint64_t getMaxLatencyMicros() const { return maxLatencyMicros; }
+    [[nodiscard]] uint64_t getAverageLatencyMicros() const;
+};
@@ -0,0 +1,59 @@
+#include "tilecache.h"
+
+#include <cstring>
+
+namespace {
+    // Each bit of a byte spread into a byte of its own, most significant first, or least significant first for the
+    // flipped table. Built byte by byte so that the in-memory order is the same whatever the host's byte order;
+    // shifting a whole entry left by one then moves the second plane's bits into place without crossing bytes.
+    struct SpreadTables {
+        uint64_t forward[256]{};
+        uint64_t reversed[256]{};
+
+        SpreadTables() {
+            for (unsigned int value = 0; value < 256; value++) {
+                uint8_t forwardBytes[8];
+                uint8_t reversedBytes[8];
+                for (unsigned int x = 0; x < 8; x++) {
+                    forwardBytes[x] = (uint8_t)((value >> (7U - x)) & 0x01U);
+                    reversedBytes[x] = (uint8_t)((value >> x) & 0x01U);
+                }
+                memcpy(&forward[value], forwardBytes, 8);
+                memcpy(&reversed[value], reversedBytes, 8);
+            }
+        }
+    };
+
+    const SpreadTables spreadTables;
+}
+
+void TileCache::attach(const uint8_t* vramData) {
+    vram = vramData;
+    invalidateAll();
+}
+
+void TileCache::invalidateAll() {
+    memset(dirty, 0xff, sizeof(dirty));
+    memset(flippedDirty, 0xff, sizeof(flippedDirty));
+}
+
+// Offsets run from start up to but not including end, bank 1 starting at 0x2000
+void TileCache::invalidateRange(unsigned int start, unsigned int end) {
+    for (unsigned int offset = start & ~0x0fU; offset < end; offset += 16) {
+        invalidate(offset);
+    }
+}
+
+void TileCache::decode(unsigned int tile, bool flipped) {
+    const unsigned int bank = tile >= TILES_PER_BANK ? 1 : 0;
+    const uint8_t* data = vram + bank * 0x2000U + (tile - bank * TILES_PER_BANK) * 16;
+    const uint64_t* spread = flipped ? spreadTables.reversed : spreadTables.forward;
+    uint8_t* pixels = flipped ? flippedTiles[tile] : tiles[tile];
+    for (unsigned int y = 0; y < 8; y++) {
+        // The first byte of each row holds bit 0 of every pixel's colour number, the second bit 1
+        const uint64_t row = spread[data[2 * y]] | (spread[data[2 * y + 1]] << 1U);
+        memcpy(pixels + 8 * y, &row, 8);
+    }
+    uint64_t* bits = flipped ? flippedDirty : dirty;
+    bits[tile >> 6U] &= ~(1ULL << (tile & 63U));
+}
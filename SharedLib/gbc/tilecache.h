@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+
+// Tile patterns decoded from VRAM's two bit planes into a byte per pixel, the form the line renderer reads, along
+// with horizontally flipped copies for sprites and CGB background attributes. VRAM writes only mark the tile they
+// touch as dirty; each form of a tile is decoded again the first time the renderer asks for one of its rows after
+// that, so a tile rewritten many times between lines, or never drawn, costs nothing extra.
+class TileCache {
+public:
+    static constexpr unsigned int TILES_PER_BANK = 384;
+    static constexpr unsigned int TILE_COUNT = 2 * TILES_PER_BANK;
+
+private:
+    static constexpr unsigned int DIRTY_WORDS = TILE_COUNT / 64;
+
+    const uint8_t* vram = nullptr;
+    alignas(64) uint8_t tiles[TILE_COUNT][64]{};
+    alignas(64) uint8_t flippedTiles[TILE_COUNT][64]{};
+    uint64_t dirty[DIRTY_WORDS]{};
+    uint64_t flippedDirty[DIRTY_WORDS]{};
+
+    void decode(unsigned int tile, bool flipped);
+
+public:
+    // Bytes in use for decoded tiles and their dirty bits, as opposed to VRAM itself
+    static constexpr unsigned int FOOTPRINT = sizeof(tiles) + sizeof(flippedTiles) + sizeof(dirty) + sizeof(flippedDirty);
+
+    // VRAM is read from both banks, bank 1 starting 0x2000 bytes in
+    void attach(const uint8_t* vramData);
+    void invalidateAll();
+    void invalidateRange(unsigned int start, unsigned int end);
+
+    // Called with the offset of any VRAM byte written, bank 1 starting at 0x2000
+    inline void invalidate(unsigned int vramOffset) {
+        const unsigned int address = vramOffset & 0x1fffU;
+        if (address < 0x1800U) {
+            const unsigned int tile = (vramOffset >> 13U) * TILES_PER_BANK + (address >> 4U);
+            const uint64_t bit = 1ULL << (tile & 63U);
+            dirty[tile >> 6U] |= bit;
+            flippedDirty[tile >> 6U] |= bit;
+        }
+    }
+
+    // The 8 colour numbers of a row of a tile, numbered 0 to 767 across both banks, left to right
+    [[nodiscard]] inline const uint8_t* row(unsigned int tile, unsigned int y) {
+        if (dirty[tile >> 6U] & (1ULL << (tile & 63U))) {
+            decode(tile, false);
+        }
+        return &tiles[tile][8 * y];
+    }
+
+    // The same row, right to left
+    [[nodiscard]] inline const uint8_t* flippedRow(unsigned int tile, unsigned int y) {
+        if (flippedDirty[tile >> 6U] & (1ULL << (tile & 63U))) {
+            decode(tile, true);
+        }
+        return &flippedTiles[tile][8 * y];
+    }
+};
@@ -9,7 +9,9 @@
 #include "../messagedefs.h"
 #include "gbcui.h"
 
+#include <algorithm>
 #include <string>
+#include <thread>
 
 std::string GbcApp::pendingFileToOpen;
 
@@ -19,6 +21,9 @@ GbcApp::GbcApp(AppPlatform& platform) : menu(Menu::buildMain()), platform(platfo
     gbcKeys.clear();
     renderer = nullptr;
     audioStreamer = nullptr;
+
+    // Upscale with up to half the cores, leaving the rest for emulation, rendering and everything else
+    gbc.frameManager.setScalerThreads(std::min(std::max(std::thread::hardware_concurrency() / 2, 1U), 4U));
 }
 
 GbcApp::~GbcApp() = default;
@@ -135,6 +140,26 @@ void GbcApp::processMsg(const Message& msg) {
 		case Action::MSG_OPEN_DEBUGGER:
 			platform.openDebugWindow(&gbc);
 			break;
+        case Action::MSG_SCALE_NONE:
+        case Action::MSG_SCALE_NEAREST_2X:
+        case Action::MSG_SCALE_NEAREST_3X:
+        case Action::MSG_SCALE_NEAREST_4X:
+        case Action::MSG_SCALE_SCALE2X:
+        case Action::MSG_SCALE_XBR_2X:
+        case Action::MSG_SCALE_XBR_3X:
+        case Action::MSG_SCALE_XBR_4X:
+            // Handled here, on the thread that runs the emulator, as the scaler must only be changed between frames
+            gbc.frameManager.setScaler((ScalerType)((int)msg.msg - (int)Action::MSG_SCALE_NONE));
+            break;
+        case Action::MSG_FRAMESKIP_OFF:
+        case Action::MSG_FRAMESKIP_1:
+        case Action::MSG_FRAMESKIP_2:
+        case Action::MSG_FRAMESKIP_3:
+            gbc.frameManager.setFrameSkip((int)msg.msg - (int)Action::MSG_FRAMESKIP_OFF);
+            break;
+        case Action::MSG_FRAMESKIP_AUTO:
+            gbc.frameManager.setFrameSkip(FrameManager::AUTO_FRAME_SKIP);
+            break;
         default: ;
     }
 }
@@ -167,8 +192,6 @@ bool GbcApp::createAudioStreamer() {
     return true;
 }
 
-uint64_t startTime = 0;
-uint64_t frameTimeAccumulated = 0;
 void GbcApp::doWork() {
     // Get timing
     if (startTime == 0) {
@@ -17,6 +17,8 @@ private:
     GbcAppState state;
 	AudioStreamer* audioStreamer;
     GbcRenderer* renderer;
+    uint64_t startTime = 0;
+    uint64_t frameTimeAccumulated = 0;
     void updateState(uint64_t timeDiffMillis);
     void openRomFile(Resource* file);
 protected:
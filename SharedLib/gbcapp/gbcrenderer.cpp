@@ -20,7 +20,9 @@ GbcRenderer::GbcRenderer(AppPlatform* appPlatform, PlatformRenderer* platformRen
         appPlatform(appPlatform),
         platformRenderer(platformRenderer),
         gbc(gbc),
-        windowTextureHandle(0) {
+        windowTextureHandle(0),
+        windowTextureScale(0),
+        windowTextureFilled(false) {
     showFullUi = appPlatform->usesTouch;
     requestedWidth = 0;
     requestedHeight = 0;
@@ -106,7 +108,13 @@ bool GbcRenderer::initObject() {
     // Create window assets
     float* scaledWindowFloats = generateWindowFloats(0.8f, aspect);
     windowVbo = platformRenderer->createVbo(scaledWindowFloats, windowFloatCount);
-    this->windowTextureHandle = platformRenderer->createTexture(TEXTURE_FORMAT_RGBA, nullptr, 160 * 4, 144 * 4, false);
+
+    // The window's texture is only made once the first frame shows what size it has to be, and then needs a frame
+    // drawn in full to fill it, as the frames elided in the meantime have nothing to upload
+    this->windowTextureHandle = 0;
+    this->windowTextureScale = 0;
+    this->windowTextureFilled = false;
+    gbc->frameManager.requestFullFrame();
 
     // Make sure rendering functions didn't generate an error
     platformRenderer->verifyNoError();
@@ -155,6 +163,20 @@ bool GbcRenderer::initObject() {
     return contextCreated;
 }
 
+// Remakes the window's texture whenever frames come in a different size, following the scaler in use
+void GbcRenderer::fitWindowTexture(unsigned int scale) {
+    if (scale == windowTextureScale) {
+        return;
+    }
+    if (windowTextureHandle != 0) {
+        platformRenderer->deleteTexture(windowTextureHandle);
+    }
+    windowTextureHandle = platformRenderer->createTexture(TEXTURE_FORMAT_RGBA, nullptr, BASE_FRAME_W * scale, BASE_FRAME_H * scale, false);
+    windowTextureScale = scale;
+    windowTextureFilled = false;
+    frameConfigs[FCT::GAME_WINDOW].renderConfigs[RCT::GAME_WINDOW].texture = windowTextureHandle;
+}
+
 void GbcRenderer::preCleanup() {
     isValid = false;
     frameConditionVariable.notify_one();
@@ -253,9 +275,19 @@ void GbcRenderer::doWork() {
                 float aspect = (float)width / (float)height;
                 glm::mat4 mainMvpMatrix = glm::scale(glm::mat4(1.0f), glm::vec3(1.0f / aspect, 1.0f, 1.0f));
 
-                platformRenderer->subTexture(this->windowTextureHandle, TEXTURE_FORMAT_RGBA, 0, 0, 160 * 4, 144 * 4, (unsigned char*)upscaledFrameBuffer);
+                // Frames no different from the last have nothing in their buffers to upload, so the texture is left
+                // showing what it already has. A texture just made has nothing to show until a frame drawn in full
+                // comes, which is asked for and waited for rather than drawing the empty texture.
+                const unsigned int scale = gbc->frameManager.getFrameScale(upscaledFrameBuffer);
+                fitWindowTexture(scale);
+                if (!gbc->frameManager.isUnchanged(upscaledFrameBuffer)) {
+                    platformRenderer->subTexture(this->windowTextureHandle, TEXTURE_FORMAT_RGBA, 0, 0, (int)(BASE_FRAME_W * scale), (int)(BASE_FRAME_H * scale), (unsigned char*)upscaledFrameBuffer);
+                    windowTextureFilled = true;
+                } else if (!windowTextureFilled) {
+                    gbc->frameManager.requestFullFrame();
+                }
                 bool frameFreed = gbc->frameManager.freeFrame(upscaledFrameBuffer);
-                if (frameFreed) {
+                if (frameFreed && windowTextureFilled) {
                     // Set uniforms for the heads-up display rectangles
                     firstConfig = 2;
                     configCount = 2;
@@ -28,6 +28,9 @@ namespace RCT {
 
 class GbcRenderer : public Thread {
     unsigned int windowTextureHandle;
+    unsigned int windowTextureScale;
+    bool windowTextureFilled;
+    void fitWindowTexture(unsigned int scale);
     Gbc* gbc;
     bool showFullUi;
     bool frameQueued;
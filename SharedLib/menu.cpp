@@ -15,6 +15,23 @@ Menu Menu::buildMain() {
                         Menu {L"Open ROM", Action::MSG_OPEN_FILE},
                         Menu {L"Show debug window", Action::MSG_OPEN_DEBUGGER}
                     }},
+                    Menu {L"Scaling", {
+                        Menu {L"None", Action::MSG_SCALE_NONE},
+                        Menu {L"Nearest 2x", Action::MSG_SCALE_NEAREST_2X},
+                        Menu {L"Nearest 3x", Action::MSG_SCALE_NEAREST_3X},
+                        Menu {L"Nearest 4x", Action::MSG_SCALE_NEAREST_4X},
+                        Menu {L"Scale2x", Action::MSG_SCALE_SCALE2X},
+                        Menu {L"xBR 2x", Action::MSG_SCALE_XBR_2X},
+                        Menu {L"xBR 3x", Action::MSG_SCALE_XBR_3X},
+                        Menu {L"xBR 4x", Action::MSG_SCALE_XBR_4X}
+                    }},
+                    Menu {L"Frameskip", {
+                        Menu {L"Off", Action::MSG_FRAMESKIP_OFF},
+                        Menu {L"1 frame", Action::MSG_FRAMESKIP_1},
+                        Menu {L"2 frames", Action::MSG_FRAMESKIP_2},
+                        Menu {L"3 frames", Action::MSG_FRAMESKIP_3},
+                        Menu {L"Auto", Action::MSG_FRAMESKIP_AUTO}
+                    }},
                     Menu {L"Exit", Action::MSG_REQUEST_EXIT}
             }
     };
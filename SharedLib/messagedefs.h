@@ -7,5 +7,22 @@ enum class Action {
     MSG_OPEN_FILE,
     MSG_FILE_RETRIEVED,
     MSG_UPDATE_SIZE,
-	MSG_OPEN_DEBUGGER
+	MSG_OPEN_DEBUGGER,
+
+    // Scaler choices, in the same order as ScalerType
+    MSG_SCALE_NONE,
+    MSG_SCALE_NEAREST_2X,
+    MSG_SCALE_NEAREST_3X,
+    MSG_SCALE_NEAREST_4X,
+    MSG_SCALE_SCALE2X,
+    MSG_SCALE_XBR_2X,
+    MSG_SCALE_XBR_3X,
+    MSG_SCALE_XBR_4X,
+
+    // Frameskip choices, frames left undrawn after each one drawn
+    MSG_FRAMESKIP_OFF,
+    MSG_FRAMESKIP_1,
+    MSG_FRAMESKIP_2,
+    MSG_FRAMESKIP_3,
+    MSG_FRAMESKIP_AUTO
 };
@@ -15,6 +15,7 @@ public:
     virtual int queryAttribLocation(unsigned int program, const char* attribName) = 0;
     virtual int queryUniformLocation(unsigned int program, const char* uniformName) = 0;
     virtual unsigned int createTexture(int textureFormat, const unsigned char* rawData, size_t imageWidth, size_t imageHeight, bool useLinearMagFilter) = 0;
+    virtual void deleteTexture(unsigned int texture) = 0;
     virtual unsigned int createVbo(float* data, size_t length) = 0;
     virtual void configureAttribute(int attributeLayout, int strideElements, int index, int size) = 0;
     virtual void setUniform1i(int layout, int value) = 0;
@@ -228,6 +228,11 @@ unsigned int AndroidRenderer::createTexture(int textureFormat, const unsigned ch
     return texture;
 }
 
+void AndroidRenderer::deleteTexture(unsigned int texture) {
+    GLuint textureName = texture;
+    glDeleteTextures(1, &textureName);
+}
+
 unsigned int AndroidRenderer::createVbo(float* data, size_t length) {
     // Create a VBO
     GLuint vbo;
@@ -25,6 +25,9 @@
  * Removed DLL-specific declspec modifiers to allow building as a static lib.
  * Removed hqx functionality.
  * Unravelled some macros.
+ * Reduced the RGB to YUV table to the colours with 5 bits per channel.
+ * Added filters over a band of rows.
+ * Added a 4x filter working on several pixels at once.
  */
 
 #ifndef __LIBXBR_FILTERS_H_INCLUDED
@@ -43,8 +46,12 @@ extern "C" {
 	#define XBR_INLINE inline
 #endif
 
+/* YUV of each colour whose channels all have their low 3 bits clear, as every
+ * colour with 5 bits per channel does when expanded to 8. Colours differing from
+ * one of these by the same amount in every channel are looked up from it too;
+ * others are converted as they're met, to the same values. */
 typedef struct {
-    uint32_t rgbtoyuv[1<<24];
+    uint32_t rgbtoyuv[1<<15];
 } xbr_data;
 
 typedef struct {
@@ -59,6 +66,21 @@ void xbr_filter_xbr2x(const xbr_params *ctx);
 void xbr_filter_xbr3x(const xbr_params *ctx);
 void xbr_filter_xbr4x(const xbr_params *ctx);
 
+/* Filter input rows firstRow to firstRow + rowCount - 1 only, writing just their
+ * output rows. Up to two rows either side of the band are read as they are for
+ * the whole image, so bands can be filtered in parallel into the same output. */
+void xbr_filter_xbr2x_rows(const xbr_params *ctx, int firstRow, int rowCount);
+void xbr_filter_xbr3x_rows(const xbr_params *ctx, int firstRow, int rowCount);
+void xbr_filter_xbr4x_rows(const xbr_params *ctx, int firstRow, int rowCount);
+
+/* The 4x filter deciding the edges of 8 pixels at a time with AVX2, or 4 with
+ * SSE2 or NEON, whichever the compiler targets, for output identical to the
+ * above. Without any of them, or with XBR_SCALAR defined, these are the same as
+ * the above. xbr_simd_name says which is in use. */
+void xbr_filter_xbr4x_simd(const xbr_params *ctx);
+void xbr_filter_xbr4x_simd_rows(const xbr_params *ctx, int firstRow, int rowCount);
+const char *xbr_simd_name(void);
+
 void xbr_init_data(xbr_data *data);
 
 
@@ -33,6 +33,23 @@
 #define XBR_INTERNAL
 #include "filters.h"
 #include <cstdlib>
+#include <cstring>
+
+#if !defined(XBR_SCALAR)
+#if defined(__AVX2__)
+#define XBR_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#define XBR_SSE
+#include <emmintrin.h>
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define XBR_NEON
+#include <arm_neon.h>
+#endif
+#endif
 
 #define PART_MASK     0x00FF00FF
 
@@ -42,11 +59,40 @@
 #define UMASK 0x00ff00
 #define VMASK 0x0000ff
 
+#define LOW_BITS_MASK 0x070707
+#define EACH_CHANNEL  0x010101
+
+static XBR_INLINE uint32_t rgb_to_yuv(uint32_t c)
+{
+    const int r = (int)((c >> 16) & 0xff);
+    const int g = (int)((c >>  8) & 0xff);
+    const int b = (int)( c        & 0xff);
+    const int rg = r - g;
+    const int bg = b - g;
+    const uint32_t y = (uint32_t)((299*r + 587*g + 114*b)/1000);
+    const uint32_t u = (uint32_t)((-169*rg + 500*bg)/1000) + 128;
+    const uint32_t v = (uint32_t)(( 500*rg -  81*bg)/1000) + 128;
+    return (y << 16) + (u << 8) + v;
+}
+
+static XBR_INLINE uint32_t table_index(uint32_t c)
+{
+    return ((c >> 3) & 0x001f) | ((c >> 6) & 0x03e0) | ((c >> 9) & 0x7c00);
+}
+
+/* Adding the same amount to every channel adds exactly that to Y and leaves U and
+ * V alone, so the table covers any colour whose channels' low 3 bits all match */
+static XBR_INLINE uint32_t lookup_yuv(uint32_t c, const uint32_t *r2y)
+{
+    const uint32_t low = c & 0x07;
+    return (c & LOW_BITS_MASK) == low * EACH_CHANNEL ? r2y[table_index(c)] + (low << 16) : rgb_to_yuv(c);
+}
+
 static uint32_t pixel_diff(uint32_t x, uint32_t y, const uint32_t *r2y)
 {
 
-    uint32_t yuv1 = r2y[x & 0xffffff];
-    uint32_t yuv2 = r2y[y & 0xffffff];
+    uint32_t yuv1 = lookup_yuv(x, r2y);
+    uint32_t yuv2 = lookup_yuv(y, r2y);
     auto yuv1y = yuv1 & YMASK;
     auto yuv1u = yuv1 & UMASK;
     auto yuv1v = yuv1 & VMASK;
@@ -198,7 +244,7 @@ static uint32_t pixel_diff(uint32_t x, uint32_t y, const uint32_t *r2y)
     }                                                                                               \
 } while (0)
 
-static XBR_INLINE void xbr_filter(const xbr_params *params, int n)
+static XBR_INLINE void xbr_filter(const xbr_params *params, int n, int firstRow, int rowCount)
 {
     int x, y;
     const uint32_t *r2y = params->data->rgbtoyuv;
@@ -206,7 +252,7 @@ static XBR_INLINE void xbr_filter(const xbr_params *params, int n)
     const int nl1 = nl + nl;
     const int nl2 = nl1 + nl;
 
-    for (y = 0; y < params->inHeight; y++) {
+    for (y = firstRow; y < firstRow + rowCount; y++) {
 
         uint32_t *E = (uint32_t *)(params->output + y * params->outPitch * n);
         const uint32_t *sa2 = (uint32_t *)(params->input + y * params->inPitch - 8); /* center */
@@ -301,46 +347,362 @@ static XBR_INLINE void xbr_filter(const xbr_params *params, int n)
 }
 
 void xbr_filter_xbr2x(const xbr_params *ctx) {
-    xbr_filter(ctx, 2);
+    xbr_filter(ctx, 2, 0, ctx->inHeight);
 }
 
 void xbr_filter_xbr3x(const xbr_params *ctx) {
-    xbr_filter(ctx, 3);
+    xbr_filter(ctx, 3, 0, ctx->inHeight);
 }
 
 void xbr_filter_xbr4x(const xbr_params *ctx) {
-    xbr_filter(ctx, 4);
+    xbr_filter(ctx, 4, 0, ctx->inHeight);
 }
 
-static XBR_INLINE int _max(int a, int b)
-{
-	return (a > b) ? a : b;
+void xbr_filter_xbr2x_rows(const xbr_params *ctx, int firstRow, int rowCount) {
+    xbr_filter(ctx, 2, firstRow, rowCount);
+}
+
+void xbr_filter_xbr3x_rows(const xbr_params *ctx, int firstRow, int rowCount) {
+    xbr_filter(ctx, 3, firstRow, rowCount);
+}
+
+void xbr_filter_xbr4x_rows(const xbr_params *ctx, int firstRow, int rowCount) {
+    xbr_filter(ctx, 4, firstRow, rowCount);
 }
 
-static XBR_INLINE int _min(int a, int b)
+#if defined(XBR_AVX2) || defined(XBR_SSE) || defined(XBR_NEON)
+
+/*
+ * Vectorised 4x filter. The colour and YUV key of every input pixel a band reads
+ * are gathered first into planes with the edges clamped as the scalar filter
+ * clamps them, padded so that any lane can read its whole neighbourhood. The
+ * key holds the YUV bytes below the pixel's top byte, so that pixel_diff is a sum
+ * of absolute differences of the bytes. Every test FILT4 makes of the inputs is
+ * then done for a row of pixels at once, for each of the four rotations, and the
+ * blends each calls for are applied a pixel at a time in the same order.
+ */
+
+#if defined(XBR_AVX2)
+#define XBR_LANES 8
+typedef __m256i xbr_vec;
+static XBR_INLINE xbr_vec v_load(const uint32_t *p) { return _mm256_loadu_si256((const __m256i *)p); }
+static XBR_INLINE void v_store(uint32_t *p, xbr_vec a) { _mm256_storeu_si256((__m256i *)p, a); }
+static XBR_INLINE xbr_vec v_set(uint32_t a) { return _mm256_set1_epi32((int)a); }
+static XBR_INLINE xbr_vec v_and(xbr_vec a, xbr_vec b) { return _mm256_and_si256(a, b); }
+static XBR_INLINE xbr_vec v_or(xbr_vec a, xbr_vec b) { return _mm256_or_si256(a, b); }
+static XBR_INLINE xbr_vec v_andnot(xbr_vec a, xbr_vec b) { return _mm256_andnot_si256(a, b); }
+static XBR_INLINE xbr_vec v_add(xbr_vec a, xbr_vec b) { return _mm256_add_epi32(a, b); }
+static XBR_INLINE xbr_vec v_shl1(xbr_vec a) { return _mm256_slli_epi32(a, 1); }
+static XBR_INLINE xbr_vec v_shl2(xbr_vec a) { return _mm256_slli_epi32(a, 2); }
+static XBR_INLINE xbr_vec v_eq(xbr_vec a, xbr_vec b) { return _mm256_cmpeq_epi32(a, b); }
+static XBR_INLINE xbr_vec v_gt(xbr_vec a, xbr_vec b) { return _mm256_cmpgt_epi32(a, b); }
+static XBR_INLINE xbr_vec v_select(xbr_vec mask, xbr_vec a, xbr_vec b) { return _mm256_blendv_epi8(b, a, mask); }
+static XBR_INLINE int v_any(xbr_vec mask) { return _mm256_movemask_epi8(mask) != 0; }
+static XBR_INLINE xbr_vec v_sad(xbr_vec a, xbr_vec b)
+{
+    const __m256i bytes = _mm256_or_si256(_mm256_subs_epu8(a, b), _mm256_subs_epu8(b, a));
+    return _mm256_madd_epi16(_mm256_maddubs_epi16(bytes, _mm256_set1_epi8(1)), _mm256_set1_epi16(1));
+}
+#elif defined(XBR_SSE)
+#define XBR_LANES 4
+typedef __m128i xbr_vec;
+static XBR_INLINE xbr_vec v_load(const uint32_t *p) { return _mm_loadu_si128((const __m128i *)p); }
+static XBR_INLINE void v_store(uint32_t *p, xbr_vec a) { _mm_storeu_si128((__m128i *)p, a); }
+static XBR_INLINE xbr_vec v_set(uint32_t a) { return _mm_set1_epi32((int)a); }
+static XBR_INLINE xbr_vec v_and(xbr_vec a, xbr_vec b) { return _mm_and_si128(a, b); }
+static XBR_INLINE xbr_vec v_or(xbr_vec a, xbr_vec b) { return _mm_or_si128(a, b); }
+static XBR_INLINE xbr_vec v_andnot(xbr_vec a, xbr_vec b) { return _mm_andnot_si128(a, b); }
+static XBR_INLINE xbr_vec v_add(xbr_vec a, xbr_vec b) { return _mm_add_epi32(a, b); }
+static XBR_INLINE xbr_vec v_shl1(xbr_vec a) { return _mm_slli_epi32(a, 1); }
+static XBR_INLINE xbr_vec v_shl2(xbr_vec a) { return _mm_slli_epi32(a, 2); }
+static XBR_INLINE xbr_vec v_eq(xbr_vec a, xbr_vec b) { return _mm_cmpeq_epi32(a, b); }
+static XBR_INLINE xbr_vec v_gt(xbr_vec a, xbr_vec b) { return _mm_cmpgt_epi32(a, b); }
+static XBR_INLINE int v_any(xbr_vec mask) { return _mm_movemask_epi8(mask) != 0; }
+static XBR_INLINE xbr_vec v_select(xbr_vec mask, xbr_vec a, xbr_vec b)
+{
+#if defined(__SSE4_1__)
+    return _mm_blendv_epi8(b, a, mask);
+#else
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+#endif
+}
+static XBR_INLINE xbr_vec v_sad(xbr_vec a, xbr_vec b)
 {
-	return (a < b) ? a : b;
+    const __m128i bytes = _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+    const __m128i pairs = _mm_add_epi16(_mm_and_si128(bytes, _mm_set1_epi16(0x00ff)), _mm_srli_epi16(bytes, 8));
+    return _mm_add_epi32(_mm_and_si128(pairs, _mm_set1_epi32(0xffff)), _mm_srli_epi32(pairs, 16));
+}
+#elif defined(XBR_NEON)
+#define XBR_LANES 4
+typedef uint32x4_t xbr_vec;
+static XBR_INLINE xbr_vec v_load(const uint32_t *p) { return vld1q_u32(p); }
+static XBR_INLINE void v_store(uint32_t *p, xbr_vec a) { vst1q_u32(p, a); }
+static XBR_INLINE xbr_vec v_set(uint32_t a) { return vdupq_n_u32(a); }
+static XBR_INLINE xbr_vec v_and(xbr_vec a, xbr_vec b) { return vandq_u32(a, b); }
+static XBR_INLINE xbr_vec v_or(xbr_vec a, xbr_vec b) { return vorrq_u32(a, b); }
+static XBR_INLINE xbr_vec v_andnot(xbr_vec a, xbr_vec b) { return vbicq_u32(b, a); }
+static XBR_INLINE xbr_vec v_add(xbr_vec a, xbr_vec b) { return vaddq_u32(a, b); }
+static XBR_INLINE xbr_vec v_shl1(xbr_vec a) { return vshlq_n_u32(a, 1); }
+static XBR_INLINE xbr_vec v_shl2(xbr_vec a) { return vshlq_n_u32(a, 2); }
+static XBR_INLINE xbr_vec v_eq(xbr_vec a, xbr_vec b) { return vceqq_u32(a, b); }
+static XBR_INLINE xbr_vec v_gt(xbr_vec a, xbr_vec b) { return vcgtq_u32(a, b); }
+static XBR_INLINE xbr_vec v_select(xbr_vec mask, xbr_vec a, xbr_vec b) { return vbslq_u32(mask, a, b); }
+static XBR_INLINE int v_any(xbr_vec mask) { return vmaxvq_u32(mask) != 0; }
+static XBR_INLINE xbr_vec v_sad(xbr_vec a, xbr_vec b)
+{
+    return vpaddlq_u16(vpaddlq_u8(vabdq_u8(vreinterpretq_u8_u32(a), vreinterpretq_u8_u32(b))));
+}
+#endif
+
+/* The weights compared never come near the sign bit, so signed and unsigned
+ * comparisons agree */
+static XBR_INLINE xbr_vec v_ne(xbr_vec a, xbr_vec b) { return v_andnot(v_eq(a, b), v_set(0xffffffff)); }
+static XBR_INLINE xbr_vec v_le(xbr_vec a, xbr_vec b) { return v_andnot(v_gt(a, b), v_set(0xffffffff)); }
+static XBR_INLINE xbr_vec v_similar(xbr_vec ka, xbr_vec kb) { return v_gt(v_set(155), v_sad(ka, kb)); }
+
+/* Pixels around the one being filtered, colour and key, named as FILT4 names them */
+typedef struct {
+    xbr_vec E, I, H, F, G, C, D, B, H5, F4, I5, I4;
+} xbr_rotation;
+
+#define XBR_ACTIVE 1
+#define XBR_STRONG 2
+#define XBR_LEFT   4
+#define XBR_UP     8
+
+/* What FILT4 decides from its inputs, as flags, and the colour it blends in */
+static XBR_INLINE void xbr_decide(const xbr_rotation *p, const xbr_rotation *k, xbr_vec *flags, xbr_vec *px)
+{
+    const xbr_vec e = v_add(v_add(v_add(v_sad(k->E, k->C), v_sad(k->E, k->G)),
+                                  v_add(v_sad(k->I, k->H5), v_sad(k->I, k->F4))), v_shl2(v_sad(k->H, k->F)));
+    const xbr_vec i = v_add(v_add(v_add(v_sad(k->H, k->D), v_sad(k->H, k->I5)),
+                                  v_add(v_sad(k->F, k->I4), v_sad(k->F, k->B))), v_shl2(v_sad(k->E, k->I)));
+    const xbr_vec active = v_and(v_and(v_ne(p->E, p->H), v_ne(p->E, p->F)), v_le(e, i));
+
+    *px = v_select(v_le(v_sad(k->E, k->F), v_sad(k->E, k->H)), p->F, p->H);
+
+    const xbr_vec sharp = v_and(v_andnot(v_similar(k->F, k->B), v_set(0xffffffff)),
+                                v_andnot(v_similar(k->H, k->D), v_set(0xffffffff)));
+    const xbr_vec thin = v_and(v_similar(k->E, k->I),
+                               v_andnot(v_or(v_similar(k->F, k->I4), v_similar(k->H, k->I5)), v_set(0xffffffff)));
+    const xbr_vec corner = v_or(v_similar(k->E, k->G), v_similar(k->E, k->C));
+    const xbr_vec strong = v_and(v_gt(i, e), v_or(v_or(sharp, thin), corner));
+
+    const xbr_vec ke = v_sad(k->F, k->G);
+    const xbr_vec ki = v_sad(k->H, k->C);
+    const xbr_vec left = v_and(v_le(v_shl1(ke), ki), v_and(v_ne(p->E, p->G), v_ne(p->D, p->G)));
+    const xbr_vec up = v_and(v_le(v_shl1(ki), ke), v_and(v_ne(p->E, p->C), v_ne(p->B, p->C)));
+
+    *flags = v_or(v_or(v_and(active, v_set(XBR_ACTIVE)), v_and(strong, v_set(XBR_STRONG))),
+                  v_or(v_and(left, v_set(XBR_LEFT)), v_and(up, v_set(XBR_UP))));
 }
 
+/* Where FILT4's N15, N14, N11, N3, N7, N10, N13 and N12 fall in the 4x4 block,
+ * as row and column, for each rotation in the order the scalar filter runs them */
+static const unsigned char xbr_block_places[4][8][2] = {
+    { {3, 3}, {3, 2}, {2, 3}, {0, 3}, {1, 3}, {2, 2}, {3, 1}, {3, 0} },
+    { {0, 3}, {1, 3}, {0, 2}, {0, 0}, {0, 1}, {1, 2}, {2, 3}, {3, 3} },
+    { {0, 0}, {0, 1}, {1, 0}, {3, 0}, {2, 0}, {1, 1}, {0, 2}, {0, 3} },
+    { {3, 0}, {2, 0}, {3, 1}, {3, 3}, {3, 2}, {2, 1}, {1, 0}, {0, 0} }
+};
 
-void xbr_init_data(xbr_data *data)
+static XBR_INLINE void xbr_blend(uint32_t *E, int nl, int rotation, uint32_t flags, uint32_t px)
+{
+    const unsigned char (*places)[2] = xbr_block_places[rotation];
+    uint32_t *N15 = E + places[0][0] * nl + places[0][1];
+    uint32_t *N14 = E + places[1][0] * nl + places[1][1];
+    uint32_t *N11 = E + places[2][0] * nl + places[2][1];
+    uint32_t *N3  = E + places[3][0] * nl + places[3][1];
+    uint32_t *N7  = E + places[4][0] * nl + places[4][1];
+    uint32_t *N10 = E + places[5][0] * nl + places[5][1];
+    uint32_t *N13 = E + places[6][0] * nl + places[6][1];
+    uint32_t *N12 = E + places[7][0] * nl + places[7][1];
+
+    if (!(flags & XBR_STRONG)) {
+        *N15 = ALPHA_BLEND_128_W(*N15, px);
+    } else if ((flags & XBR_LEFT) && (flags & XBR_UP)) {
+        *N13 = ALPHA_BLEND_192_W(*N13, px);
+        *N12 = ALPHA_BLEND_64_W( *N12, px);
+        *N15 = *N14 = *N11 = px;
+        *N10 = *N3  = *N12;
+        *N7  = *N13;
+    } else if (flags & XBR_LEFT) {
+        *N11 = ALPHA_BLEND_192_W(*N11, px);
+        *N13 = ALPHA_BLEND_192_W(*N13, px);
+        *N10 = ALPHA_BLEND_64_W( *N10, px);
+        *N12 = ALPHA_BLEND_64_W( *N12, px);
+        *N14 = px;
+        *N15 = px;
+    } else if (flags & XBR_UP) {
+        *N14 = ALPHA_BLEND_192_W(*N14, px);
+        *N7  = ALPHA_BLEND_192_W(*N7 , px);
+        *N10 = ALPHA_BLEND_64_W( *N10, px);
+        *N3  = ALPHA_BLEND_64_W( *N3 , px);
+        *N11 = px;
+        *N15 = px;
+    } else {
+        *N11 = ALPHA_BLEND_128_W(*N11, px);
+        *N14 = ALPHA_BLEND_128_W(*N14, px);
+        *N15 = px;
+    }
+}
+
+static void xbr_filter_simd(const xbr_params *params, int firstRow, int rowCount)
 {
-    uint32_t c;
-    int bg, rg, g;
-
-    for (bg = -255; bg < 256; bg++) {
-        for (rg = -255; rg < 256; rg++) {
-            const uint32_t u = (uint32_t)((-169*rg + 500*bg)/1000) + 128;
-            const uint32_t v = (uint32_t)(( 500*rg -  81*bg)/1000) + 128;
-            int startg = _max(-bg, _max(-rg, 0));
-            int endg = _min(255-bg, _min(255-rg, 255));
-            uint32_t y = (uint32_t)(( 299*rg + 1000*startg + 114*bg)/1000);
-            c = bg + (rg<<16) + 0x010101 * startg;
-            for (g = startg; g <= endg; g++) {
-                data->rgbtoyuv[c] = ((y++) << 16) + (u << 8) + v;
-                c+= 0x010101;
+    const uint32_t *r2y = params->data->rgbtoyuv;
+    const int width = params->inWidth;
+    const int height = params->inHeight;
+    const int nl = params->outPitch >> 2;
+    const int planeWidth = (width + XBR_LANES - 1) / XBR_LANES * XBR_LANES + 4;
+    const int planeRows = rowCount + 4;
+    uint32_t *colours = (uint32_t *)malloc(sizeof(uint32_t) * planeWidth * planeRows * 2);
+    uint32_t *keys = colours + planeWidth * planeRows;
+    int x, y, row, lane, rotation;
+
+    if (colours == NULL) {
+        xbr_filter(params, 4, firstRow, rowCount);
+        return;
+    }
+
+    /* Two rows and columns either side of the band, clamped to the image */
+    for (row = 0; row < planeRows; row++) {
+        int inRow = firstRow + row - 2;
+        const uint32_t *in;
+        inRow = inRow < 0 ? 0 : (inRow >= height ? height - 1 : inRow);
+        in = (const uint32_t *)(params->input + inRow * params->inPitch);
+        for (x = 0; x < planeWidth; x++) {
+            const int inX = x < 2 ? 0 : (x - 2 >= width ? width - 1 : x - 2);
+            const uint32_t c = in[inX];
+            colours[row * planeWidth + x] = c;
+            keys[row * planeWidth + x] = (lookup_yuv(c, r2y) & 0xffffff) | (c & 0xff000000);
+        }
+    }
+
+    for (y = firstRow; y < firstRow + rowCount; y++) {
+        const int centre = (y - firstRow + 2) * planeWidth + 2;
+        uint32_t *out = (uint32_t *)(params->output + y * params->outPitch * 4);
+
+        for (x = 0; x < width; x += XBR_LANES) {
+            const uint32_t *p = colours + centre + x;
+            const uint32_t *k = keys + centre + x;
+            const int lanes = width - x < XBR_LANES ? width - x : XBR_LANES;
+            const int w = planeWidth;
+            const xbr_vec PE = v_load(p);
+            const xbr_vec PH = v_load(p + w);
+            const xbr_vec PF = v_load(p + 1);
+            const xbr_vec PB = v_load(p - w);
+            const xbr_vec PD = v_load(p - 1);
+            uint32_t flags[4][XBR_LANES];
+            uint32_t pxs[4][XBR_LANES];
+            uint32_t centres[XBR_LANES];
+            int any;
+
+            v_store(centres, PE);
+
+            /* Nothing to blend unless the pixel differs from two neighbours at right angles */
+            any = v_any(v_and(v_or(v_ne(PE, PH), v_ne(PE, PB)), v_or(v_ne(PE, PF), v_ne(PE, PD))));
+            if (any) {
+                const xbr_vec PA = v_load(p - w - 1), PC = v_load(p - w + 1);
+                const xbr_vec PG = v_load(p + w - 1), PI = v_load(p + w + 1);
+                const xbr_vec A1 = v_load(p - 2 * w - 1), B1 = v_load(p - 2 * w), C1 = v_load(p - 2 * w + 1);
+                const xbr_vec A0 = v_load(p - w - 2), C4 = v_load(p - w + 2);
+                const xbr_vec D0 = v_load(p - 2), F4 = v_load(p + 2);
+                const xbr_vec G0 = v_load(p + w - 2), I4 = v_load(p + w + 2);
+                const xbr_vec G5 = v_load(p + 2 * w - 1), H5 = v_load(p + 2 * w), I5 = v_load(p + 2 * w + 1);
+                const xbr_vec KE = v_load(k), KH = v_load(k + w), KF = v_load(k + 1);
+                const xbr_vec KB = v_load(k - w), KD = v_load(k - 1);
+                const xbr_vec KA = v_load(k - w - 1), KC = v_load(k - w + 1);
+                const xbr_vec KG = v_load(k + w - 1), KI = v_load(k + w + 1);
+                const xbr_vec KA1 = v_load(k - 2 * w - 1), KB1 = v_load(k - 2 * w), KC1 = v_load(k - 2 * w + 1);
+                const xbr_vec KA0 = v_load(k - w - 2), KC4 = v_load(k - w + 2);
+                const xbr_vec KD0 = v_load(k - 2), KF4 = v_load(k + 2);
+                const xbr_vec KG0 = v_load(k + w - 2), KI4 = v_load(k + w + 2);
+                const xbr_vec KG5 = v_load(k + 2 * w - 1), KH5 = v_load(k + 2 * w), KI5 = v_load(k + 2 * w + 1);
+
+                /* The neighbourhood as each of the scalar filter's FILT4 calls names it */
+                const xbr_rotation colourRotations[4] = {
+                    { PE, PI, PH, PF, PG, PC, PD, PB, H5, F4, I5, I4 },
+                    { PE, PC, PF, PB, PI, PA, PH, PD, F4, B1, C4, C1 },
+                    { PE, PA, PB, PD, PC, PG, PF, PH, B1, D0, A1, A0 },
+                    { PE, PG, PD, PH, PA, PI, PB, PF, D0, H5, G0, G5 }
+                };
+                const xbr_rotation keyRotations[4] = {
+                    { KE, KI, KH, KF, KG, KC, KD, KB, KH5, KF4, KI5, KI4 },
+                    { KE, KC, KF, KB, KI, KA, KH, KD, KF4, KB1, KC4, KC1 },
+                    { KE, KA, KB, KD, KC, KG, KF, KH, KB1, KD0, KA1, KA0 },
+                    { KE, KG, KD, KH, KA, KI, KB, KF, KD0, KH5, KG0, KG5 }
+                };
+                for (rotation = 0; rotation < 4; rotation++) {
+                    xbr_vec rotationFlags, px;
+                    xbr_decide(&colourRotations[rotation], &keyRotations[rotation], &rotationFlags, &px);
+                    v_store(flags[rotation], rotationFlags);
+                    v_store(pxs[rotation], px);
+                }
+            }
+
+            for (lane = 0; lane < lanes; lane++) {
+                uint32_t *E = out + (x + lane) * 4;
+                const uint32_t PEvalue = centres[lane];
+                for (row = 0; row < 4; row++) {
+                    E[row * nl] = E[row * nl + 1] = E[row * nl + 2] = E[row * nl + 3] = PEvalue;
+                }
+                if (any) {
+                    for (rotation = 0; rotation < 4; rotation++) {
+                        if (flags[rotation][lane] & XBR_ACTIVE) {
+                            xbr_blend(E, nl, rotation, flags[rotation][lane], pxs[rotation][lane]);
+                        }
+                    }
+                }
             }
         }
     }
+
+    free(colours);
+}
+
+void xbr_filter_xbr4x_simd(const xbr_params *ctx) {
+    xbr_filter_simd(ctx, 0, ctx->inHeight);
+}
+
+void xbr_filter_xbr4x_simd_rows(const xbr_params *ctx, int firstRow, int rowCount) {
+    xbr_filter_simd(ctx, firstRow, rowCount);
+}
+
+const char *xbr_simd_name(void) {
+#if defined(XBR_AVX2)
+    return "AVX2";
+#elif defined(XBR_SSE) && defined(__SSE4_1__)
+    return "SSE4.1";
+#elif defined(XBR_SSE)
+    return "SSE2";
+#else
+    return "NEON";
+#endif
+}
+
+#else
+
+void xbr_filter_xbr4x_simd(const xbr_params *ctx) {
+    xbr_filter(ctx, 4, 0, ctx->inHeight);
+}
+
+void xbr_filter_xbr4x_simd_rows(const xbr_params *ctx, int firstRow, int rowCount) {
+    xbr_filter(ctx, 4, firstRow, rowCount);
+}
+
+const char *xbr_simd_name(void) {
+    return "scalar";
+}
+
+#endif
+
+void xbr_init_data(xbr_data *data)
+{
+    uint32_t i;
+
+    for (i = 0; i < (1<<15); i++) {
+        const uint32_t c = ((i & 0x001f) << 3) | ((i & 0x03e0) << 6) | ((i & 0x7c00) << 9);
+        data->rgbtoyuv[i] = rgb_to_yuv(c);
+    }
 }
 
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "../SharedLib/gbc/gbc.h"
+
+// The parts of the core that the benchmarks drive directly, without the run loop around them. Gbc names this class as
+// a friend.
+class GbcBenchAccess {
+public:
+    // Runs the instruction at PC, returning the clocks it took, with none of the timers, video or interrupts stepped
+    static inline int performOp(Gbc& gbc) { return gbc.performOp(); }
+
+    // Writes a byte through the memory map as the CPU would, IO registers included
+    static inline void write8(Gbc& gbc, unsigned int address, uint8_t byte) { gbc.write8(address, byte); }
+
+    // Draws line LY into an RGBA frame as the registers and VRAM stand, leaving the colour numbers the background and
+    // window drew across it
+    static inline void readLineGb(Gbc& gbc, Frame& frame) { gbc.readLineGb<false>(frame); }
+    static inline void readLineCgb(Gbc& gbc, Frame& frame) { gbc.readLineCgb<false>(frame); }
+    static inline const uint8_t* getBgColorNumbers(const Gbc& gbc) { return gbc.bgColorNumbers; }
+};
@@ -0,0 +1,117 @@
+#include "runnerappplatform.h"
+
+#include "../SharedLib/gbc/gbc.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Runs a ROM in two instances side by side, one drawing frames in RGBA and the other as palette indices converted to
+// RGBA as they're scaled, and checks that every frame comes out the same in both before upscaling. Each frame is
+// asked for in full, so none are elided and left unconverted. Reports how long each took to run and scale a frame,
+// and exits with 1 if any frame differs.
+//
+// Usage: ShiningEmulatorIndexedBench <ROM file> [frames]
+
+struct Instance {
+    RunnerAppPlatform platform;
+    Gbc gbc;
+    std::vector<uint32_t> frame;
+    bool frameShown = false;
+    double seconds = 0.0;
+
+    explicit Instance(const std::string& appDir) : platform(appDir), frame(BASE_FRAME_W * BASE_FRAME_H) {}
+};
+
+// Runs the instance for a frame and keeps a copy of the frame it finished, if it finished one
+static void runFrame(Instance& instance) {
+    FrameManager& frameManager = instance.gbc.frameManager;
+    const auto startTime = std::chrono::steady_clock::now();
+    frameManager.requestFullFrame();
+    (void)instance.gbc.runFrame();
+    frameManager.waitForScaling();
+    instance.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    instance.frameShown = false;
+    uint32_t* frameBuffer;
+    while ((frameBuffer = frameManager.getRenderableFrameBuffer()) != nullptr) {
+        const uint32_t* sourceFrame = frameManager.getSourceFrameBuffer(frameBuffer);
+        memcpy(instance.frame.data(), sourceFrame, instance.frame.size() * sizeof(uint32_t));
+        instance.frameShown = true;
+        (void)frameManager.freeFrame(frameBuffer);
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <ROM file> [frames]" << std::endl;
+        return 1;
+    }
+    const std::string romFileName = argv[1];
+    const unsigned int frames = argc > 2 ? (unsigned int)std::max(std::stoi(argv[2]), 1) : 3600;
+
+    const RomImage romImage = RomImage::mapFile(romFileName);
+    if (romImage.empty()) {
+        std::cerr << "Could not open " << romFileName << std::endl;
+        return 1;
+    }
+
+    // Neither is scaled up, so that only the conversion from indices is added to drawing a frame
+    const auto appDir = std::filesystem::temp_directory_path() / "ShiningEmulatorIndexedBench";
+    const std::pair<bool, const char*> formats[] = {
+        { false, "RGBA" },
+        { true, "Indexed" }
+    };
+    std::unique_ptr<Instance> instances[2];
+    for (unsigned int index = 0; index < 2; index++) {
+        instances[index] = std::make_unique<Instance>((appDir / std::to_string(index)).string());
+        Gbc& gbc = instances[index]->gbc;
+        gbc.frameManager.setScaler(ScalerType::PASSTHROUGH);
+        gbc.loadRom(romFileName, romImage, instances[index]->platform);
+        gbc.reset();
+        gbc.setIndexedOutput(formats[index].first);
+    }
+
+    Instance& rgba = *instances[0];
+    Instance& indexed = *instances[1];
+    unsigned int framesCompared = 0;
+    for (unsigned int frameNo = 0; frameNo < frames; frameNo++) {
+        runFrame(rgba);
+        runFrame(indexed);
+        if (!rgba.gbc.isRunning || !indexed.gbc.isRunning) {
+            std::cerr << "The ROM could not be run" << std::endl;
+            return 1;
+        }
+        if (rgba.frameShown != indexed.frameShown) {
+            std::cerr << "Frame " << frameNo << " was only finished in " << (rgba.frameShown ? "RGBA" : "indexed")
+                      << std::endl;
+            return 1;
+        }
+        if (!rgba.frameShown) {
+            continue;
+        }
+        const auto difference = std::mismatch(rgba.frame.begin(), rgba.frame.end(), indexed.frame.begin());
+        if (difference.first != rgba.frame.end()) {
+            const size_t pixel = difference.first - rgba.frame.begin();
+            std::cerr << "Frame " << frameNo << " differs first at x " << pixel % BASE_FRAME_W << ", y "
+                      << pixel / BASE_FRAME_W << ": RGBA " << std::hex << std::setw(8) << std::setfill('0')
+                      << *difference.first << ", indexed " << std::setw(8) << *difference.second << std::endl;
+            return 1;
+        }
+        framesCompared++;
+    }
+
+    std::cout << framesCompared << " of " << frames << " frames finished, all the same in both formats" << std::endl;
+    std::cout << "Format   ms/frame" << std::endl;
+    for (unsigned int index = 0; index < 2; index++) {
+        std::cout << std::left << std::setw(8) << formats[index].second << std::right << std::fixed
+                  << std::setprecision(3) << std::setw(9) << instances[index]->seconds * 1000.0 / frames << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,175 @@
+#include "runnerappplatform.h"
+#include "gbcbenchaccess.h"
+
+#include "../SharedLib/gbc/gbc.h"
+#include "../SharedLib/gbc/linekernels.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Draws every line of frames of random tiles, window and sprites through readLineGb and readLineCgb with each line
+// kernel this build has, first checking that every kernel draws the same lines and colour numbers as the scalar one
+// byte for byte, then timing each. Exits with 1 if any kernel differs. Only RGBA lines are drawn, as indexed ones are
+// drawn the same way whichever kernel is chosen; ShiningEmulatorIndexedBench checks those against RGBA instead.
+//
+// Usage: ShiningEmulatorLineBench [frames timed]
+
+// Frames of each kernel's output kept and checked against the scalar kernel's; the scroll and window position change
+// every frame, so each tile is met starting and ending part way through it
+constexpr unsigned int CHECKED_FRAMES = 64;
+constexpr unsigned int LINE_BYTES = 160 * sizeof(uint32_t) + 160;
+
+enum class Model {
+    DMG,
+    CGB
+};
+
+static std::vector<uint8_t> makeRom(Model model) {
+    std::vector<uint8_t> rom(0x8000, 0x00);
+    rom[0x100] = 0x18; // jr -2
+    rom[0x101] = 0xfe;
+    rom[0x143] = model == Model::CGB ? 0x80 : 0x00;
+    return rom;
+}
+
+// Loads the ROM and fills VRAM, OAM and the palettes from a fixed seed while the LCD is off, then turns the background,
+// window and 8x16 sprites on without going through the LCD control register, so no frame is begun
+static std::unique_ptr<Gbc> makeFixture(Model model, RunnerAppPlatform& platform) {
+    auto gbc = std::make_unique<Gbc>();
+    const std::vector<uint8_t> rom = makeRom(model);
+    if (!gbc->loadRom("linebench.gb", rom.data(), (int)rom.size(), platform)) {
+        return nullptr;
+    }
+    gbc->reset();
+
+    std::mt19937 random(5);
+    GbcBenchAccess::write8(*gbc, 0xff40, 0x00);
+    for (unsigned int bank = 0; bank < (model == Model::CGB ? 2U : 1U); bank++) {
+        GbcBenchAccess::write8(*gbc, 0xff4f, (uint8_t)bank);
+        for (unsigned int address = 0x8000; address < 0xa000; address++) {
+            GbcBenchAccess::write8(*gbc, address, (uint8_t)random());
+        }
+    }
+    GbcBenchAccess::write8(*gbc, 0xff4f, 0);
+    for (unsigned int sprite = 0; sprite < 40; sprite++) {
+        gbc->oam[sprite * 4] = (uint8_t)(16 + random() % 144);
+        gbc->oam[sprite * 4 + 1] = (uint8_t)(8 + random() % 160);
+        gbc->oam[sprite * 4 + 2] = (uint8_t)random();
+        gbc->oam[sprite * 4 + 3] = (uint8_t)random();
+    }
+    GbcBenchAccess::write8(*gbc, 0xff47, 0xe4);
+    GbcBenchAccess::write8(*gbc, 0xff48, 0xd2);
+    GbcBenchAccess::write8(*gbc, 0xff49, 0x1b);
+    if (model == Model::CGB) {
+        GbcBenchAccess::write8(*gbc, 0xff68, 0x80);
+        GbcBenchAccess::write8(*gbc, 0xff6a, 0x80);
+        for (unsigned int byte = 0; byte < 64; byte++) {
+            GbcBenchAccess::write8(*gbc, 0xff69, (uint8_t)random());
+            GbcBenchAccess::write8(*gbc, 0xff6b, (uint8_t)random());
+        }
+    }
+    gbc->ioPorts[0x40] = 0xf7;
+    gbc->ioPorts[0x4a] = 0x40;
+    return gbc;
+}
+
+// Draws the given number of frames, changing the scroll and window position each frame, and appends each line and its
+// colour numbers to lines if it isn't null
+static void drawFrames(Gbc& gbc, Model model, Frame& frame, unsigned int frames, std::vector<uint8_t>* lines) {
+    for (unsigned int frameNo = 0; frameNo < frames; frameNo++) {
+        gbc.ioPorts[0x42] = (uint8_t)(frameNo * 3);
+        gbc.ioPorts[0x43] = (uint8_t)frameNo;
+        gbc.ioPorts[0x4b] = (uint8_t)(frameNo * 13 % 167);
+        uint32_t* buffer = frame.getForDrawing(PixelFormat::RGBA);
+        for (unsigned int lineNo = 0; lineNo < 144; lineNo++) {
+            gbc.ioPorts[0x44] = (uint8_t)lineNo;
+            if (model == Model::CGB) {
+                GbcBenchAccess::readLineCgb(gbc, frame);
+            } else {
+                GbcBenchAccess::readLineGb(gbc, frame);
+            }
+            if (lines != nullptr) {
+                const auto* line = reinterpret_cast<const uint8_t*>(&buffer[160 * lineNo]);
+                const uint8_t* numbers = GbcBenchAccess::getBgColorNumbers(gbc);
+                lines->insert(lines->end(), line, line + 160 * sizeof(uint32_t));
+                lines->insert(lines->end(), numbers, numbers + 160);
+            }
+        }
+        (void)frame.markForScaling();
+        (void)frame.markForRendering();
+        (void)frame.markAvailable();
+    }
+}
+
+int main(int argc, char** argv) {
+    const unsigned int frames = argc > 1 ? (unsigned int)std::max(std::stoi(argv[1]), 1) : 2000;
+
+    auto appDir = std::filesystem::temp_directory_path() / "ShiningEmulatorLineBench";
+    RunnerAppPlatform platform(appDir.string());
+
+    const LineKernels::Kernel allKernels[] = {
+        LineKernels::Kernel::SCALAR,
+        LineKernels::Kernel::SSE2,
+        LineKernels::Kernel::SSSE3,
+        LineKernels::Kernel::AVX2,
+        LineKernels::Kernel::NEON
+    };
+    std::vector<LineKernels::Kernel> kernels;
+    std::copy_if(std::begin(allKernels), std::end(allKernels), std::back_inserter(kernels), LineKernels::isAvailable);
+    const LineKernels::Kernel defaultKernel = LineKernels::getKernel();
+
+    const std::pair<Model, const char*> models[] = {
+        { Model::DMG, "readLineGb" },
+        { Model::CGB, "readLineCgb" }
+    };
+    bool allMatched = true;
+    std::cout << "Function     Kernel   ns/line  Matches scalar" << std::endl;
+    for (auto& [model, name] : models) {
+        auto gbc = makeFixture(model, platform);
+        if (!gbc) {
+            std::cerr << "The test ROM could not be loaded" << std::endl;
+            return 1;
+        }
+        Frame frame;
+        std::vector<uint8_t> scalarLines;
+        for (LineKernels::Kernel kernel : kernels) {
+            (void)LineKernels::setKernel(kernel);
+
+            std::vector<uint8_t> lines;
+            lines.reserve((size_t)CHECKED_FRAMES * 144 * LINE_BYTES);
+            drawFrames(*gbc, model, frame, CHECKED_FRAMES, &lines);
+            if (kernel == LineKernels::Kernel::SCALAR) {
+                scalarLines = std::move(lines);
+            }
+            const bool matched = kernel == LineKernels::Kernel::SCALAR || lines == scalarLines;
+            if (!matched) {
+                const size_t at = std::mismatch(lines.begin(), lines.end(), scalarLines.begin()).first - lines.begin();
+                std::cerr << name << " with " << LineKernels::getKernelName(kernel)
+                          << " first differs from scalar at frame " << at / (144 * LINE_BYTES)
+                          << ", line " << at / LINE_BYTES % 144 << ", "
+                          << (at % LINE_BYTES < 160 * sizeof(uint32_t) ? "pixel byte " : "colour number ")
+                          << at % LINE_BYTES % (160 * sizeof(uint32_t)) << std::endl;
+                allMatched = false;
+            }
+
+            const auto startTime = std::chrono::steady_clock::now();
+            drawFrames(*gbc, model, frame, frames, nullptr);
+            const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime);
+            const double nanosPerLine = elapsed.count() / frames / 144;
+            std::cout << std::left << std::setw(13) << name << std::setw(7) << LineKernels::getKernelName(kernel)
+                      << std::right << std::fixed << std::setprecision(1) << std::setw(9) << nanosPerLine
+                      << "  " << (matched ? "yes" : "NO") << std::endl;
+        }
+    }
+    (void)LineKernels::setKernel(defaultKernel);
+    return allMatched ? 0 : 1;
+}
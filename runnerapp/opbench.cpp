@@ -0,0 +1,125 @@
+#include "runnerappplatform.h"
+#include "gbcbenchaccess.h"
+
+#include "../SharedLib/gbc/gbc.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Measures how many instructions a second the core runs on a loop heavy in register pair operations - 16-bit loads,
+// increments, decrements, add HL and loads through HL and DE - first calling Gbc::performOp directly, then through the
+// run loop with its timers and video, and then the run loop in CGB double speed mode. Each is run the given number of
+// times, keeping the best.
+//
+// Usage: ShiningEmulatorOpBench [repetitions] [millions of instructions per run]
+
+// Entry points into the test program: the loop itself, or a switch to double speed before it
+constexpr uint32_t LOOP_ENTRY = 0x160;
+constexpr uint32_t DOUBLE_SPEED_ENTRY = 0x150;
+
+static std::vector<uint8_t> makeRom() {
+    std::vector<uint8_t> rom(0x10000, 0x00);
+    const uint8_t header[] = {
+        0x00, 0xc3, 0x60, 0x01                          // nop; jp LOOP_ENTRY
+    };
+    const uint8_t speedSwitch[] = {
+        0x3e, 0x01, 0xe0, 0x4d,                         // ld a, 1; ldh (KEY1), a
+        0x10, 0x00,                                     // stop
+        0xc3, 0x60, 0x01                                // jp LOOP_ENTRY
+    };
+    const uint8_t loop[] = {
+        0x21, 0x00, 0xc0,                               // ld hl, 0xc000
+        0x11, 0x00, 0xc8,                               // ld de, 0xc800
+        0x01, 0x01, 0x00,                               // ld bc, 1
+        0x2a, 0x12, 0x13, 0x09, 0x03, 0x0b, 0x1b, 0x23, // ld a, (hl+); ld (de), a; inc de; add hl, bc; inc bc; dec bc;
+        0x2b, 0x7c, 0xfe, 0xd0, 0x20, 0xf2,             // dec de; inc hl; dec hl; ld a, h; cp 0xd0; jr nz, -14
+        0xc3, 0x60, 0x01                                // jp LOOP_ENTRY
+    };
+    std::copy(std::begin(header), std::end(header), rom.begin() + 0x100);
+    std::copy(std::begin(speedSwitch), std::end(speedSwitch), rom.begin() + DOUBLE_SPEED_ENTRY);
+    std::copy(std::begin(loop), std::end(loop), rom.begin() + LOOP_ENTRY);
+    rom[0x143] = 0x80; // CGB
+    rom[0x147] = 0x01; // MBC1
+    rom[0x148] = 0x01; // 64 KB
+    return rom;
+}
+
+enum class Mode {
+    PERFORM_OP,
+    RUN_LOOP,
+    RUN_LOOP_DOUBLE_SPEED
+};
+
+// Runs one repetition, returning the instructions run per second, or zero if the program couldn't be run
+static double runOnce(const std::vector<uint8_t>& rom, RunnerAppPlatform& platform, Mode mode, uint64_t instructions) {
+    auto gbc = std::make_unique<Gbc>();
+    if (!gbc->loadRom("opbench.gbc", rom.data(), (int)rom.size(), platform)) {
+        return 0.0;
+    }
+    gbc->reset();
+    if (mode == Mode::RUN_LOOP_DOUBLE_SPEED) {
+        gbc->cpuPc = DOUBLE_SPEED_ENTRY;
+        while (gbc->cpuPc < LOOP_ENTRY && gbc->isRunning) {
+            (void)gbc->runCycles(4);
+        }
+        if ((gbc->ioPorts[0x4d] & 0x80U) == 0) {
+            return 0.0;
+        }
+    } else {
+        gbc->cpuPc = LOOP_ENTRY;
+    }
+
+    const uint64_t instructionsAtStart = gbc->executedInstructions;
+    const auto startTime = std::chrono::steady_clock::now();
+    if (mode == Mode::PERFORM_OP) {
+        for (uint64_t instruction = 0; instruction < instructions; instruction++) {
+            (void)GbcBenchAccess::performOp(*gbc);
+        }
+    } else {
+        while (gbc->executedInstructions - instructionsAtStart < instructions && gbc->isRunning) {
+            (void)gbc->runCycles(1000000);
+        }
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    if (!gbc->isRunning) {
+        return 0.0;
+    }
+    const uint64_t ran = mode == Mode::PERFORM_OP ? instructions : gbc->executedInstructions - instructionsAtStart;
+    return (double)ran / elapsed;
+}
+
+int main(int argc, char** argv) {
+    const int repetitions = argc > 1 ? std::max(std::stoi(argv[1]), 1) : 5;
+    const uint64_t instructions = (uint64_t)(argc > 2 ? std::max(std::stod(argv[2]), 0.001) : 30.0) * 1000000;
+
+    auto appDir = std::filesystem::temp_directory_path() / "ShiningEmulatorOpBench";
+    RunnerAppPlatform platform(appDir.string());
+    const std::vector<uint8_t> rom = makeRom();
+
+    const std::pair<Mode, const char*> modes[] = {
+        { Mode::PERFORM_OP, "performOp" },
+        { Mode::RUN_LOOP, "Run loop" },
+        { Mode::RUN_LOOP_DOUBLE_SPEED, "Run loop, double speed" }
+    };
+    std::cout << "Mode                     Minstr/s" << std::endl;
+    for (auto& [mode, name] : modes) {
+        double best = 0.0;
+        for (int repetition = 0; repetition < repetitions; repetition++) {
+            const double rate = runOnce(rom, platform, mode, instructions);
+            if (rate == 0.0) {
+                std::cerr << "The test program could not be run" << std::endl;
+                return 1;
+            }
+            best = std::max(best, rate);
+        }
+        std::cout << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(11) << best / 1e6 << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include "runnerappplatform.h"
+
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <utility>
+
+RunnerAppPlatform::RunnerAppPlatform(std::string appDir) : appDir(std::move(appDir)) {
+    std::filesystem::create_directories(this->appDir);
+    releaseAllInputs();
+}
+
+std::string RunnerAppPlatform::getAppDir() {
+    return appDir;
+}
+
+char RunnerAppPlatform::getSeparator() {
+    return (char)std::filesystem::path::preferred_separator;
+}
+
+bool RunnerAppPlatform::onAppThreadStarted(Thread* app) {
+    return true;
+}
+
+PlatformRenderer* RunnerAppPlatform::newPlatformRenderer() {
+    return nullptr;
+}
+
+AudioStreamer* RunnerAppPlatform::newAudioStreamer(Gbc* gbc) {
+    return nullptr;
+}
+
+Resource* RunnerAppPlatform::getResource(const char* fileName, bool isAsset, bool isGlShader) {
+    return nullptr;
+}
+
+Resource* RunnerAppPlatform::chooseFile(std::string fileTypeDescr, std::vector<std::string> fileTypes) {
+    return nullptr;
+}
+
+void RunnerAppPlatform::openDebugWindow(Gbc* gbc) {}
+
+void RunnerAppPlatform::withCurrentTime(std::function<void(struct tm*)> func) {
+    time_t timestamp = time(nullptr);
+    struct tm localTime{};
+#ifdef _WIN32
+    localtime_s(&localTime, &timestamp);
+#else
+    localtime_r(&timestamp, &localTime);
+#endif
+    func(&localTime);
+}
+
+void RunnerAppPlatform::pollGamepad() {}
+
+uint64_t RunnerAppPlatform::getUptimeMillis() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
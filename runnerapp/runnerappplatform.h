@@ -0,0 +1,27 @@
+#pragma once
+
+#include "../SharedLib/appplatform.h"
+
+#include <string>
+
+// Platform for an emulator instance running with no window, renderer or sound. Each instance is given a directory of
+// its own so that instances running the same ROM don't share a save file.
+class RunnerAppPlatform : public AppPlatform {
+    std::string appDir;
+
+protected:
+    std::string getAppDir() override;
+    char getSeparator() override;
+
+public:
+    explicit RunnerAppPlatform(std::string appDir);
+    bool onAppThreadStarted(Thread* app) override;
+    PlatformRenderer* newPlatformRenderer() override;
+    AudioStreamer* newAudioStreamer(Gbc* gbc) override;
+    Resource* getResource(const char* fileName, bool isAsset, bool isGlShader) override;
+    Resource* chooseFile(std::string fileTypeDescr, std::vector<std::string> fileTypes) override;
+    void openDebugWindow(Gbc* gbc) override;
+    void withCurrentTime(std::function<void(struct tm*)> func) override;
+    void pollGamepad() override;
+    uint64_t getUptimeMillis() override;
+};
@@ -0,0 +1,311 @@
+#include "runnerappplatform.h"
+
+#include "../SharedLib/gbc/gbc.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Runs a ROM in several independent emulator instances at once, as fast as they will go, and reports how many frames
+// per second they manage between them, how long frames took to scale and how many were finished and how many of those
+// were elided as unchanged, as the number of instances is doubled up to the given maximum (by default, one per core).
+// Instances are shared out between worker threads, one per core at most, each pinned to a core of its own. Frames are
+// scaled with the given scaler, by default the one the emulator starts with.
+//
+// Usage: ShiningEmulatorRunner [options] <ROM file> [maximum instances] [seconds per step] [scaler]
+//
+// Options, which apply to every instance:
+//   --block-cache      Run instructions from the cache of decoded blocks, reporting its hits and misses
+//   --recompiler       Run hot blocks as native code, reporting how many were compiled and run
+//   --differential     As --recompiler, checking every native block against the interpreter in lockstep and exiting
+//                      with 1 if any disagreed
+//   --no-idle-skip     Run idle polling loops in full rather than skipping them; otherwise each instance's idle loop
+//                      statistics are reported
+//   --indexed          Draw DMG and CGB frames as palette indices, converting them to RGBA as they're scaled
+//   --frameskip <n|auto>
+//                      Leave n frames undrawn after each one drawn, or skip them automatically while the one before
+//                      is still being scaled
+
+static const char* USAGE_ARGUMENTS = "[options] <ROM file> [maximum instances] [seconds per step] [scaler]";
+
+// How every instance is set up
+struct RunnerOptions {
+    ScalerType scalerType = DEFAULT_SCALER;
+    bool blockCache = false;
+    bool recompiler = false;
+    bool differential = false;
+    bool idleSkip = true;
+    bool indexed = false;
+    int frameSkip = 0;
+};
+
+struct Instance {
+    RunnerAppPlatform platform;
+    Gbc gbc;
+    uint64_t frames = 0;
+
+    explicit Instance(const std::string& appDir) : platform(appDir) {}
+};
+
+static void pinCurrentThread(unsigned int core) {
+#ifdef _WIN32
+    SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << core);
+#elif defined(__linux__)
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(core, &cpus);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+#endif
+}
+
+// What each instance's counters came to by the end of a step
+struct InstanceCounters {
+    uint64_t cacheHits;
+    uint64_t cacheMisses;
+    uint64_t blocksCompiled;
+    uint64_t nativeBlocksRun;
+    uint64_t differentialMismatches;
+    uint64_t idleLoopsDetected;
+    uint64_t idleSkips;
+    uint64_t idleSkippedCycles;
+};
+
+struct StepResult {
+    double framesPerSecond;
+    double scaleLatencyMillis;
+    uint64_t framesFinished;
+    uint64_t framesElided;
+    std::vector<InstanceCounters> counters;
+};
+
+// Runs one step of the benchmark, returning the frames emulated per second across all instances, the average time
+// from a frame being finished to it being scaled, the frames finished and elided across all instances and each
+// instance's counters
+static StepResult runInstances(const std::string& romFileName, const RomImage& romImage, unsigned int instanceCount,
+                               unsigned int workerCount, double seconds, const RunnerOptions& options) {
+    std::vector<std::unique_ptr<Instance>> instances(instanceCount);
+    std::atomic<unsigned int> workersReady{ 0 };
+    std::atomic<bool> started{ false };
+    std::atomic<bool> stopping{ false };
+
+    auto worker = [&](unsigned int workerIndex) {
+        // Instances are created by the thread that runs them, once pinned, so that their memory is local to its core
+        pinCurrentThread(workerIndex);
+        for (unsigned int index = workerIndex; index < instanceCount; index += workerCount) {
+            auto appDir = std::filesystem::temp_directory_path() / "ShiningEmulatorRunner" / std::to_string(index);
+            instances[index] = std::make_unique<Instance>(appDir.string());
+            Gbc& gbc = instances[index]->gbc;
+            gbc.frameManager.setScaler(options.scalerType);
+            gbc.loadRom(romFileName, romImage, instances[index]->platform);
+            gbc.reset();
+            gbc.blockCache.setEnabled(options.blockCache);
+            gbc.recompiler.setEnabled(options.recompiler);
+            gbc.recompiler.setDifferentialMode(options.differential);
+            gbc.idleLoops.setEnabled(options.idleSkip);
+            gbc.setIndexedOutput(options.indexed);
+            gbc.frameManager.setFrameSkip(options.frameSkip);
+        }
+        workersReady++;
+        while (!started) {
+            std::this_thread::yield();
+        }
+
+        // Each instance is run a frame at a time, with the frame before freed once it's scaled as if there were a
+        // renderer keeping up with them. That frame is scaled while the worker runs its other instances.
+        while (!stopping) {
+            for (unsigned int index = workerIndex; index < instanceCount; index += workerCount) {
+                Instance& instance = *instances[index];
+                instance.gbc.frameManager.waitForScaling();
+                uint32_t* frameBuffer;
+                while ((frameBuffer = instance.gbc.frameManager.getRenderableFrameBuffer()) != nullptr) {
+                    (void)instance.gbc.frameManager.freeFrame(frameBuffer);
+                }
+                (void)instance.gbc.runFrame();
+                instance.frames++;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned int workerIndex = 0; workerIndex < workerCount; workerIndex++) {
+        workers.emplace_back(worker, workerIndex);
+    }
+    while (workersReady < workerCount) {
+        std::this_thread::yield();
+    }
+
+    const auto startTime = std::chrono::steady_clock::now();
+    started = true;
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stopping = true;
+    for (auto& thread : workers) {
+        thread.join();
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    uint64_t totalFrames = 0;
+    uint64_t totalLatencyMicros = 0;
+    uint64_t framesFinished = 0;
+    uint64_t framesElided = 0;
+    std::vector<InstanceCounters> counters;
+    for (auto& instance : instances) {
+        const Gbc& gbc = instance->gbc;
+        if (!gbc.isRunning) {
+            return { 0.0, 0.0, 0, 0, {} };
+        }
+        totalFrames += instance->frames;
+        totalLatencyMicros += gbc.frameManager.getAverageScaleLatencyMicros();
+        framesFinished += gbc.frameManager.getFinishedFrameCount();
+        framesElided += gbc.frameManager.getElidedFrameCount();
+        counters.push_back({ gbc.blockCache.totalHits, gbc.blockCache.totalMisses, gbc.recompiler.blocksCompiled,
+                             gbc.recompiler.nativeBlocksRun, gbc.recompiler.differentialMismatches,
+                             gbc.idleLoops.loopsDetected, gbc.idleLoops.skips, gbc.idleLoops.skippedCycles });
+    }
+    return { (double)totalFrames / elapsed, (double)totalLatencyMicros / instanceCount / 1000.0, framesFinished,
+             framesElided, std::move(counters) };
+}
+
+// Totals of the counters for the features turned on, below the step's line of the table, followed by those kept for
+// each instance's ROM; returns the differential mismatches between them
+static uint64_t printCounters(const std::vector<InstanceCounters>& counters, const RunnerOptions& options) {
+    InstanceCounters total{};
+    for (const InstanceCounters& instance : counters) {
+        total.cacheHits += instance.cacheHits;
+        total.cacheMisses += instance.cacheMisses;
+        total.blocksCompiled += instance.blocksCompiled;
+        total.nativeBlocksRun += instance.nativeBlocksRun;
+        total.differentialMismatches += instance.differentialMismatches;
+    }
+    if (options.blockCache) {
+        const uint64_t lookups = total.cacheHits + total.cacheMisses;
+        std::cout << "    Block cache: " << total.cacheHits << " hits, " << total.cacheMisses << " misses ("
+                  << std::setprecision(2) << (lookups > 0 ? 100.0 * (double)total.cacheHits / (double)lookups : 0.0)
+                  << "% hits)" << std::endl;
+    }
+    if (options.recompiler) {
+        std::cout << "    Recompiler: " << total.blocksCompiled << " blocks compiled, " << total.nativeBlocksRun
+                  << " native blocks run";
+        if (options.differential) {
+            std::cout << ", " << total.differentialMismatches << " differential mismatches";
+        }
+        std::cout << std::endl;
+    }
+    if (options.idleSkip) {
+        for (size_t index = 0; index < counters.size(); index++) {
+            const InstanceCounters& instance = counters[index];
+            std::cout << "    Instance " << index << " idle loops: " << instance.idleLoopsDetected << " detected, "
+                      << instance.idleSkips << " skips, " << instance.idleSkippedCycles << " cycles skipped"
+                      << std::endl;
+        }
+    }
+    return total.differentialMismatches;
+}
+
+int main(int argc, char** argv) {
+    // Options can come anywhere; everything else is positional
+    RunnerOptions options;
+    std::vector<std::string> arguments;
+    for (int index = 1; index < argc; index++) {
+        const std::string argument = argv[index];
+        if (argument == "--block-cache") {
+            options.blockCache = true;
+        } else if (argument == "--recompiler") {
+            options.recompiler = true;
+        } else if (argument == "--differential") {
+            options.recompiler = true;
+            options.differential = true;
+        } else if (argument == "--no-idle-skip") {
+            options.idleSkip = false;
+        } else if (argument == "--indexed") {
+            options.indexed = true;
+        } else if (argument == "--frameskip") {
+            const std::string frames = index + 1 < argc ? argv[++index] : "";
+            if (frames == "auto") {
+                options.frameSkip = FrameManager::AUTO_FRAME_SKIP;
+            } else if (!frames.empty() && frames.find_first_not_of("0123456789") == std::string::npos) {
+                options.frameSkip = std::stoi(frames);
+            } else {
+                std::cerr << "--frameskip needs a number of frames or auto" << std::endl;
+                return 1;
+            }
+        } else if (argument.rfind("--", 0) == 0) {
+            std::cerr << "Unknown option " << argument << std::endl;
+            return 1;
+        } else {
+            arguments.push_back(argument);
+        }
+    }
+    if (arguments.empty()) {
+        std::cerr << "Usage: " << argv[0] << " " << USAGE_ARGUMENTS << std::endl;
+        return 1;
+    }
+    if (options.recompiler && !Recompiler::isSupported()) {
+        std::cerr << "The recompiler isn't supported on this platform" << std::endl;
+        return 1;
+    }
+    const std::string romFileName = arguments[0];
+    const unsigned int cores = std::max(std::thread::hardware_concurrency(), 1U);
+    const unsigned int maxInstances = arguments.size() > 1 ? (unsigned int)std::max(std::stoi(arguments[1]), 1) : cores;
+    const double seconds = arguments.size() > 2 ? std::stod(arguments[2]) : 5.0;
+    if (arguments.size() > 3 && !FrameScaler::findType(arguments[3], options.scalerType)) {
+        std::cerr << "Unknown scaler " << arguments[3] << "; the scalers are";
+        for (unsigned int type = 0; type < SCALER_TYPE_COUNT; type++) {
+            std::cerr << " " << FrameScaler::getTypeName((ScalerType)type);
+        }
+        std::cerr << std::endl;
+        return 1;
+    }
+
+    // Mapped once and shared by every instance
+    const RomImage romImage = RomImage::mapFile(romFileName);
+    if (romImage.empty()) {
+        std::cerr << "Could not open " << romFileName << std::endl;
+        return 1;
+    }
+
+    // Doubling the instances each step, finishing on the maximum
+    std::vector<unsigned int> steps;
+    for (unsigned int instanceCount = 1; instanceCount < maxInstances; instanceCount *= 2) {
+        steps.push_back(instanceCount);
+    }
+    steps.push_back(maxInstances);
+
+    std::cout << "Scaler: " << FrameScaler::getTypeName(options.scalerType) << std::endl;
+    std::cout << "Instances  Workers  Frames/s  Per instance  Scaling  Scale ms  Finished    Elided" << std::endl;
+    double singleRate = 0.0;
+    uint64_t differentialMismatches = 0;
+    for (unsigned int instanceCount : steps) {
+        const unsigned int workerCount = std::min(instanceCount, cores);
+        const StepResult result = runInstances(romFileName, romImage, instanceCount, workerCount, seconds, options);
+        const double rate = result.framesPerSecond;
+        if (rate == 0.0) {
+            std::cerr << "The ROM could not be run" << std::endl;
+            return 1;
+        }
+        if (instanceCount == 1) {
+            singleRate = rate;
+        }
+        std::cout << std::setw(9) << instanceCount << std::setw(9) << workerCount
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(10) << rate << std::setw(14) << rate / instanceCount
+                  << std::setw(8) << std::setprecision(2) << rate / singleRate << "x"
+                  << std::setw(10) << result.scaleLatencyMillis
+                  << std::setw(10) << result.framesFinished << std::setw(10) << result.framesElided << std::endl;
+        differentialMismatches += printCounters(result.counters, options);
+    }
+    return differentialMismatches == 0 ? 0 : 1;
+}
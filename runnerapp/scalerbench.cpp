@@ -0,0 +1,138 @@
+#include "runnerappplatform.h"
+
+#include "../SharedLib/gbc/gbc.h"
+#include "../SharedLib/gbc/bandpool.h"
+#include "../SharedLib/gbc/framescaler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Measures how fast frames are upscaled with each of the scalers (or just the one given) as the threads sharing out
+// each frame's rows are doubled up to the given maximum (by default, one per core), the way FrameManager does with its
+// band pool. The frames are taken from the ROM, run with no window for a few seconds of game time first. Each step
+// checks its output against scaling the frames in one piece.
+//
+// Usage: ShiningEmulatorScalerBench <ROM file> [maximum threads] [seconds per step] [scaler]
+
+// Every 20th frame of the first 600 the ROM draws
+static std::vector<std::vector<uint32_t>> captureFrames(const std::string& romFileName) {
+    auto appDir = std::filesystem::temp_directory_path() / "ShiningEmulatorScalerBench";
+    RunnerAppPlatform platform(appDir.string());
+    auto gbc = std::make_unique<Gbc>();
+    std::vector<std::vector<uint32_t>> frames;
+    if (!gbc->loadRom(romFileName, RomImage::mapFile(romFileName), platform)) {
+        return frames;
+    }
+    gbc->reset();
+
+    for (unsigned int frameNo = 0; frameNo < 600 && gbc->isRunning; frameNo++) {
+        (void)gbc->runFrame();
+        gbc->frameManager.waitForScaling();
+        uint32_t* frameBuffer;
+        while ((frameBuffer = gbc->frameManager.getRenderableFrameBuffer()) != nullptr) {
+            if (frameNo % 20 == 0) {
+                const uint32_t* source = gbc->frameManager.getSourceFrameBuffer(frameBuffer);
+                frames.emplace_back(source, source + BASE_FRAME_W * BASE_FRAME_H);
+            }
+            (void)gbc->frameManager.freeFrame(frameBuffer);
+        }
+    }
+    return frames;
+}
+
+// Runs one step of the benchmark, returning the frames scaled per second, or zero if any output was wrong
+static double runStep(const std::vector<std::vector<uint32_t>>& frames, const FrameScaler& scaler,
+                      unsigned int threads, double seconds) {
+    const unsigned int factor = scaler.getScaleFactor();
+    const size_t outputSize = BASE_FRAME_W * BASE_FRAME_H * factor * factor;
+    std::vector<uint32_t> output(outputSize);
+    std::vector<uint32_t> expected(outputSize);
+    BandPool bands(threads);
+
+    for (auto& frame : frames) {
+        scaler.scaleRows(frame.data(), expected.data(), 0, BASE_FRAME_H);
+        bands.run(BASE_FRAME_H, [&](unsigned int firstRow, unsigned int rowCount) {
+            scaler.scaleRows(frame.data(), output.data(), firstRow, rowCount);
+        });
+        if (output != expected) {
+            return 0.0;
+        }
+    }
+
+    uint64_t framesScaled = 0;
+    const auto startTime = std::chrono::steady_clock::now();
+    const auto endTime = startTime + std::chrono::duration<double>(seconds);
+    while (std::chrono::steady_clock::now() < endTime) {
+        for (auto& frame : frames) {
+            bands.run(BASE_FRAME_H, [&](unsigned int firstRow, unsigned int rowCount) {
+                scaler.scaleRows(frame.data(), output.data(), firstRow, rowCount);
+            });
+        }
+        framesScaled += frames.size();
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return (double)framesScaled / elapsed;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <ROM file> [maximum threads] [seconds per step] [scaler]" << std::endl;
+        return 1;
+    }
+    const std::string romFileName = argv[1];
+    const unsigned int cores = std::max(std::thread::hardware_concurrency(), 1U);
+    const unsigned int maxThreads = argc > 2 ? (unsigned int)std::max(std::stoi(argv[2]), 1) : cores;
+    const double seconds = argc > 3 ? std::stod(argv[3]) : 2.0;
+    std::vector<ScalerType> scalerTypes;
+    for (unsigned int type = 0; type < SCALER_TYPE_COUNT; type++) {
+        scalerTypes.push_back((ScalerType)type);
+    }
+    if (argc > 4) {
+        scalerTypes.resize(1);
+        if (!FrameScaler::findType(argv[4], scalerTypes[0])) {
+            std::cerr << "Unknown scaler " << argv[4] << std::endl;
+            return 1;
+        }
+    }
+
+    const auto frames = captureFrames(romFileName);
+    if (frames.empty()) {
+        std::cerr << "Could not run " << romFileName << std::endl;
+        return 1;
+    }
+
+    // Doubling the threads each step, finishing on the maximum
+    std::vector<unsigned int> steps;
+    for (unsigned int threads = 1; threads < maxThreads; threads *= 2) {
+        steps.push_back(threads);
+    }
+    steps.push_back(maxThreads);
+
+    std::cout << "Scaler     Threads  Frames/s  Speedup" << std::endl;
+    for (ScalerType type : scalerTypes) {
+        const std::unique_ptr<FrameScaler> scaler = FrameScaler::make(type);
+        double singleRate = 0.0;
+        for (unsigned int threads : steps) {
+            const double rate = runStep(frames, *scaler, threads, seconds);
+            if (rate == 0.0) {
+                std::cerr << "Scaling in bands differed from scaling whole frames" << std::endl;
+                return 1;
+            }
+            if (threads == 1) {
+                singleRate = rate;
+            }
+            std::cout << std::left << std::setw(9) << FrameScaler::getTypeName(type)
+                      << std::right << std::setw(9) << threads
+                      << std::fixed << std::setprecision(1) << std::setw(10) << rate
+                      << std::setw(8) << std::setprecision(2) << rate / singleRate << "x" << std::endl;
+        }
+    }
+    return 0;
+}
@@ -205,6 +205,12 @@ unsigned int WindowsRenderer::createTexture(int textureFormat, const unsigned ch
     return newTexture;
 }
 
+void WindowsRenderer::deleteTexture(unsigned int texture)
+{
+    GLuint textureName = texture;
+    glDeleteTextures(1, &textureName);
+}
+
 unsigned int WindowsRenderer::createVbo(float* data, size_t length)
 {
     // Create a VBO
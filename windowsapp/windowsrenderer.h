@@ -20,6 +20,7 @@ protected:
     int queryAttribLocation(unsigned int program, const char* attribName) override;
     int queryUniformLocation(unsigned int program, const char* uniformName) override;
     unsigned int createTexture(int textureFormat, const unsigned char* rawData, size_t imageWidth, size_t imageHeight, bool useLinearMagFilter) override;
+    void deleteTexture(unsigned int texture) override;
     unsigned int createVbo(float* data, size_t length) override;
     void configureAttribute(int attributeLayout, int strideElements, int index, int size) override;
     void setUniform1i(int layout, int value) override;